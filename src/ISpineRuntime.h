@@ -1,6 +1,7 @@
 #ifndef ISPIRE_RUNTIME_H
 #define ISPIRE_RUNTIME_H
 
+#include <stdint.h>
 #include <string>
 #include <vector>
 #include <map>
@@ -12,12 +13,62 @@ struct Bounds {
     float height;
 }; 
 
+// Rectangle of viewport pixels, row y being the y-th row returned by glReadPixels
+struct PixelRect {
+    int x; 
+    int y;
+    int width;
+    int height;
+}; 
+
+// Durations of one phase of a runtime's frames
+struct PhaseStats {
+    std::string phase; 
+    unsigned int samples; 
+    float p50; // ms
+    float p99; // ms
+}; 
+
+// Allocations the spine runtime made from one line of its sources, counted by the pooled allocator
+// when WMASKEX_SPINE_ALLOCATOR is pool-stats
+struct AllocationSite {
+    std::string file; 
+    int line; 
+    uint64_t allocations; // alloc and calloc calls
+    uint64_t reallocations; // realloc calls, growing or shrinking a block
+    uint64_t frees; // of blocks last allocated or reallocated here
+    uint64_t bytes; // requested by allocations and reallocations
+    int64_t liveBytes; // allocated here and not freed yet
+}; 
+
+enum class RenderBackend {
+    RB_OpenGL, 
+    RB_Software 
+}; 
+
 class ISpineRuntime {
 public:
+    // Selects how textures are loaded and how draw() renders, must be called before init(). Runtimes
+    // built without OpenGL, like those of spine_bench, fail to init() RB_OpenGL.
+    virtual void setRenderBackend(RenderBackend backend) = 0; 
+    // Runtimes in the same non-null share group reuse each other's atlas and skeleton data, must be
+    // called before init(). For RB_OpenGL the group must stand for GL contexts sharing their objects.
+    virtual void setShareGroup(void* group) = 0; 
+    // Parses the asset files and decodes the atlas pages without any OpenGL call, so it may run on
+    // a worker thread. A following init() with the same paths then only creates the textures.
+    virtual bool preload(const std::string& atlas_path, const std::string& skeleton_path) = 0; 
     virtual bool init(const std::string& atlas_path, const std::string& skeleton_path) = 0;
     virtual std::vector<std::string> getAllSkins() = 0; 
     virtual std::map<std::string, float> getAllAnimations() = 0;
-    virtual Bounds getBounds() = 0; 
+    // Box of one animation in skeleton coordinates, measured like measureBounds() measures it on
+    // first use and remembered until dispose(). Empty for unknown animations or ones showing nothing.
+    // Only reads the skeleton data, so it may run wherever update() may.
+    virtual Bounds getAnimationBounds(const std::string& animation_name) = 0; 
+    // Measures the box of every animation of an asset in skeleton coordinates, played once from the
+    // setup pose with each skin getAllSkins() would list. Loads a private copy of the skeleton
+    // without the atlas pages and makes no OpenGL call, so it may run on any thread whatever the
+    // runtime is doing. Takes long for big assets, the results are meant to be cached.
+    virtual bool measureBounds(const std::string& atlas_path, const std::string& skeleton_path, std::map<std::string, Bounds>& animation_bounds) = 0; 
     virtual void setDefaultMix(float mix) = 0;
     virtual void setPosition(float x, float y) = 0;
     virtual void setScale(float scale) = 0;
@@ -27,6 +78,34 @@ public:
     virtual void setViewportSize(int width, int height, float scale) = 0;
     virtual void update(float delta_time) = 0;
     virtual void draw(bool pma) = 0;
+    // Does the CPU work of the next draw(), building the render commands or rasterizing a software
+    // frame, so draw() only submits it. Makes no OpenGL call, so like update() it may run on a
+    // worker thread while no other member runs. update() and setViewportSize() drop the prepared
+    // frame, as does setPixelTarget(), and a draw() without a prepared frame prepares it itself.
+    virtual void prepare(bool pma) = 0;
+    // Whether the pose of the last update() differs from the pose last drawn, so that draw() would
+    // change the image. Always true before the first draw() after setViewportSize().
+    virtual bool hasChanged() = 0; 
+    // Pixels the last draw() changed, the box of its vertices united with the previous draw's.
+    // Pixels outside it are transparent when the target is cleared before every draw, and the
+    // whole viewport must be treated as changed after setViewportSize().
+    virtual PixelRect getDirtyRect() = 0; 
+    // Viewport pixels the drawn content moved by in the last draw(), measured on its bounding box
+    virtual float getMotion() = 0; 
+    // RGBA8 image of the last software draw() in glReadPixels row order, nullptr for RB_OpenGL
+    virtual const unsigned char* getPixels() = 0; 
+    // Makes software draw() render into the given buffer of viewport size, BGRA8 instead of RGBA8
+    // if bgra is set, so the image lands directly in e.g. a DIB section. The buffer must be
+    // transparent, nullptr goes back to an own buffer. Needs to be set again after a resize.
+    virtual void setPixelTarget(unsigned char* pixels, bool bgra) = 0; 
+    // Per-phase durations of update() and draw() since the last resetStats()
+    virtual std::vector<PhaseStats> getStats() = 0; 
+    virtual void resetStats() = 0; 
+    // Busiest allocation sites of the runtime library since the last resetAllocationSites(), most
+    // allocations and reallocations first, empty unless the pooled allocator counts them. Shared by every runtime of
+    // the same spine version.
+    virtual std::vector<AllocationSite> getAllocationSites(size_t count) = 0; 
+    virtual void resetAllocationSites() = 0; 
     virtual void dispose() = 0;
     virtual ~ISpineRuntime() = default;
 }; 
@@ -0,0 +1,50 @@
+#include "PhaseStats.h"
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+uint64_t phaseClockNow() {
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int bucketIndex(uint64_t ns) {
+    if (ns < 8) return (int) ns;
+    int exponent = std::bit_width(ns) - 1;
+    int index = (exponent - 2) * 8 + (int) ((ns >> (exponent - 3)) & 7);
+    return index < PhaseHistogram::bucketCount ? index : PhaseHistogram::bucketCount - 1;
+}
+
+// Midpoint of the durations falling into a bucket
+static uint64_t bucketValue(int index) {
+    if (index < 8) return (uint64_t) index;
+    int exponent = index / 8 + 2;
+    uint64_t width = (uint64_t) 1 << (exponent - 3);
+    return (uint64_t) (8 + index % 8) * width + width / 2;
+}
+
+void PhaseHistogram::reset() {
+    memset(counts, 0, sizeof(counts));
+    samples = 0;
+}
+
+void PhaseHistogram::add(uint64_t ns) {
+    counts[bucketIndex(ns)]++;
+    samples++;
+}
+
+uint64_t PhaseHistogram::percentile(double fraction) const {
+    if (samples == 0) return 0;
+    uint64_t rank = (uint64_t) std::ceil(fraction * samples);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < bucketCount; i++) {
+        seen += counts[i];
+        if (seen >= rank) return bucketValue(i);
+    }
+    return bucketValue(bucketCount - 1);
+}
+
+PhaseStats PhaseHistogram::getStats(const std::string& phase) const {
+    return { phase, samples, percentile(0.5) / 1e6f, percentile(0.99) / 1e6f };
+}
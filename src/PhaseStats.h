@@ -0,0 +1,45 @@
+#ifndef PHASE_STATS_H
+#define PHASE_STATS_H
+
+#include <stdint.h>
+#include <string>
+#include "ISpineRuntime.h"
+
+// Monotonic timestamp in nanoseconds
+uint64_t phaseClockNow();
+
+// Histogram of phase durations with logarithmic buckets: exact below 8 ns, then 8 buckets per
+// power of two up to about 137 s. Adding a sample is a handful of instructions and percentiles
+// are accurate to within 1/16 of a power of two.
+class PhaseHistogram {
+public:
+    static const int bucketCount = 280;
+
+    PhaseHistogram() { reset(); }
+    void reset();
+    void add(uint64_t ns);
+    uint32_t getSamples() const { return samples; }
+    // Duration in ns below which the given fraction (0..1) of the samples lie, 0 without samples
+    uint64_t percentile(double fraction) const;
+    // p50 and p99 in milliseconds
+    PhaseStats getStats(const std::string& phase) const;
+
+private:
+    uint32_t counts[bucketCount];
+    uint32_t samples;
+};
+
+// Adds the time from its construction to its destruction to a histogram, no-op for nullptr
+class ScopedPhaseTimer {
+public:
+    explicit ScopedPhaseTimer(PhaseHistogram* histogram) : histogram(histogram), start(histogram ? phaseClockNow() : 0) {}
+    ~ScopedPhaseTimer() { if (histogram) histogram->add(phaseClockNow() - start); }
+    ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+private:
+    PhaseHistogram* histogram;
+    uint64_t start;
+};
+
+#endif // PHASE_STATS_H
@@ -0,0 +1,392 @@
+#include "WmaskEXAssetIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <cwctype>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+// ========== Spine资源直接解析函数 ========== //
+ParsedSkeletonInfo parseJsonSkeleton(const fs::path& jsonPath) {
+    ParsedSkeletonInfo info;
+    try {
+        std::ifstream ifs(jsonPath);
+        if (!ifs) return info;
+        
+        // 读取文件前2KB来查找skeleton部分
+        const size_t bufferSize = 2048;
+        std::string buffer(bufferSize, '\0');
+        ifs.read(&buffer[0], bufferSize);
+        size_t bytesRead = ifs.gcount();
+        buffer.resize(bytesRead);
+        
+        // 查找skeleton对象
+        size_t skeletonPos = buffer.find("\"skeleton\"");
+        if (skeletonPos == std::string::npos) return info;
+        
+        // 查找skeleton对象开始的 '{'
+        size_t bracePos = buffer.find('{', skeletonPos);
+        if (bracePos == std::string::npos) return info;
+        
+        size_t skeletonEnd = buffer.find('}', bracePos);
+        if (skeletonEnd == std::string::npos) skeletonEnd = buffer.length();
+        
+        // 解析字符串字段的lambda
+        auto parseStringField = [&](const std::string& fieldName) -> std::string {
+            size_t fieldPos = buffer.find("\"" + fieldName + "\"", bracePos);
+            if (fieldPos != std::string::npos && fieldPos < skeletonEnd) {
+                size_t colonPos = buffer.find(':', fieldPos);
+                if (colonPos != std::string::npos) {
+                    size_t quoteStart = buffer.find('"', colonPos);
+                    size_t quoteEnd = buffer.find('"', quoteStart + 1);
+                    if (quoteStart != std::string::npos && quoteEnd != std::string::npos) {
+                        return buffer.substr(quoteStart + 1, quoteEnd - quoteStart - 1);
+                    }
+                }
+            }
+            return "";
+        };
+        
+        // 解析数字字段的lambda
+        auto parseFloatField = [&](const std::string& fieldName) -> float {
+            size_t fieldPos = buffer.find("\"" + fieldName + "\"", bracePos);
+            if (fieldPos != std::string::npos && fieldPos < skeletonEnd) {
+                size_t colonPos = buffer.find(':', fieldPos);
+                if (colonPos != std::string::npos) {
+                    size_t numStart = colonPos + 1;
+                    while (numStart < buffer.length() && (buffer[numStart] == ' ' || buffer[numStart] == '\t')) numStart++;
+                    size_t numEnd = numStart;
+                    while (numEnd < buffer.length() && (std::isdigit(buffer[numEnd]) || buffer[numEnd] == '.' || buffer[numEnd] == '-')) numEnd++;
+                    if (numEnd > numStart) {
+                        return std::stof(buffer.substr(numStart, numEnd - numStart));
+                    }
+                }
+            }
+            return 0.0f;
+        };
+        
+        // 解析所有字段
+        info.version = parseStringField("spine");
+        if (info.version.empty()) return info;
+        
+        info.x = parseFloatField("x");
+        info.y = parseFloatField("y");
+        info.width = parseFloatField("width");
+        info.height = parseFloatField("height");
+        
+        info.valid = true;
+    } catch (...) {}
+    return info;
+}
+
+ParsedSkeletonInfo parseSkelSkeleton(const fs::path& skelPath) {
+    ParsedSkeletonInfo info;
+    try {
+        std::ifstream ifs(skelPath, std::ios::binary);
+        if (!ifs) return info;
+        
+        auto readVarint = [](std::istream& s) -> int {
+            int result = 0;
+            int shift = 0;
+            while (true) {
+                char b;
+                s.read(&b, 1);
+                result |= (b & 0x7F) << shift;
+                if (!(b & 0x80)) break;
+                shift += 7;
+            }
+            return result;
+        };
+        auto readString = [&](std::istream& s) -> std::string {
+            int len = readVarint(s);
+            if (len == 0) return std::string();
+            std::string str(len - 1, '\0');
+            s.read(&str[0], len - 1);
+            return str;
+        };
+        auto readInt = [](std::istream& s) -> int {
+            int result = 0;
+            char b;
+            s.read(&b, 1); result = (uint8_t)b;
+            result <<= 8;
+            s.read(&b, 1); result |= (uint8_t)b;
+            result <<= 8;
+            s.read(&b, 1); result |= (uint8_t)b;
+            result <<= 8;
+            s.read(&b, 1); result |= (uint8_t)b;
+            return result;
+        };
+        auto readFloat = [&](std::istream& s) -> float {
+            union {
+                int intValue;
+                float floatValue;
+            } intToFloat;
+            intToFloat.intValue = readInt(s);
+            return intToFloat.floatValue;
+        };
+        
+        // 先读取前64字节来检测版本
+        std::streampos startPos = ifs.tellg();
+        char buffer[64];
+        ifs.read(buffer, 64);
+        ifs.seekg(startPos); // 重置到开始位置
+        
+        std::string bufferStr(buffer, 64);
+        bool isNewFormat = false;
+        
+        // 在缓冲区中查找版本字符串
+        if (bufferStr.find("4.2.") != std::string::npos ||
+            bufferStr.find("4.1.") != std::string::npos ||
+            bufferStr.find("4.0.") != std::string::npos) {
+            isNewFormat = true;
+        } else if (bufferStr.find("3.8.") != std::string::npos ||
+                   bufferStr.find("3.7.") != std::string::npos) {
+            isNewFormat = false;
+        } else {
+            // 如果没找到明确版本标识，尝试新格式
+            isNewFormat = true;
+        }
+        
+        if (isNewFormat) {
+            // 新格式（4.0+）：先读两个int作为hash
+            readInt(ifs); // lowHash
+            readInt(ifs); // highHash
+            info.version = readString(ifs);
+        } else {
+            // 旧格式（3.7, 3.8）：直接读取hash字符串
+            readString(ifs); // hash
+            info.version = readString(ifs); // version
+        }
+        
+        // 根据版本读取bounds
+        std::string v = info.version.substr(0, 3);
+        if (v == "3.7") {
+            // 3.7版本没有x,y字段
+            info.x = 0.0f;
+            info.y = 0.0f;
+            info.width = readFloat(ifs);
+            info.height = readFloat(ifs);
+        } else {
+            // 3.8+ 版本有x,y,width,height
+            info.x = readFloat(ifs);
+            info.y = readFloat(ifs);
+            info.width = readFloat(ifs);
+            info.height = readFloat(ifs);
+        }
+        
+        info.valid = true;
+    } catch (...) {}
+    return info;
+}
+
+std::optional<bool> parseAtlasPMA(const fs::path& atlasPath) {
+    try {
+        std::ifstream ifs(atlasPath);
+        if (!ifs) return std::nullopt;
+        std::string line;
+        int lineCount = 0;
+        while (std::getline(ifs, line) && lineCount < 10) {
+            lineCount++;
+            if (line.find("pma") != std::string::npos) {
+                if (line.find("true") != std::string::npos) return true;
+                else return false;
+            }
+        }
+        return std::nullopt;
+    } catch (...) { return std::nullopt; }
+}
+
+// ========== 资源索引 ========== //
+const int assetIndexVersion = 2;
+
+static std::string toUtf8(const fs::path& path) {
+    std::u8string s = path.u8string();
+    return std::string(s.begin(), s.end());
+}
+
+static fs::path fromUtf8(const std::string& s) {
+    return fs::path(std::u8string(s.begin(), s.end()));
+}
+
+static WmaskEXFileStamp getFileStamp(const fs::path& path) {
+    std::error_code ec;
+    WmaskEXFileStamp stamp;
+    uintmax_t size = fs::file_size(path, ec);
+    if (ec) return stamp;
+    auto time = fs::last_write_time(path, ec);
+    if (ec) return stamp;
+    stamp.size = size;
+    stamp.mtime = time.time_since_epoch().count();
+    return stamp;
+}
+
+static json stampToJson(const WmaskEXFileStamp& stamp) {
+    return { stamp.size, stamp.mtime };
+}
+
+static WmaskEXFileStamp stampFromJson(const json& j) {
+    return { j.at(0).get<uintmax_t>(), j.at(1).get<int64_t>() };
+}
+
+WmaskEXAssetIndex::WmaskEXAssetIndex(const fs::path& assetsPath, const fs::path& indexPath,
+    const std::set<std::wstring>& imageExtensions)
+    : assetsPath(assetsPath), indexPath(indexPath), imageExtensions(imageExtensions) {}
+
+bool WmaskEXAssetIndex::load() {
+    try {
+        std::ifstream ifs(indexPath);
+        if (!ifs) return false;
+        json j = json::parse(ifs);
+        if (j.at("version").get<int>() != assetIndexVersion) return false;
+        if (fromUtf8(j.at("assetsPath").get<std::string>()) != assetsPath) return false;
+        std::map<fs::path, DirectoryEntry> loaded;
+        for (const auto& d : j.at("directories")) {
+            DirectoryEntry& entry = loaded[fromUtf8(d.at("path").get<std::string>())];
+            entry.mtime = d.at("mtime").get<int64_t>();
+            for (const auto& sub : d.at("subdirs"))
+                entry.subdirs.push_back(fromUtf8(sub.get<std::string>()));
+            for (const auto& a : d.at("assets")) {
+                WmaskEXIndexedAsset asset;
+                asset.isSpine = a.at("spine").get<bool>();
+                asset.path = fromUtf8(a.at("path").get<std::string>());
+                asset.version = a.at("version").get<std::string>();
+                const auto& b = a.at("bounds");
+                asset.bounds = { b.at(0).get<float>(), b.at(1).get<float>(), b.at(2).get<float>(), b.at(3).get<float>() };
+                if (!a.at("pma").is_null()) asset.pma = a.at("pma").get<bool>();
+                asset.skeletonPath = fromUtf8(a.at("skeleton").get<std::string>());
+                asset.atlasStamp = stampFromJson(a.at("atlasStamp"));
+                asset.skeletonStamp = stampFromJson(a.at("skeletonStamp"));
+                entry.assets.push_back(asset);
+            }
+        }
+        directories = std::move(loaded);
+    } catch (...) {
+        return false;
+    }
+    assets.clear();
+    for (const auto& [path, entry] : directories)
+        assets.insert(assets.end(), entry.assets.begin(), entry.assets.end());
+    return true;
+}
+
+bool WmaskEXAssetIndex::save() const {
+    try {
+        json j = { {"version", assetIndexVersion}, {"assetsPath", toUtf8(assetsPath)}, {"directories", json::array()} };
+        for (const auto& [path, entry] : directories) {
+            json d = { {"path", toUtf8(path)}, {"mtime", entry.mtime}, {"subdirs", json::array()}, {"assets", json::array()} };
+            for (const auto& sub : entry.subdirs)
+                d["subdirs"].push_back(toUtf8(sub));
+            for (const auto& asset : entry.assets) {
+                d["assets"].push_back({
+                    {"spine", asset.isSpine},
+                    {"path", toUtf8(asset.path)},
+                    {"version", asset.version},
+                    {"bounds", {asset.bounds.x, asset.bounds.y, asset.bounds.width, asset.bounds.height}},
+                    {"pma", asset.pma ? json(*asset.pma) : json(nullptr)},
+                    {"skeleton", toUtf8(asset.skeletonPath)},
+                    {"atlasStamp", stampToJson(asset.atlasStamp)},
+                    {"skeletonStamp", stampToJson(asset.skeletonStamp)}
+                });
+            }
+            j["directories"].push_back(d);
+        }
+        std::error_code ec;
+        if (indexPath.has_parent_path()) fs::create_directories(indexPath.parent_path(), ec);
+        // Write a temporary file first so a crash never leaves a truncated index behind
+        fs::path tmpPath = indexPath;
+        tmpPath += ".tmp";
+        {
+            std::ofstream ofs(tmpPath);
+            if (!ofs) return false;
+            ofs << j.dump();
+            if (!ofs) return false;
+        }
+        fs::rename(tmpPath, indexPath, ec);
+        return !ec;
+    } catch (...) {
+        return false;
+    }
+}
+
+bool WmaskEXAssetIndex::refresh() {
+    bool changed = false;
+    std::map<fs::path, DirectoryEntry> refreshed;
+    std::vector<fs::path> pending = { assetsPath };
+    while (!pending.empty()) {
+        fs::path dir = pending.back();
+        pending.pop_back();
+        std::error_code ec;
+        auto time = fs::last_write_time(dir, ec);
+        if (ec) continue;
+        int64_t mtime = time.time_since_epoch().count();
+        DirectoryEntry entry;
+        auto it = directories.find(dir);
+        if (it != directories.end() && it->second.mtime == mtime && !filesChanged(it->second)) {
+            entry = std::move(it->second);
+        } else {
+            scanDirectory(dir, entry);
+            entry.mtime = mtime;
+            changed = true;
+        }
+        pending.insert(pending.end(), entry.subdirs.begin(), entry.subdirs.end());
+        refreshed[dir] = std::move(entry);
+    }
+    // Directories that disappeared are only noticed by their count
+    if (refreshed.size() != directories.size()) changed = true;
+    directories = std::move(refreshed);
+    assets.clear();
+    for (const auto& [path, entry] : directories)
+        assets.insert(assets.end(), entry.assets.begin(), entry.assets.end());
+    return changed;
+}
+
+const std::vector<WmaskEXIndexedAsset>& WmaskEXAssetIndex::getAssets() const {
+    return assets;
+}
+
+// 原地重新导出不会改变目录的修改时间，只能逐个比较文件的大小和修改时间
+bool WmaskEXAssetIndex::filesChanged(const DirectoryEntry& entry) {
+    for (const auto& asset : entry.assets) {
+        if (!asset.isSpine) continue;
+        if (getFileStamp(asset.path) != asset.atlasStamp || getFileStamp(asset.skeletonPath) != asset.skeletonStamp)
+            return true;
+    }
+    return false;
+}
+
+void WmaskEXAssetIndex::scanDirectory(const fs::path& dir, DirectoryEntry& entry) const {
+    entry.subdirs.clear();
+    entry.assets.clear();
+    bool topLevel = dir == assetsPath;
+    std::set<fs::path> files;
+    std::error_code ec;
+    for (const auto& dirEntry : fs::directory_iterator(dir, ec)) {
+        // Same as recursive_directory_iterator, symlinked directories are not followed
+        if (dirEntry.is_directory(ec) && !dirEntry.is_symlink(ec)) entry.subdirs.push_back(dirEntry.path());
+        else if (dirEntry.is_regular_file(ec)) files.insert(dirEntry.path().filename());
+    }
+    for (const auto& file : files) {
+        if (file.extension() == L".atlas") {
+            // 同名的 .skel 优先于 .json，存在与否直接由目录列表判断
+            std::wstring stem = file.stem().wstring();
+            fs::path skeletonPath;
+            if (files.contains(stem + L".skel")) skeletonPath = dir / (stem + L".skel");
+            else if (files.contains(stem + L".json")) skeletonPath = dir / (stem + L".json");
+            else continue;
+            // 先取文件状态再解析，解析期间被改写的文件在下次刷新时仍会被发现
+            WmaskEXFileStamp atlasStamp = getFileStamp(dir / file);
+            WmaskEXFileStamp skeletonStamp = getFileStamp(skeletonPath);
+            ParsedSkeletonInfo info = skeletonPath.extension() == L".skel" ? parseSkelSkeleton(skeletonPath) : parseJsonSkeleton(skeletonPath);
+            if (!info.valid) continue;
+            entry.assets.push_back({ true, dir / file, info.version, { info.x, info.y, info.width, info.height }, parseAtlasPMA(dir / file),
+                skeletonPath, atlasStamp, skeletonStamp });
+        } else if (topLevel) {
+            std::wstring ext = file.extension().wstring();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::towlower);
+            if (imageExtensions.contains(ext))
+                entry.assets.push_back({ false, dir / file, "", { 0.0f, 0.0f, 0.0f, 0.0f }, std::nullopt });
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef WMASKEXASSETINDEX_H
+#define WMASKEXASSETINDEX_H
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+#include "ISpineRuntime.h"
+
+struct ParsedSkeletonInfo {
+    std::string version;
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    bool valid = false;
+};
+
+ParsedSkeletonInfo parseJsonSkeleton(const std::filesystem::path& jsonPath);
+ParsedSkeletonInfo parseSkelSkeleton(const std::filesystem::path& skelPath);
+// pma setting of the .atlas header, std::nullopt if the atlas does not specify it
+std::optional<bool> parseAtlasPMA(const std::filesystem::path& atlasPath);
+
+// Size and modification time of a file, all zero if it could not be read
+struct WmaskEXFileStamp {
+    uintmax_t size = 0;
+    int64_t mtime = 0;
+    bool operator==(const WmaskEXFileStamp&) const = default;
+};
+
+// An asset found by WmaskEXAssetIndex, spine assets come with their parsed skeleton header
+struct WmaskEXIndexedAsset {
+    bool isSpine;
+    std::filesystem::path path; // .atlas file of spine assets, the image file otherwise
+    std::string version;
+    Bounds bounds;
+    std::optional<bool> pma;
+    // Files the header and pma were parsed from, as they were then, spine assets only
+    std::filesystem::path skeletonPath;
+    WmaskEXFileStamp atlasStamp;
+    WmaskEXFileStamp skeletonStamp;
+};
+
+// Persistent index of the assets below an assets folder. Spine assets are searched recursively by
+// their .atlas file, images only in the top-level folder. refresh() only lists the directories whose
+// modification time changed since they were last scanned, all others are taken from the index unless
+// one of their spine files was rewritten in place, which only changes the file's own size or time.
+class WmaskEXAssetIndex {
+public:
+    WmaskEXAssetIndex(const std::filesystem::path& assetsPath, const std::filesystem::path& indexPath,
+        const std::set<std::wstring>& imageExtensions);
+    // Reads the index file, returns false if it is missing or belongs to another assets folder
+    bool load();
+    bool save() const;
+    // Brings the index up to date with the assets folder, returns whether anything changed
+    bool refresh();
+    const std::vector<WmaskEXIndexedAsset>& getAssets() const;
+
+private:
+    struct DirectoryEntry {
+        int64_t mtime = 0;
+        std::vector<std::filesystem::path> subdirs;
+        std::vector<WmaskEXIndexedAsset> assets;
+    };
+    void scanDirectory(const std::filesystem::path& dir, DirectoryEntry& entry) const;
+    static bool filesChanged(const DirectoryEntry& entry);
+
+    std::filesystem::path assetsPath;
+    std::filesystem::path indexPath;
+    std::set<std::wstring> imageExtensions;
+    std::map<std::filesystem::path, DirectoryEntry> directories;
+    std::vector<WmaskEXIndexedAsset> assets;
+};
+
+#endif // WMASKEXASSETINDEX_H
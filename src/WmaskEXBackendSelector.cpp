@@ -0,0 +1,77 @@
+#include "WmaskEXBackendSelector.h"
+
+#include <algorithm>
+
+WmaskEXBackendSelector::WmaskEXBackendSelector(RenderBackend initial, const WmaskEXBackendSelection& selection)
+    : selection(selection), backend(initial) {
+    reset();
+}
+
+RenderBackend WmaskEXBackendSelector::onFrame(float cost, float readbackCost, int pixels) {
+    switch (stage) {
+    case Stage::Measure:
+        if (sample(cost, readbackCost)) {
+            baseCost = median();
+            frames = 0;
+            if (backend == RenderBackend::RB_OpenGL && pixels > selection.trialPixels
+                && sampledReadbackCost < sampledCost * selection.trialReadbackShare) {
+                // Rasterizing this much would cost more than the readback it saves
+                stage = Stage::Settled;
+                break;
+            }
+            backend = other(backend);
+            stage = Stage::Trial;
+            samples.clear();
+            sampledCost = 0.0f;
+            sampledReadbackCost = 0.0f;
+        }
+        break;
+    case Stage::Trial:
+        if (sample(cost, readbackCost)) {
+            if (median() >= baseCost * selection.switchMargin) backend = other(backend);
+            stage = Stage::Settled;
+            frames = 0;
+        }
+        break;
+    case Stage::Settled:
+        if (++frames >= selection.settleFrames) reset();
+        break;
+    }
+    return backend;
+}
+
+void WmaskEXBackendSelector::cancel() {
+    backend = other(backend);
+    stage = Stage::Settled;
+    frames = 0;
+}
+
+RenderBackend WmaskEXBackendSelector::getBackend() const {
+    return backend;
+}
+
+void WmaskEXBackendSelector::reset() {
+    stage = Stage::Measure;
+    frames = 0;
+    samples.clear();
+    baseCost = 0.0f;
+    sampledCost = 0.0f;
+    sampledReadbackCost = 0.0f;
+}
+
+RenderBackend WmaskEXBackendSelector::other(RenderBackend backend) {
+    return backend == RenderBackend::RB_OpenGL ? RenderBackend::RB_Software : RenderBackend::RB_OpenGL;
+}
+
+bool WmaskEXBackendSelector::sample(float cost, float readbackCost) {
+    if (frames++ < selection.warmupFrames) return false;
+    samples.push_back(cost);
+    sampledCost += cost;
+    sampledReadbackCost += readbackCost;
+    return (int)samples.size() >= selection.sampleFrames;
+}
+
+float WmaskEXBackendSelector::median() {
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
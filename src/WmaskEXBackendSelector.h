@@ -0,0 +1,55 @@
+#ifndef WMASKEXBACKENDSELECTOR_H
+#define WMASKEXBACKENDSELECTOR_H
+
+#include <vector>
+#include "ISpineRuntime.h"
+
+// Tunables of WmaskEXBackendSelector, counted in drawn frames
+struct WmaskEXBackendSelection {
+    int warmupFrames = 5; // frames after a switch that are not measured, caches and buffers settle
+    int sampleFrames = 20; // frames whose median cost stands for a backend
+    float switchMargin = 0.8f; // share of the current backend's cost the other one has to beat
+    int settleFrames = 1500; // frames before both backends are measured again
+    int trialPixels = 256 * 256; // views up to this size always try the software backend
+    float trialReadbackShare = 0.5f; // share of an OpenGL frame's cost spent reading it back for larger views to try it
+};
+
+// Picks the cheaper render backend of an overlay from the measured cost of its frames. The current
+// backend is measured first, then the other one is tried for as long, and it is only kept if it is
+// clearly cheaper. After settleFrames both are measured again, since costs change with the content.
+// Rasterizing grows with the view, so large OpenGL views only try the software backend when reading
+// their frames back is what makes them expensive. Time only enters through the arguments, so the
+// same costs always give the same choices.
+class WmaskEXBackendSelector {
+public:
+    explicit WmaskEXBackendSelector(RenderBackend initial = RenderBackend::RB_OpenGL,
+        const WmaskEXBackendSelection& selection = WmaskEXBackendSelection());
+    // Reports the cost in ms of drawing and compositing a frame of pixels in size with the current
+    // backend, readbackCost of it spent reading the frame back, and returns the backend the next
+    // frame should be drawn with
+    RenderBackend onFrame(float cost, float readbackCost, int pixels);
+    // Switching to the backend returned by onFrame failed, stays with the previous one until the
+    // next measurement
+    void cancel();
+    RenderBackend getBackend() const;
+    // Measures both backends again, e.g. after a resize changed what they cost
+    void reset();
+
+private:
+    enum class Stage { Measure, Trial, Settled };
+    static RenderBackend other(RenderBackend backend);
+    // Collects the cost once the warmup is over, returns whether sampleFrames costs were collected
+    bool sample(float cost, float readbackCost);
+    float median();
+
+    WmaskEXBackendSelection selection;
+    RenderBackend backend;
+    Stage stage;
+    int frames;
+    std::vector<float> samples;
+    float baseCost; // median cost of the backend measured before the trial
+    float sampledCost; // sum of the collected costs
+    float sampledReadbackCost; // sum of their readback costs
+};
+
+#endif // WMASKEXBACKENDSELECTOR_H
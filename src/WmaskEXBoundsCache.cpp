@@ -0,0 +1,193 @@
+#include "WmaskEXBoundsCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+    const int boundsCacheVersion = 1;
+    const uint64_t fnvOffset = 14695981039346656037ull;
+    const uint64_t fnvPrime = 1099511628211ull;
+
+    // FNV-1a over the whole file, std::nullopt if it cannot be read
+    std::optional<uint64_t> hashFile(const fs::path& path) {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) return std::nullopt;
+        uint64_t hash = fnvOffset;
+        char buffer[64 * 1024];
+        while (ifs.read(buffer, sizeof(buffer)) || ifs.gcount() > 0) {
+            for (std::streamsize i = 0; i < ifs.gcount(); i++)
+                hash = (hash ^ (unsigned char) buffer[i]) * fnvPrime;
+        }
+        return hash;
+    }
+
+    // Union of the non-empty boxes, an empty box if there is none
+    Bounds unite(const std::map<std::string, Bounds>& animations) {
+        bool any = false;
+        float l = 0.0f, b = 0.0f, r = 0.0f, t = 0.0f;
+        for (const auto& [name, bounds] : animations) {
+            if (bounds.width <= 0.0f && bounds.height <= 0.0f) continue;
+            l = any ? std::min(l, bounds.x) : bounds.x;
+            b = any ? std::min(b, bounds.y) : bounds.y;
+            r = any ? std::max(r, bounds.x + bounds.width) : bounds.x + bounds.width;
+            t = any ? std::max(t, bounds.y + bounds.height) : bounds.y + bounds.height;
+            any = true;
+        }
+        return { l, b, r - l, t - b };
+    }
+
+    json toJson(const Bounds& bounds) {
+        return { bounds.x, bounds.y, bounds.width, bounds.height };
+    }
+
+    Bounds fromJson(const json& j) {
+        return { j.at(0).get<float>(), j.at(1).get<float>(), j.at(2).get<float>(), j.at(3).get<float>() };
+    }
+}
+
+WmaskEXBoundsCache::WmaskEXBoundsCache(const fs::path& cachePath) : cachePath(cachePath), worker([this] { run(); }) {}
+
+WmaskEXBoundsCache::~WmaskEXBoundsCache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    worker.join();
+}
+
+bool WmaskEXBoundsCache::load() {
+    std::map<std::string, WmaskEXAssetBounds> loaded;
+    try {
+        std::ifstream ifs(cachePath);
+        if (!ifs) return false;
+        json j = json::parse(ifs);
+        if (j.at("version").get<int>() != boundsCacheVersion) return false;
+        for (const auto& [key, a] : j.at("assets").items()) {
+            WmaskEXAssetBounds& entry = loaded[key];
+            entry.bounds = fromJson(a.at("bounds"));
+            for (const auto& [name, bounds] : a.at("animations").items())
+                entry.animations[name] = fromJson(bounds);
+        }
+    } catch (...) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    // Measured meanwhile is at least as recent as the file
+    loaded.merge(entries);
+    entries = std::move(loaded);
+    return true;
+}
+
+bool WmaskEXBoundsCache::save() {
+    json j = { {"version", boundsCacheVersion}, {"assets", json::object()} };
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& [key, entry] : entries) {
+            json animations = json::object();
+            for (const auto& [name, bounds] : entry.animations)
+                animations[name] = toJson(bounds);
+            j["assets"][key] = { {"bounds", toJson(entry.bounds)}, {"animations", animations} };
+        }
+    }
+    try {
+        std::error_code ec;
+        if (cachePath.has_parent_path()) fs::create_directories(cachePath.parent_path(), ec);
+        // Write a temporary file first so a crash never leaves a truncated cache behind
+        fs::path tmpPath = cachePath;
+        tmpPath += ".tmp";
+        {
+            std::ofstream ofs(tmpPath);
+            if (!ofs) return false;
+            ofs << j.dump();
+            if (!ofs) return false;
+        }
+        fs::rename(tmpPath, cachePath, ec);
+        return !ec;
+    } catch (...) {
+        return false;
+    }
+}
+
+std::string WmaskEXBoundsCache::getKey(const std::vector<fs::path>& files) {
+    uint64_t key = fnvOffset;
+    for (const fs::path& file : files) {
+        std::error_code ec;
+        uintmax_t size = fs::file_size(file, ec);
+        if (ec) return "";
+        int64_t mtime = fs::last_write_time(file, ec).time_since_epoch().count();
+        if (ec) return "";
+        std::optional<uint64_t> hash;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = fileHashes.find(file);
+            if (it != fileHashes.end() && it->second.size == size && it->second.mtime == mtime) hash = it->second.hash;
+        }
+        if (!hash) {
+            // Read without holding the lock, skeletons can be large
+            hash = hashFile(file);
+            if (!hash) return "";
+            std::lock_guard<std::mutex> lock(mutex);
+            fileHashes[file] = { size, mtime, *hash };
+        }
+        // Chain the file hashes, so swapping two files changes the key
+        for (int shift = 0; shift < 64; shift += 8)
+            key = (key ^ ((*hash >> shift) & 0xff)) * fnvPrime;
+    }
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long) key);
+    return hex;
+}
+
+std::optional<WmaskEXAssetBounds> WmaskEXBoundsCache::find(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) return std::nullopt;
+    return it->second;
+}
+
+void WmaskEXBoundsCache::request(const std::string& key, Measure measure) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (key.empty() || entries.contains(key) || pending.contains(key) || failed.contains(key)) return;
+        pending.insert(key);
+        queue.push_back({ key, std::move(measure) });
+    }
+    condition.notify_one();
+}
+
+void WmaskEXBoundsCache::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return queue.empty() && !measuring; });
+}
+
+void WmaskEXBoundsCache::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        condition.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (stopping) return;
+        auto [key, measure] = std::move(queue.front());
+        queue.pop_front();
+        measuring = true;
+        lock.unlock();
+        std::optional<std::map<std::string, Bounds>> animations = measure();
+        lock.lock();
+        pending.erase(key);
+        if (animations) {
+            Bounds bounds = unite(*animations);
+            entries[key] = { bounds, std::move(*animations) };
+            lock.unlock();
+            save();
+            lock.lock();
+        } else {
+            failed.insert(key);
+        }
+        measuring = false;
+        if (queue.empty()) idle.notify_all();
+    }
+}
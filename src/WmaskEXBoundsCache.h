@@ -0,0 +1,76 @@
+#ifndef WMASKEXBOUNDSCACHE_H
+#define WMASKEXBOUNDSCACHE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "ISpineRuntime.h"
+
+// Exact bounds of a spine asset in skeleton coordinates: the box of each animation and their union
+struct WmaskEXAssetBounds {
+    Bounds bounds;
+    std::map<std::string, Bounds> animations;
+};
+
+// Persistent cache of exact asset bounds in one sidecar file, keyed by a hash of the asset's files,
+// so copies of an asset share their bounds and a changed asset is measured again. Missing bounds
+// are measured one asset at a time on a worker thread of the cache, and the file is saved after
+// each. Every member function may be called from any thread.
+class WmaskEXBoundsCache {
+public:
+    // Measures the box of every animation of an asset, std::nullopt if the asset cannot be loaded
+    using Measure = std::function<std::optional<std::map<std::string, Bounds>>()>;
+
+    explicit WmaskEXBoundsCache(const std::filesystem::path& cachePath);
+    // Waits for the running measurement, queued ones are dropped
+    ~WmaskEXBoundsCache();
+
+    WmaskEXBoundsCache(const WmaskEXBoundsCache&) = delete;
+    WmaskEXBoundsCache& operator=(const WmaskEXBoundsCache&) = delete;
+
+    // Reads the cache file, returns false if it is missing or unreadable
+    bool load();
+    bool save();
+    // Hash of the contents of the files, empty if one of them cannot be read. Each file is only
+    // read again once its size or modification time changed.
+    std::string getKey(const std::vector<std::filesystem::path>& files);
+    // Bounds cached for key, std::nullopt while they are not measured
+    std::optional<WmaskEXAssetBounds> find(const std::string& key);
+    // Queues measure for key, unless its bounds are cached, queued or could not be measured before
+    void request(const std::string& key, Measure measure);
+    // Returns once no measurement is queued or running
+    void wait();
+
+private:
+    struct FileHash {
+        uintmax_t size;
+        int64_t mtime;
+        uint64_t hash;
+    };
+    void run();
+
+    std::filesystem::path cachePath;
+    std::mutex mutex;
+    std::condition_variable condition; // a measurement was queued or the cache stops
+    std::condition_variable idle; // the queue ran empty
+    bool stopping = false;
+    bool measuring = false;
+    std::deque<std::pair<std::string, Measure>> queue;
+    std::set<std::string> pending; // keys queued or being measured
+    std::set<std::string> failed; // keys whose asset could not be loaded, not retried until restart
+    std::map<std::string, WmaskEXAssetBounds> entries;
+    std::map<std::filesystem::path, FileHash> fileHashes;
+    std::thread worker; // Declared last, so it starts after every other member is constructed
+};
+
+#endif // WMASKEXBOUNDSCACHE_H
@@ -0,0 +1,39 @@
+#include "WmaskEXFramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+
+WmaskEXFramePacer::WmaskEXFramePacer(const WmaskEXFramePacing& pacing) : pacing(pacing) {
+    reset();
+}
+
+int WmaskEXFramePacer::onFrame(float elapsed, float cost, float motion, bool visible) {
+    float target;
+    if (!visible) {
+        idleCount = 0;
+        target = (float)pacing.hiddenInterval;
+    } else {
+        float speed = elapsed > 0.0f ? motion * 1000.0f / elapsed : 0.0f;
+        if (speed < pacing.idleSpeed) idleCount++;
+        else idleCount = 0;
+        if (idleCount > pacing.idleFrames) {
+            // Coming back from hidden the interval may be longer than idleInterval already
+            target = std::min(std::max(interval, (float)pacing.minInterval) * pacing.idleGrowth, (float)pacing.idleInterval);
+        } else {
+            target = (float)pacing.minInterval;
+        }
+    }
+    if (pacing.maxCostShare > 0.0f)
+        target = std::max(target, cost / pacing.maxCostShare);
+    interval = std::min(target, (float)std::max(pacing.hiddenInterval, pacing.minInterval));
+    return getInterval();
+}
+
+int WmaskEXFramePacer::getInterval() const {
+    return (int)std::lround(interval);
+}
+
+void WmaskEXFramePacer::reset() {
+    interval = (float)pacing.minInterval;
+    idleCount = 0;
+}
@@ -0,0 +1,35 @@
+#ifndef WMASKEXFRAMEPACER_H
+#define WMASKEXFRAMEPACER_H
+
+// Tunables of WmaskEXFramePacer, durations in ms
+struct WmaskEXFramePacing {
+    int minInterval = 40; // while the content moves
+    int idleInterval = 200; // approached while the content barely moves
+    int hiddenInterval = 1000; // while the overlay cannot be seen
+    float idleSpeed = 4.0f; // viewport pixels per second below which content counts as idle
+    int idleFrames = 5; // idle frames in a row before slowing down
+    float idleGrowth = 1.5f; // factor the interval grows by with every further idle frame
+    float maxCostShare = 0.5f; // largest share of the interval frames may spend working
+};
+
+// Picks the interval until the next frame of an overlay from what the last frame measured. Moving
+// content runs at minInterval and speeds back up at once, idle content slows down gradually to
+// idleInterval, hidden overlays drop to hiddenInterval, and expensive frames stretch the interval
+// so they never take more than maxCostShare of it. Time only enters through the arguments, so the
+// same measurements always give the same intervals.
+class WmaskEXFramePacer {
+public:
+    explicit WmaskEXFramePacer(const WmaskEXFramePacing& pacing = WmaskEXFramePacing());
+    // Reports a frame drawn elapsed ms after the previous one, which took cost ms of work and
+    // moved the content by motion pixels, and returns the interval in ms until the next frame
+    int onFrame(float elapsed, float cost, float motion, bool visible);
+    int getInterval() const;
+    void reset();
+
+private:
+    WmaskEXFramePacing pacing;
+    float interval;
+    int idleCount;
+};
+
+#endif // WMASKEXFRAMEPACER_H
@@ -7,6 +7,7 @@ std::wstring configFilePath = L".wmaskex";
 std::wstring previewImagePath = L"cover.png"; 
 std::map<std::wstring, WmaskEXConfig> wmaskEXConfigs;
 std::map<HWND, HwndInfo> hwndInfos;
+std::unique_ptr<WmaskEXPreloader<WmaskEXPreloadedAsset>> wmaskEXPreloader;
 
 HWND mainWindowHwnd; 
 HWND configListHwnd, previewHwnd; 
@@ -242,6 +243,7 @@ bool deleteButtonOnClicked(const EventData& e, LRESULT& r) {
             if (wcscmp(selectedName, editName) == 0) {
                 if (MessageBox(mainWindowHwnd, L"Delete this config?", L"Confirm Delete", MB_ICONQUESTION | MB_YESNO) == IDYES) {
                     wmaskEXConfigs.erase(selectedName);
+                    wmaskEXPreloader->discard(selectedName);
                     SendMessage(configListHwnd, LB_DELETESTRING, selIndex, 0);
                 }
             }
@@ -259,6 +261,8 @@ bool applyButtonOnClicked(const EventData& e, LRESULT& r) {
             if (!wmaskEXConfigs.contains(c.name))
                 SendMessage(configListHwnd, LB_ADDSTRING, 0, (LPARAM)c.name.c_str());
             wmaskEXConfigs[c.name] = c;
+            // The preloaded asset may come from the old assets path
+            wmaskEXPreloader->discard(c.name);
         }
         r = TRUE; 
         return true; 
@@ -372,9 +376,9 @@ bool mainWindowonTimeout(const EventData& e, LRESULT& r) {
                                     DestroyWindow(it->second.childHwnds[name].hwnd);
                                     it->second.childHwnds.erase(name);
                                 }
-                            } else {
-                                WmaskEXAssetConfig assetConfig;
-                                if (getRandomAsset(config.assetsPath, config.pma, assetConfig)) {
+                            } else if (auto preloaded = wmaskEXPreloader->take(name)) {
+                                if (preloaded->valid) {
+                                    WmaskEXAssetConfig& assetConfig = preloaded->assetConfig;
                                     assetConfig.parentHwnd = it->first;
                                     HWND hwnd = NULL; 
                                     switch (assetConfig.type) {
@@ -382,13 +386,17 @@ bool mainWindowonTimeout(const EventData& e, LRESULT& r) {
                                         hwnd = createWmaskEXImageWindow(config, assetConfig);
                                         break;
                                     case WmaskEXAssetConfig::AssetType::AT_Spine:
-                                        hwnd = createWmaskEXSpineWindow(config, assetConfig);
+                                        hwnd = createWmaskEXSpineWindow(config, assetConfig, std::move(preloaded->spineRuntime));
                                         break;
                                     }
                                     it->second.childHwnds[name].hwnd = hwnd;
                                     it->second.childHwnds[name].creationTime = currentTime;
                                 } else it->second.childHwnds[name] = { NULL, currentTime };
                             }
+                            // Prepare the next asset while the current one is shown
+                            wmaskEXPreloader->request(name, [assetsPath = config.assetsPath, pma = config.pma, shareContext = getWmaskEXSpineShareContext()] {
+                                return preloadWmaskEXAsset(assetsPath, pma, shareContext);
+                            });
                         }
                         if (!config.active && it->second.exePath == config.exePath && it->second.childHwnds.contains(name)) {
                             DestroyWindow(it->second.childHwnds[name].hwnd);
@@ -415,6 +423,7 @@ bool mainWindowOnClose(const EventData& e, LRESULT& r) {
 bool mainWindowOnDestroy(const EventData& e, LRESULT& r) {
     if (e.msg == WM_DESTROY) {
         saveConfig(configFilePath, wmaskEXConfigs);
+        wmaskEXPreloader.reset();
         if (hUiFont) {
             DeleteObject(hUiFont);
             hUiFont = NULL;
@@ -575,6 +584,7 @@ HWND createWmaskEXMainWindow() {
     openConfig(configFilePath, wmaskEXConfigs);
     for (const auto& [name, config] : wmaskEXConfigs)
         SendMessage(configListHwnd, LB_ADDSTRING, 0, (LPARAM)name.c_str());
+    wmaskEXPreloader = std::make_unique<WmaskEXPreloader<WmaskEXPreloadedAsset>>();
     SetTimer(mainWindowHwnd, 0, wmaskEXRefreshDuration, NULL);
 
     return mainWindowHwnd;
@@ -0,0 +1,116 @@
+#ifndef WMASKEXPRELOADER_H
+#define WMASKEXPRELOADER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Runs jobs preparing the next value of a key on one worker thread, so the owner thread only
+// has to take the finished value when it needs it. At most one value per key is queued or ready.
+// Values are only destroyed on the owner thread, i.e. the thread calling the member functions.
+template <typename T>
+class WmaskEXPreloader {
+public:
+    using Job = std::function<T()>;
+
+    WmaskEXPreloader() : worker([this] { run(); }) {}
+
+    ~WmaskEXPreloader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        worker.join();
+    }
+
+    WmaskEXPreloader(const WmaskEXPreloader&) = delete;
+    WmaskEXPreloader& operator=(const WmaskEXPreloader&) = delete;
+
+    // Queues job to prepare the next value of key, unless one is already queued, running or ready
+    void request(const std::wstring& key, Job job) {
+        std::vector<T> dropped;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            dropped.swap(retired);
+            if (pending.contains(key) || ready.contains(key)) return;
+            pending.insert(key);
+            queue.push_back({ key, std::move(job) });
+        }
+        condition.notify_one();
+    }
+
+    // Takes the value prepared for key, std::nullopt while it is not ready yet
+    std::optional<T> take(const std::wstring& key) {
+        std::vector<T> dropped;
+        std::lock_guard<std::mutex> lock(mutex);
+        dropped.swap(retired);
+        auto it = ready.find(key);
+        if (it == ready.end()) return std::nullopt;
+        std::optional<T> value(std::move(it->second));
+        ready.erase(it);
+        return value;
+    }
+
+    // Drops the value queued, running or ready for key, e.g. after the inputs of its job changed
+    void discard(const std::wstring& key) {
+        std::vector<T> dropped;
+        std::lock_guard<std::mutex> lock(mutex);
+        dropped.swap(retired);
+        for (auto it = queue.begin(); it != queue.end(); it++) {
+            if (it->first == key) {
+                queue.erase(it);
+                break;
+            }
+        }
+        pending.erase(key);
+        generations[key]++;
+        auto it = ready.find(key);
+        if (it != ready.end()) {
+            dropped.push_back(std::move(it->second));
+            ready.erase(it);
+        }
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            condition.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            auto [key, job] = std::move(queue.front());
+            queue.pop_front();
+            unsigned generation = generations[key];
+            lock.unlock();
+            T value = job();
+            lock.lock();
+            // A discard() while the job ran makes its value stale
+            if (generations[key] != generation) {
+                retired.push_back(std::move(value));
+                continue;
+            }
+            pending.erase(key);
+            ready.emplace(key, std::move(value));
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+    std::deque<std::pair<std::wstring, Job>> queue;
+    std::set<std::wstring> pending;
+    std::map<std::wstring, T> ready;
+    std::map<std::wstring, unsigned> generations;
+    std::vector<T> retired; // Stale values, destroyed by the next call on the owner thread
+    std::thread worker; // Declared last, so it starts after every other member is constructed
+};
+
+#endif // WMASKEXPRELOADER_H
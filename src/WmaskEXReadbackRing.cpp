@@ -0,0 +1,67 @@
+#include "WmaskEXReadbackRing.h"
+
+#include <utility>
+
+namespace {
+    bool isEmpty(const PixelRect& rect) {
+        return rect.width <= 0 || rect.height <= 0;
+    }
+}
+
+WmaskEXReadbackRing::WmaskEXReadbackRing(WmaskEXReadbackBackend& backend, Sink sink, int slots)
+    : backend(backend), sink(std::move(sink)), rects(slots > 0 ? slots : 1) {}
+
+WmaskEXReadbackRing::~WmaskEXReadbackRing() {
+    if (!allocated) return;
+    for (int slot = 0; slot < (int)rects.size(); slot++)
+        backend.release(slot);
+}
+
+void WmaskEXReadbackRing::resize(int width, int height) {
+    // Frames still in flight belong to the old size and are dropped unmapped
+    this->width = width;
+    this->height = height;
+    oldest = 0;
+    inFlight = 0;
+    size_t size = (size_t)width * height * 4;
+    for (int slot = 0; slot < (int)rects.size(); slot++)
+        backend.allocate(slot, size);
+    allocated = true;
+}
+
+void WmaskEXReadbackRing::submit(const PixelRect& rect) {
+    if (!allocated) return;
+    if (inFlight == (int)rects.size()) finishOldest();
+    int slot = (oldest + inFlight) % (int)rects.size();
+    rects[slot] = isEmpty(rect) ? PixelRect{ 0, 0, 0, 0 } : rect;
+    if (!isEmpty(rect)) backend.read(slot, rect, width);
+    inFlight++;
+}
+
+bool WmaskEXReadbackRing::complete() {
+    if (inFlight < (int)rects.size()) return false;
+    finishOldest();
+    return true;
+}
+
+void WmaskEXReadbackRing::flush() {
+    while (inFlight > 0) finishOldest();
+}
+
+int WmaskEXReadbackRing::getInFlight() const {
+    return inFlight;
+}
+
+void WmaskEXReadbackRing::finishOldest() {
+    int slot = oldest;
+    oldest = (oldest + 1) % (int)rects.size();
+    inFlight--;
+    const PixelRect& rect = rects[slot];
+    if (isEmpty(rect)) {
+        sink(nullptr, rect);
+        return;
+    }
+    const unsigned char* pixels = backend.map(slot);
+    sink(pixels, rect);
+    if (pixels) backend.unmap(slot);
+}
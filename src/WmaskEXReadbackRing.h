@@ -0,0 +1,62 @@
+#ifndef WMASKEXREADBACKRING_H
+#define WMASKEXREADBACKRING_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "ISpineRuntime.h"
+
+// GPU side of a WmaskEXReadbackRing: one transfer buffer per slot, each holding a whole frame of
+// width * height BGRA8 pixels with the rows of glReadPixels. Implemented with pixel pack buffers
+// by the spine window.
+class WmaskEXReadbackBackend {
+public:
+    virtual ~WmaskEXReadbackBackend() = default;
+    // Creates or resizes the buffer of a slot
+    virtual void allocate(int slot, size_t size) = 0;
+    // Starts copying rect of the current framebuffer to the same pixels of the slot's buffer,
+    // without waiting for the copy to finish
+    virtual void read(int slot, const PixelRect& rect, int width) = 0;
+    // Waits for the slot's copy and maps its buffer, nullptr if it could not be mapped
+    virtual const unsigned char* map(int slot) = 0;
+    virtual void unmap(int slot) = 0;
+    virtual void release(int slot) = 0;
+};
+
+// Pipelines the readback of rendered frames over a ring of transfer buffers. Frame N is copied
+// while frame N + 1 renders and is only mapped once the ring is full, so with 2 slots every frame
+// reaches the sink one tick late but mapping it never waits for the GPU. The ring only decides
+// which slot is read, mapped and released when, all buffer work is done by the backend.
+class WmaskEXReadbackRing {
+public:
+    // Receives each finished frame in submission order. pixels is laid out like the backend's
+    // buffers and only valid within rect, it is nullptr when rect is empty or mapping failed.
+    using Sink = std::function<void(const unsigned char* pixels, const PixelRect& rect)>;
+
+    WmaskEXReadbackRing(WmaskEXReadbackBackend& backend, Sink sink, int slots = 2);
+    ~WmaskEXReadbackRing();
+    // Reallocates all slots for width * height frames, dropping the frames in flight
+    void resize(int width, int height);
+    // Starts reading back rect of the frame just drawn, an empty rect only keeps the frame's place
+    // in line. If every slot is in flight the oldest frame is finished first.
+    void submit(const PixelRect& rect);
+    // Finishes the oldest frame once all slots are in flight, returns whether a frame was finished
+    bool complete();
+    // Finishes every frame in flight
+    void flush();
+    int getInFlight() const;
+
+private:
+    void finishOldest();
+
+    WmaskEXReadbackBackend& backend;
+    Sink sink;
+    std::vector<PixelRect> rects; // of the frame in flight in each slot
+    int width = 0;
+    int height = 0;
+    int oldest = 0;
+    int inFlight = 0;
+    bool allocated = false;
+};
+
+#endif // WMASKEXREADBACKRING_H
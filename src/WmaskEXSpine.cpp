@@ -1,17 +1,232 @@
 #include "header.h"
 
-bool wmaskEXSpineOnTimeout(const EventData& e, LRESULT& r) {
-    if (e.msg != WM_TIMER) return false; 
-    WmaskEXSpine* pData = reinterpret_cast<WmaskEXSpine*>(GetWindowLongPtr(e.hwnd, GWLP_USERDATA));
-    if (!pData) return true;
+const PIXELFORMATDESCRIPTOR wmaskEXSpinePixelFormat = {
+    sizeof(PIXELFORMATDESCRIPTOR), 
+    1, 
+    PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER, 
+    PFD_TYPE_RGBA, 
+    32, 0, 0, 0, 0, 0, 0, 
+    8, 0, 0, 0, 0, 0, 0, 
+    24, 8, 0, 
+    PFD_MAIN_PLANE,
+    0, 0, 0, 0
+}; 
 
-    wglMakeCurrent(pData->hdc, pData->hglrc);
-    glbinding::useContext((glbinding::ContextHandle)pData->hglrc);
-    
+// Pixel pack buffers of the readback ring, only used while the window's context is current
+class WmaskEXPixelPackBackend : public WmaskEXReadbackBackend {
+public:
+    void allocate(int slot, size_t size) override {
+        if (slot >= (int)buffers.size()) buffers.resize(slot + 1, 0);
+        if (!buffers[slot]) glGenBuffers(1, &buffers[slot]);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[slot]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)size, NULL, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    void read(int slot, const PixelRect& rect, int width) override {
+        // With a pack buffer bound glReadPixels only queues the copy and returns
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[slot]);
+        glPixelStorei(GL_PACK_ROW_LENGTH, width);
+        glReadPixels(rect.x, rect.y, rect.width, rect.height, GL_BGRA, GL_UNSIGNED_BYTE,
+            reinterpret_cast<void*>(((size_t)rect.y * width + rect.x) * 4));
+        glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    const unsigned char* map(int slot) override {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[slot]);
+        void* pixels = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+        if (!pixels) glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return static_cast<const unsigned char*>(pixels);
+    }
+
+    void unmap(int slot) override {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[slot]);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    void release(int slot) override {
+        if (slot >= (int)buffers.size() || !buffers[slot]) return;
+        glDeleteBuffers(1, &buffers[slot]);
+        buffers[slot] = 0;
+    }
+
+private:
+    std::vector<GLuint> buffers;
+};
+
+// Top-down DIB section selected into a memory DC for the whole life of the surface
+class WmaskEXDibSurfaceBackend : public WmaskEXSurfaceBackend {
+public:
+    unsigned char* create(int width, int height) override {
+        BITMAPINFO bmi = {0};
+        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmi.bmiHeader.biWidth = width;
+        bmi.bmiHeader.biHeight = -height; 
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+        hdc = CreateCompatibleDC(NULL);
+        void* bits = NULL;
+        bitmap = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+        if (!bitmap) {
+            DeleteDC(hdc);
+            hdc = NULL;
+            return nullptr;
+        }
+        oldBitmap = SelectObject(hdc, bitmap);
+        return static_cast<unsigned char*>(bits);
+    }
+
+    void destroy() override {
+        SelectObject(hdc, oldBitmap);
+        DeleteObject(bitmap);
+        DeleteDC(hdc);
+        hdc = NULL;
+        bitmap = NULL;
+    }
+
+    HDC getDC() const {
+        return hdc;
+    }
+
+private:
+    HDC hdc = NULL;
+    HBITMAP bitmap = NULL;
+    HGDIOBJ oldBitmap = NULL;
+};
+
+// Updates the part of the layered window a frame changed. pixels holds the frame in the layout of
+// the surface, either read back by the readback ring or the surface's own pixels.
+void wmaskEXSpineComposite(HWND hwnd, WmaskEXSpine* pData, const unsigned char* pixels, const PixelRect& rect) {
+    if (rect.width <= 0 || rect.height <= 0) return;
+    if (!pixels) {
+        // The frame is lost, the next one has to repaint everything
+        pData->fullComposite = true;
+        return;
+    }
+    // Pixels outside the dirty rect are transparent, so a new surface only needs the rect as well
+    bool created = pData->surface->ensure(pData->viewSize.cx, pData->viewSize.cy);
+    unsigned char* bits = pData->surface->getPixels();
+    if (!bits) return;
+    // The bitmap is top-down, so its rows are the rows of glReadPixels and only the dirty rows
+    // and columns need to be copied
+    size_t stride = pData->surface->getStride();
+    for (int row = rect.y; pixels != bits && row < rect.y + rect.height; row++) {
+        size_t offset = row * stride + (size_t) rect.x * 4;
+        memcpy(bits + offset, pixels + offset, (size_t) rect.width * 4);
+    }
+    SIZE pSize = { pData->viewSize.cx, pData->viewSize.cy };
+    POINT ptSrc = { 0, 0 };
+    BLENDFUNCTION blend = { AC_SRC_OVER, 0, static_cast<BYTE>(pData->config.opacity), AC_SRC_ALPHA };
+    bool full = created || (rect.width == pData->viewSize.cx && rect.height == pData->viewSize.cy);
+    RECT dirtyRect = { rect.x, rect.y, rect.x + rect.width, rect.y + rect.height };
+    UPDATELAYEREDWINDOWINFO info = { sizeof(UPDATELAYEREDWINDOWINFO) };
+    info.hdcDst = NULL;
+    // The window is moved by SetWindowPos when its view changes
+    info.pptDst = NULL;
+    info.psize = &pSize;
+    info.hdcSrc = static_cast<WmaskEXDibSurfaceBackend*>(pData->surfaceBackend.get())->getDC();
+    info.pptSrc = &ptSrc;
+    info.pblend = &blend;
+    info.dwFlags = ULW_ALPHA;
+    info.prcDirty = full ? NULL : &dirtyRect;
+    UpdateLayeredWindowIndirect(hwnd, &info);
+}
+
+// Whether the window the overlay is attached to can be seen at all
+bool isWmaskEXSpineVisible(const WmaskEXSpine* pData) {
+    if (!IsWindowVisible(pData->parentHwnd)) return false;
+    if (IsIconic(GetAncestor(pData->parentHwnd, GA_ROOT))) return false;
+    return pData->parentSize.cx > 0 && pData->parentSize.cy > 0;
+}
+
+void logWmaskEXSpineStats(const WmaskEXSpine* pData) {
+    std::vector<PhaseStats> stats = pData->spineRuntime->getStats();
+    stats.push_back(pData->readbackTime.getStats("readback"));
+    stats.push_back(pData->compositeTime.getStats("composite"));
+    std::wstringstream ss;
+    ss << L"INFO: Spine frame stats (p50/p99 ms) of " << pData->assetPath << L":";
+    ss << std::fixed << std::setprecision(3);
+    for (const auto& phase : stats)
+        ss << L"\n    " << std::wstring(phase.phase.begin(), phase.phase.end()) << L": " << phase.p50 << L" / " << phase.p99 << L" (" << phase.samples << L" samples)";
+    // Only counted with WMASKEX_SPINE_ALLOCATOR=pool-stats, by every runtime of the same version
+    std::vector<AllocationSite> sites = pData->spineRuntime->getAllocationSites(10);
+    if (!sites.empty()) ss << L"\n  Busiest allocation sites (allocations / reallocations / frees / live bytes):";
+    for (const auto& site : sites)
+        ss << L"\n    " << std::wstring(site.file.begin(), site.file.end()) << L":" << site.line << L": " << site.allocations << L" / " << site.reallocations << L" / " << site.frees << L" / " << site.liveBytes;
+    LOG(ss.str());
+}
+
+// Shared by every spine window. Never destroyed, jobs may still be queued while the process exits.
+WmaskEXUpdatePool& getWmaskEXUpdatePool() {
+    static WmaskEXUpdatePool* pool = new WmaskEXUpdatePool();
+    return *pool;
+}
+
+// Waits until the pending update has run, on the calling thread if no worker has started it
+void waitWmaskEXSpineUpdate(WmaskEXSpine* pData) {
+    if (!pData->pendingUpdate) return;
+    getWmaskEXUpdatePool().wait(pData->pendingUpdate);
+    pData->pendingUpdate.reset();
+    if (!pData->measuringAnimation.empty()) {
+        pData->animationBounds[pData->measuringAnimation] = pData->measuredBounds;
+        pData->measuringAnimation.clear();
+    }
+}
+
+// Part of the parent's client area the window has to cover: the box of the animation on screen,
+// united with the box of the animation mixed out of while they cross-fade. The whole area while
+// a box is not measured yet.
+RECT getWmaskEXSpineView(const WmaskEXSpine* pData) {
+    RECT parent = { 0, 0, pData->parentSize.cx, pData->parentSize.cy };
+    std::vector<int> shown = { pData->curIdx };
+    if (pData->prevIdx >= 0 && pData->poseTime - pData->lastUpdateAnimationTime < wmaskEXSpineDefaultMix)
+        shown.push_back(pData->prevIdx);
+    float l = FLT_MAX, b = FLT_MAX, r = -FLT_MAX, t = -FLT_MAX;
+    for (int idx : shown) {
+        auto it = pData->animationBounds.find(pData->animationNames[idx]);
+        if (it == pData->animationBounds.end()) return parent;
+        const Bounds& box = it->second;
+        if (box.width <= 0 || box.height <= 0) continue;
+        l = min(l, box.x);
+        b = min(b, box.y);
+        r = max(r, box.x + box.width);
+        t = max(t, box.y + box.height);
+    }
+    // Skeleton coordinates grow upwards from the bottom of the viewport, window rows downwards
+    RECT view = { 0, 0, 1, 1 };
+    if (l > r) return view;
+    float s = pData->scale;
+    RECT box = {
+        (LONG)floor((l + pData->x) * s) - wmaskEXSpineViewMargin,
+        pData->parentSize.cy - (LONG)ceil((t + pData->y) * s) - wmaskEXSpineViewMargin,
+        (LONG)ceil((r + pData->x) * s) + wmaskEXSpineViewMargin,
+        pData->parentSize.cy - (LONG)floor((b + pData->y) * s) + wmaskEXSpineViewMargin
+    };
+    if (!IntersectRect(&view, &box, &parent)) return RECT{ 0, 0, 1, 1 };
+    return view;
+}
+
+// Points the runtime's viewport at the part of the parent the next frame is laid out for
+void setWmaskEXSpineView(WmaskEXSpine* pData, ISpineRuntime* spineRuntime) {
+    const RECT& view = pData->frameView;
+    float bottom = float(pData->parentSize.cy - view.bottom);
+    spineRuntime->setPosition(pData->x - view.left / pData->scale, pData->y - bottom / pData->scale);
+    spineRuntime->setViewportSize(view.right - view.left, view.bottom - view.top, pData->scale);
+}
+
+// Lays out the next frame before its pose is updated, so its world transforms are computed at the
+// position of its view: fits the scale to a resized parent and points the runtime at the view of
+// the pose and, with the software backend, at the surface it rasterizes into. The window follows
+// the view when it draws the frame.
+void layoutWmaskEXSpineFrame(WmaskEXSpine* pData) {
     RECT parentRect; 
     GetClientRect(pData->parentHwnd, &parentRect);
-    if (parentRect.right < 0 || parentRect.bottom < 0) return true; 
-    if (pData->parentSize.cx != parentRect.right || pData->parentSize.cy != parentRect.bottom) {
+    bool parentResized = parentRect.right >= 0 && parentRect.bottom >= 0
+        && (pData->parentSize.cx != parentRect.right || pData->parentSize.cy != parentRect.bottom);
+    if (parentResized) {
         pData->parentSize = SIZE { parentRect.right, parentRect.bottom };
         float s; 
         float ws = pData->parentSize.cx / pData->bounds.width; 
@@ -38,8 +253,199 @@ bool wmaskEXSpineOnTimeout(const EventData& e, LRESULT& r) {
             + pData->config.xShift - pData->bounds.x * s) / s;
         pData->y = ((pData->parentSize.cy - pData->bounds.height * s) * pData->config.vertical / 100.0f
             + pData->config.yShift - pData->bounds.y * s) / s;
-        SetWindowPos(e.hwnd, HWND_TOP, 0, 0, pData->parentSize.cx, pData->parentSize.cy, SWP_NOACTIVATE | SWP_NOMOVE);
-        glViewport(0, 0, pData->parentSize.cx, pData->parentSize.cy);
+        pData->scale = s;
+        // What each backend costs depends on the scale. The view also changes with every animation
+        // switch and cross-fade, measuring again then would try the other backend all the time.
+        pData->backendSelector.reset();
+    }
+
+    // The scale fits all animations, but the window only covers what the current one can reach
+    RECT view = getWmaskEXSpineView(pData);
+    if (parentResized || !EqualRect(&view, &pData->frameView)) {
+        pData->frameView = view;
+        setWmaskEXSpineView(pData, pData->spineRuntime);
+    }
+
+    if (pData->backend != RenderBackend::RB_Software) return;
+    // The frame is rasterized straight into the surface, which needs the size of the view first
+    pData->surface->ensure(view.right - view.left, view.bottom - view.top);
+    unsigned char* bits = pData->surface->getPixels();
+    if (bits && pData->spineRuntime->getPixels() != bits) {
+        // New surface or new runtime, which only clears what it drew itself
+        memset(bits, 0, (size_t) pData->surface->getStride() * pData->surface->getHeight());
+        pData->spineRuntime->setPixelTarget(bits, true);
+        pData->fullComposite = true;
+    }
+}
+
+// Lays out the frame of the pose at the given time, then advances the runtime to the pose and
+// prepares the frame on the update pool, so the tick showing it only has to submit it. Overlays of
+// one asset share its skeleton data and update one after another. The owner thread leaves the
+// runtime alone until the update is waited for.
+void queueWmaskEXSpineUpdate(WmaskEXSpine* pData, float poseTime) {
+    float deltaTime = max(poseTime - pData->poseTime, 0.0f);
+    pData->poseTime += deltaTime;
+    layoutWmaskEXSpineFrame(pData);
+    // A new runtime also catches up with the current animation
+    deltaTime += pData->runtimeLag;
+    pData->runtimeLag = 0.0f;
+    ISpineRuntime* runtime = pData->spineRuntime;
+    bool pma = pData->pma;
+    // A frame composited whole is prepared even if the pose is held
+    bool redraw = pData->fullComposite;
+    float* updateCost = &pData->updateCost;
+    float* prepareCost = &pData->prepareCost;
+    // An animation is measured the first time it plays, serialized with the asset's other overlays
+    const std::string& animation = pData->animationNames[pData->curIdx];
+    if (!pData->animationBounds.count(animation)) pData->measuringAnimation = animation;
+    std::string measuringAnimation = pData->measuringAnimation;
+    Bounds* measuredBounds = &pData->measuredBounds;
+    pData->pendingUpdate = getWmaskEXUpdatePool().submit(pData->assetPath, [=] {
+        if (!measuringAnimation.empty()) *measuredBounds = runtime->getAnimationBounds(measuringAnimation);
+        uint64_t start = phaseClockNow();
+        runtime->update(deltaTime);
+        uint64_t prepareStart = phaseClockNow();
+        if (redraw || runtime->hasChanged()) runtime->prepare(pma);
+        *prepareCost = (phaseClockNow() - prepareStart) / 1e6f;
+        *updateCost = (phaseClockNow() - start) / 1e6f;
+    });
+}
+
+// Draws the frame with the OpenGL backend and composites the frame before it, which the readback
+// ring copied back meanwhile. Returns the ms spent in the readback ring.
+float wmaskEXSpineDrawOpenGL(WmaskEXSpine* pData) {
+    glBindFramebuffer(GL_FRAMEBUFFER, pData->fboID);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    pData->spineRuntime->draw(pData->pma);
+    PixelRect dirty = pData->spineRuntime->getDirtyRect();
+    if (pData->fullComposite) {
+        dirty = { 0, 0, pData->viewSize.cx, pData->viewSize.cy };
+        pData->fullComposite = false;
+    }
+    uint64_t readbackStart = phaseClockNow();
+    pData->readbackRing->submit(dirty);
+    uint64_t readbackTime = phaseClockNow() - readbackStart;
+    pData->readbackTime.add(readbackTime);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    // Composite the previous frame, its copy had the whole tick to finish
+    uint64_t compositeStart = phaseClockNow();
+    if (pData->readbackRing->complete()) {
+        readbackTime += phaseClockNow() - compositeStart;
+        pData->compositeTime.add(phaseClockNow() - compositeStart);
+    }
+    return readbackTime / 1e6f;
+}
+
+// Composites the frame the update rasterized straight into the surface's DIB section, no GPU involved
+void wmaskEXSpineDrawSoftware(HWND hwnd, WmaskEXSpine* pData) {
+    unsigned char* bits = pData->surface->getPixels();
+    // Without a surface the frame went to a buffer of the runtime, see layoutWmaskEXSpineFrame
+    if (!bits || pData->spineRuntime->getPixels() != bits) return;
+    pData->spineRuntime->draw(pData->pma);
+    PixelRect dirty = pData->spineRuntime->getDirtyRect();
+    if (pData->fullComposite) {
+        dirty = { 0, 0, pData->viewSize.cx, pData->viewSize.cy };
+        pData->fullComposite = false;
+    }
+    uint64_t compositeStart = phaseClockNow();
+    wmaskEXSpineComposite(hwnd, pData, bits, dirty);
+    pData->compositeTime.add(phaseClockNow() - compositeStart);
+}
+
+// Shared by every spine window, builds the runtimes of backend switches. Never destroyed like the
+// update pool, runtimes are only destroyed on the thread of the windows.
+WmaskEXPreloader<std::unique_ptr<ISpineRuntime>>& getWmaskEXBackendPreloader() {
+    static auto* preloader = new WmaskEXPreloader<std::unique_ptr<ISpineRuntime>>();
+    return *preloader;
+}
+
+std::wstring getWmaskEXBackendPreloaderKey(HWND hwnd) {
+    return std::to_wstring(reinterpret_cast<uintptr_t>(hwnd));
+}
+
+// Starts building a runtime drawing with the given backend on the preloader's worker, so parsing
+// the asset and decoding its pages for the other backend do not stall the window. The current
+// runtime draws until switchWmaskEXSpineBackend takes the new one.
+void requestWmaskEXSpineBackend(HWND hwnd, WmaskEXSpine* pData, RenderBackend backend) {
+    fs::path atlasPath = pData->assetPath;
+    std::u8string atlasPathString = atlasPath.u8string();
+    std::u8string skeletonPathString = getSkeletonPath(atlasPath).u8string();
+    std::string atlas(atlasPathString.begin(), atlasPathString.end());
+    std::string skeleton(skeletonPathString.begin(), skeletonPathString.end());
+    pData->switchingBackend = true;
+    getWmaskEXBackendPreloader().request(getWmaskEXBackendPreloaderKey(hwnd),
+        [spineVersion = pData->spineVersion, shareContext = pData->shareContext, backend, atlas, skeleton] {
+            std::unique_ptr<ISpineRuntime> spineRuntime(createSpineRuntime(spineVersion));
+            spineRuntime->setRenderBackend(backend);
+            spineRuntime->setShareGroup(shareContext);
+            if (!spineRuntime->preload(atlas, skeleton)) spineRuntime.reset();
+            return spineRuntime;
+        });
+}
+
+// Replaces the runtime by the one requestWmaskEXSpineBackend built once it is ready, which
+// continues the current skin and animation. Its pose catches up on the update pool, where updates
+// of overlays sharing the asset are serialized. Keeps the current runtime and cancels the switch if
+// the new one cannot be loaded.
+void switchWmaskEXSpineBackend(HWND hwnd, WmaskEXSpine* pData) {
+    std::optional<std::unique_ptr<ISpineRuntime>> preloaded = getWmaskEXBackendPreloader().take(getWmaskEXBackendPreloaderKey(hwnd));
+    if (!preloaded) return;
+    pData->switchingBackend = false;
+    std::unique_ptr<ISpineRuntime> spineRuntime = std::move(*preloaded);
+    fs::path atlasPath = pData->assetPath;
+    std::u8string atlasPathString = atlasPath.u8string();
+    std::u8string skeletonPathString = getSkeletonPath(atlasPath).u8string();
+    // Only the textures are left to create
+    if (!spineRuntime || !spineRuntime->init(reinterpret_cast<const char*>(atlasPathString.c_str()), reinterpret_cast<const char*>(skeletonPathString.c_str()))) {
+        LOG(L"WARNING: Failed to switch the render backend of " + pData->assetPath);
+        pData->backendSelector.cancel();
+        return;
+    }
+    spineRuntime->setDefaultMix(wmaskEXSpineDefaultMix);
+    spineRuntime->createRenderer();
+    setWmaskEXSpineView(pData, spineRuntime.get());
+    if (pData->multiSkin) spineRuntime->setSkin(pData->skinNames[pData->curSkin]);
+    spineRuntime->setAnimation(pData->animationNames[pData->curIdx]);
+    pData->runtimeLag = pData->poseTime - pData->lastUpdateAnimationTime;
+
+    // Frames of the OpenGL backend still in flight show up before the first frame of the new one
+    pData->readbackRing->flush();
+    logWmaskEXSpineStats(pData);
+    pData->spineRuntime->dispose();
+    delete pData->spineRuntime;
+    pData->spineRuntime = spineRuntime.release();
+    // The selector keeps the backend it asked for until the switch is done
+    pData->backend = pData->backendSelector.getBackend();
+    pData->fullComposite = true;
+}
+
+bool wmaskEXSpineOnTimeout(const EventData& e, LRESULT& r) {
+    if (e.msg != WM_TIMER) return false; 
+    WmaskEXSpine* pData = reinterpret_cast<WmaskEXSpine*>(GetWindowLongPtr(e.hwnd, GWLP_USERDATA));
+    if (!pData) return true;
+    uint64_t frameStart = phaseClockNow();
+    // Laying out a frame sets the viewport of the OpenGL renderer
+    wglMakeCurrent(pData->hdc, pData->hglrc);
+    glbinding::useContext((glbinding::ContextHandle)pData->hglrc);
+
+    // The pose of this tick was advanced and prepared on the update pool since the last one
+    float currentTime = getCurrentTimeInSeconds();
+    if (!pData->pendingUpdate) queueWmaskEXSpineUpdate(pData, currentTime);
+    uint64_t waitStart = phaseClockNow();
+    waitWmaskEXSpineUpdate(pData);
+    uint64_t waitTime = phaseClockNow() - waitStart;
+
+    // The window follows the view the frame was laid out for
+    const RECT& view = pData->frameView;
+    if (view.left != pData->viewOrigin.x || view.top != pData->viewOrigin.y
+        || view.right - view.left != pData->viewSize.cx || view.bottom - view.top != pData->viewSize.cy) {
+        pData->viewOrigin = POINT { view.left, view.top };
+        pData->viewSize = SIZE { view.right - view.left, view.bottom - view.top };
+        SetWindowPos(e.hwnd, HWND_TOP, view.left, view.top, pData->viewSize.cx, pData->viewSize.cy, SWP_NOACTIVATE);
+        glViewport(0, 0, pData->viewSize.cx, pData->viewSize.cy);
         if (pData->fboID) {
             glDeleteFramebuffers(1, &pData->fboID);
             glDeleteTextures(1, &pData->textureID);
@@ -50,58 +456,61 @@ bool wmaskEXSpineOnTimeout(const EventData& e, LRESULT& r) {
         glBindFramebuffer(GL_FRAMEBUFFER, pData->fboID);
         glGenTextures(1, &pData->textureID);
         glBindTexture(GL_TEXTURE_2D, pData->textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, pData->parentSize.cx, pData->parentSize.cy, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, pData->viewSize.cx, pData->viewSize.cy, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pData->textureID, 0);
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        pData->pixels.resize(pData->parentSize.cx * pData->parentSize.cy * 4, 0);
-        pData->spineRuntime->setPosition(pData->x, pData->y);
-        // pData->spineRuntime->setScale(s);
-        pData->spineRuntime->setViewportSize(pData->parentSize.cx, pData->parentSize.cy, s);
+        // Frames in flight have the old size, and the first frame of the new size is pushed whole
+        pData->readbackRing->resize(pData->viewSize.cx, pData->viewSize.cy);
+        pData->fullComposite = true;
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, pData->fboID);
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    float currentTime = getCurrentTimeInSeconds();
     float deltaTime = currentTime - pData->lastUpdateTime;
     pData->lastUpdateTime = currentTime;
-    pData->spineRuntime->update(deltaTime);
-    pData->spineRuntime->draw(pData->pma);
-    glReadPixels(0, 0, pData->parentSize.cx, pData->parentSize.cy, GL_BGRA, GL_UNSIGNED_BYTE, pData->pixels.data());
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    BITMAPINFO bmi = {0};
-    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth = pData->parentSize.cx;
-    bmi.bmiHeader.biHeight = -pData->parentSize.cy; 
-    bmi.bmiHeader.biPlanes = 1;
-    bmi.bmiHeader.biBitCount = 32;
-    bmi.bmiHeader.biCompression = BI_RGB;
-    POINT ptDst = { 0, 0 };
-    SIZE pSize = { pData->parentSize.cx, pData->parentSize.cy };
-    POINT ptSrc = { 0, 0 };
-    BLENDFUNCTION blend = { AC_SRC_OVER, 0, static_cast<BYTE>(pData->config.opacity), AC_SRC_ALPHA };
-    HDC hdcScreen = GetDC(NULL);
-    HDC hdcMem = CreateCompatibleDC(hdcScreen);
-    HBITMAP memBitmap = CreateDIBSection(hdcMem, &bmi, DIB_RGB_COLORS, NULL, NULL, 0);
-    SetBitmapBits(memBitmap, pData->parentSize.cx * pData->parentSize.cy * 4, pData->pixels.data());
-    HGDIOBJ hOld = SelectObject(hdcMem, memBitmap);
-    UpdateLayeredWindow(e.hwnd, hdcScreen, &ptDst, &pSize, hdcMem, &ptSrc, NULL, &blend, ULW_ALPHA);
-    SelectObject(hdcMem, hOld);
-    DeleteObject(memBitmap);
-    DeleteDC(hdcMem);
-    ReleaseDC(NULL, hdcScreen);
+    bool changed = pData->fullComposite || pData->spineRuntime->hasChanged();
+    if (changed) {
+        uint64_t drawStart = phaseClockNow();
+        float readbackCost = 0.0f;
+        if (pData->backend == RenderBackend::RB_Software) wmaskEXSpineDrawSoftware(e.hwnd, pData);
+        else readbackCost = wmaskEXSpineDrawOpenGL(pData);
+        // Small overlays are often cheaper to rasterize on the CPU than to read back from the GPU.
+        // Frames drawn while the runtime of the other backend is built are not measured.
+        float drawCost = (phaseClockNow() - drawStart) / 1e6f + pData->prepareCost;
+        if (!pData->switchingBackend) {
+            RenderBackend backend = pData->backendSelector.onFrame(drawCost, readbackCost, pData->viewSize.cx * pData->viewSize.cy);
+            if (backend != pData->backend) requestWmaskEXSpineBackend(e.hwnd, pData, backend);
+        }
+    } else if (pData->readbackRing->getInFlight() > 0) {
+        // The pose is held, so nothing is drawn, but the last frames drawn still have to reach the window
+        uint64_t compositeStart = phaseClockNow();
+        pData->readbackRing->flush();
+        pData->compositeTime.add(phaseClockNow() - compositeStart);
+    }
+    if (pData->switchingBackend) switchWmaskEXSpineBackend(e.hwnd, pData);
+
+    // Slow down for idle, hidden or expensive frames, wherever their work ran
+    float frameCost = (phaseClockNow() - frameStart - waitTime) / 1e6f + pData->updateCost;
+    float motion = changed ? pData->spineRuntime->getMotion() : 0.0f;
+    int interval = pData->framePacer.onFrame(deltaTime * 1000.0f, frameCost, motion, isWmaskEXSpineVisible(pData));
+    if (interval != pData->timerInterval) {
+        SetTimer(e.hwnd, 0, interval, NULL);
+        pData->timerInterval = interval;
+    }
 
     if (currentTime - pData->lastUpdateAnimationTime >= pData->animationDurations[pData->curIdx]) {
-        if (pData->multiSkin)
-            pData->spineRuntime->setSkin(pData->skinNames[int(getRandomFloat() * pData->skinNames.size())]);
+        if (pData->multiSkin) {
+            pData->curSkin = int(getRandomFloat() * pData->skinNames.size());
+            pData->spineRuntime->setSkin(pData->skinNames[pData->curSkin]);
+        }
+        pData->prevIdx = pData->curIdx;
         pData->curIdx = int(getRandomFloat() * pData->animationNames.size());
         pData->spineRuntime->setAnimation(pData->animationNames[pData->curIdx]);
         pData->lastUpdateAnimationTime = currentTime;
     }
+
+    // Prepare the pose of the next tick while other windows run theirs
+    queueWmaskEXSpineUpdate(pData, currentTime + interval / 1000.0f);
     return true; 
 }
 
@@ -110,6 +519,9 @@ bool wmaskEXSpineOnDestroy(const EventData& e, LRESULT& r) {
     KillTimer(e.hwnd, 0);
     WmaskEXSpine* pData = reinterpret_cast<WmaskEXSpine*>(GetWindowLongPtr(e.hwnd, GWLP_USERDATA));
     if (!pData) return true;
+    waitWmaskEXSpineUpdate(pData);
+    // A runtime built for a backend switch is dropped here, or by the preloader's next call
+    getWmaskEXBackendPreloader().discard(getWmaskEXBackendPreloaderKey(e.hwnd));
     wglMakeCurrent(pData->hdc, pData->hglrc);
     glbinding::useContext((glbinding::ContextHandle)pData->hglrc);
     if (pData->fboID) {
@@ -120,7 +532,13 @@ bool wmaskEXSpineOnDestroy(const EventData& e, LRESULT& r) {
         glDeleteTextures(1, &pData->textureID);
         pData->textureID = 0;
     }
+    // The pack buffers are deleted with the context current
+    pData->readbackRing.reset();
+    pData->readbackBackend.reset();
+    pData->surface.reset();
+    pData->surfaceBackend.reset();
     if (pData->spineRuntime) {
+        logWmaskEXSpineStats(pData);
         pData->spineRuntime->dispose();
         delete pData->spineRuntime;
         pData->spineRuntime = nullptr;
@@ -141,6 +559,42 @@ LRESULT CALLBACK wmaskEXSpineProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPa
     return DefWindowProc(hwnd, msg, wParam, lParam);
 }
 
+// Hidden GL context kept for the whole process. Every spine window's context shares its objects
+// with it, so textures of cached assets stay valid while any window uses them.
+HGLRC getWmaskEXSpineShareContext() {
+    static HGLRC shareContext = NULL;
+    static bool initialized = false;
+    if (initialized) return shareContext;
+    initialized = true;
+    HWND hwnd = CreateWindowEx(0, L"WmaskEXSpineClass", NULL, 0, 0, 0, 1, 1, NULL, NULL, GetModuleHandle(NULL), NULL);
+    if (!hwnd) {
+        LOG(L"ERROR: Failed to create spine share window.");
+        return NULL;
+    }
+    HDC hdc = GetDC(hwnd);
+    int pixelFormat = ChoosePixelFormat(hdc, &wmaskEXSpinePixelFormat);
+    SetPixelFormat(hdc, pixelFormat, &wmaskEXSpinePixelFormat);
+    shareContext = wglCreateContext(hdc);
+    if (!shareContext) LOG(L"ERROR: Failed to create spine share context.");
+    return shareContext;
+}
+
+ISpineRuntime* createSpineRuntime(WmaskEXAssetConfig::SpineVersion spineVersion) {
+    switch (spineVersion) {
+    case WmaskEXAssetConfig::SpineVersion::SV_42:
+        return createSpineRuntime42();
+    case WmaskEXAssetConfig::SpineVersion::SV_41:
+        return createSpineRuntime41();
+    case WmaskEXAssetConfig::SpineVersion::SV_40:
+        return createSpineRuntime40();
+    case WmaskEXAssetConfig::SpineVersion::SV_38:
+        return createSpineRuntime38();
+    case WmaskEXAssetConfig::SpineVersion::SV_37:
+        return createSpineRuntime37();
+    }
+    return nullptr;
+}
+
 void registerWmaskEXSpineClass() {
     WNDCLASS wc = {0};
     wc.lpfnWndProc = wmaskEXSpineProc;
@@ -149,7 +603,7 @@ void registerWmaskEXSpineClass() {
     RegisterClass(&wc);
 }
 
-HWND createWmaskEXSpineWindow(const WmaskEXConfig& config, const WmaskEXAssetConfig& assetConfig) {
+HWND createWmaskEXSpineWindow(const WmaskEXConfig& config, const WmaskEXAssetConfig& assetConfig, std::unique_ptr<ISpineRuntime> spineRuntime) {
     // Keep the overlay hidden until it has been attached to the target parent window.
     HWND hwnd = CreateWindowEx(WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_NOACTIVATE,
         L"WmaskEXSpineClass", NULL, 0, 0, 0, 10, 10, NULL, NULL, GetModuleHandle(NULL), NULL);
@@ -163,53 +617,54 @@ HWND createWmaskEXSpineWindow(const WmaskEXConfig& config, const WmaskEXAssetCon
     pData->config = config;
     pData->parentHwnd = assetConfig.parentHwnd;
     pData->hdc = GetDC(hwnd);
-    PIXELFORMATDESCRIPTOR pfd = {
-        sizeof(PIXELFORMATDESCRIPTOR), 
-        1, 
-        PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER, 
-        PFD_TYPE_RGBA, 
-        32, 0, 0, 0, 0, 0, 0, 
-        8, 0, 0, 0, 0, 0, 0, 
-        24, 8, 0, 
-        PFD_MAIN_PLANE,
-        0, 0, 0, 0
-    }; 
-    int pixelFormat = ChoosePixelFormat(pData->hdc, &pfd);
-    SetPixelFormat(pData->hdc, pixelFormat, &pfd);
+    int pixelFormat = ChoosePixelFormat(pData->hdc, &wmaskEXSpinePixelFormat);
+    SetPixelFormat(pData->hdc, pixelFormat, &wmaskEXSpinePixelFormat);
     pData->hglrc = wglCreateContext(pData->hdc);
+    // Join the share group before the context creates any object, so cached atlas textures work in it
+    HGLRC shareContext = getWmaskEXSpineShareContext();
+    if (shareContext && !wglShareLists(shareContext, pData->hglrc)) {
+        LOG(L"WARNING: Failed to share GL objects, spine assets will not be cached.");
+        shareContext = NULL;
+        // A preloaded runtime may use textures this context cannot see
+        spineRuntime.reset();
+    }
     wglMakeCurrent(pData->hdc, pData->hglrc);
     glbinding::initialize((glbinding::ContextHandle)pData->hglrc, nullptr, true, false); 
     pData->fboID = 0;
     pData->textureID = 0;
     pData->spineRuntime = nullptr;
     pData->parentSize = { 0, 0 };
+    pData->viewOrigin = { 0, 0 };
+    pData->viewSize = { 0, 0 };
+    pData->frameView = { 0, 0, 0, 0 };
+    pData->fullComposite = true;
+    WmaskEXFramePacing pacing;
+    pacing.minInterval = wmaskEXSpineRefreshDuration;
+    pacing.idleInterval = wmaskEXSpineIdleRefreshDuration;
+    pacing.hiddenInterval = wmaskEXSpineHiddenRefreshDuration;
+    pData->framePacer = WmaskEXFramePacer(pacing);
+    pData->timerInterval = wmaskEXSpineRefreshDuration;
 
-    switch (assetConfig.spineVersion) {
-    case WmaskEXAssetConfig::SpineVersion::SV_42:
-        pData->spineRuntime = createSpineRuntime42();
-        break;
-    case WmaskEXAssetConfig::SpineVersion::SV_41:
-        pData->spineRuntime = createSpineRuntime41();
-        break;
-    case WmaskEXAssetConfig::SpineVersion::SV_40:
-        pData->spineRuntime = createSpineRuntime40();
-        break;
-    case WmaskEXAssetConfig::SpineVersion::SV_38:
-        pData->spineRuntime = createSpineRuntime38();
-        break;
-    case WmaskEXAssetConfig::SpineVersion::SV_37:
-        pData->spineRuntime = createSpineRuntime37();
-        break;
+    if (spineRuntime) {
+        // Preloaded by the worker thread, init only has to upload the textures
+        pData->spineRuntime = spineRuntime.release();
+    } else {
+        pData->spineRuntime = createSpineRuntime(assetConfig.spineVersion);
+        pData->spineRuntime->setShareGroup(shareContext);
     }
+    pData->spineVersion = assetConfig.spineVersion;
+    pData->shareContext = shareContext;
+    pData->backend = RenderBackend::RB_OpenGL;
+    pData->backendSelector = WmaskEXBackendSelector(pData->backend);
+    pData->switchingBackend = false;
+    pData->scale = 1.0f;
     pData->bounds = assetConfig.bounds;
+    pData->animationBounds = assetConfig.animationBounds;
     pData->pma = assetConfig.pma;
+    pData->assetPath = assetConfig.assetPath;
     fs::path atlasPath = assetConfig.assetPath;
-    fs::path assetDir = fs::path(atlasPath).parent_path();
-    std::string baseName = atlasPath.stem().string();
-    fs::path jsonPath = assetDir / (baseName + ".json");
-    fs::path skelPath = assetDir / (baseName + ".skel");
     std::u8string atlasPathString = atlasPath.u8string();
-    std::u8string skeletonPathString = fs::exists(skelPath) ? skelPath.u8string() : jsonPath.u8string();
+    std::u8string skeletonPathString = getSkeletonPath(atlasPath).u8string();
     bool success = pData->spineRuntime->init(reinterpret_cast<const char*>(atlasPathString.c_str()), reinterpret_cast<const char*>(skeletonPathString.c_str()));
     if (!success) {
         std::wstring msg = L"ERROR: Failed to initialize Spine runtime.\nAsset: " + fs::path(assetConfig.assetPath).wstring();
@@ -238,14 +693,26 @@ HWND createWmaskEXSpineWindow(const WmaskEXConfig& config, const WmaskEXAssetCon
         pData->animationDurations.push_back(allAnimations.begin()->second);
     }
     pData->curIdx = int(getRandomFloat() * pData->animationNames.size());
+    pData->prevIdx = -1;
     float currentTime = getCurrentTimeInSeconds(); 
     pData->lastUpdateTime = currentTime; 
     pData->lastUpdateAnimationTime = currentTime;
-    pData->spineRuntime->setDefaultMix(0.2f);
+    pData->poseTime = currentTime;
+    pData->runtimeLag = 0.0f;
+    pData->updateCost = 0.0f;
+    pData->prepareCost = 0.0f;
+    pData->spineRuntime->setDefaultMix(wmaskEXSpineDefaultMix);
     pData->spineRuntime->createRenderer();
     pData->spineRuntime->setAnimation(pData->animationNames[pData->curIdx]);
+    pData->curSkin = int(getRandomFloat() * pData->skinNames.size());
     if (pData->multiSkin)
-        pData->spineRuntime->setSkin(pData->skinNames[int(getRandomFloat() * pData->skinNames.size())]);
+        pData->spineRuntime->setSkin(pData->skinNames[pData->curSkin]);
+
+    pData->surfaceBackend = std::make_unique<WmaskEXDibSurfaceBackend>();
+    pData->surface = std::make_unique<WmaskEXSurface>(*pData->surfaceBackend);
+    pData->readbackBackend = std::make_unique<WmaskEXPixelPackBackend>();
+    pData->readbackRing = std::make_unique<WmaskEXReadbackRing>(*pData->readbackBackend,
+        [hwnd, pData](const unsigned char* pixels, const PixelRect& rect) { wmaskEXSpineComposite(hwnd, pData, pixels, rect); });
 
     SetWindowLongPtr(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(pData));
     ShowWindow(hwnd, SW_SHOWNOACTIVATE);
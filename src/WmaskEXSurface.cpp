@@ -0,0 +1,41 @@
+#include "WmaskEXSurface.h"
+
+WmaskEXSurface::WmaskEXSurface(WmaskEXSurfaceBackend& backend) : backend(backend) {}
+
+WmaskEXSurface::~WmaskEXSurface() {
+    release();
+}
+
+bool WmaskEXSurface::ensure(int width, int height) {
+    if (pixels && width == this->width && height == this->height) return false;
+    release();
+    if (width <= 0 || height <= 0) return false;
+    pixels = backend.create(width, height);
+    if (!pixels) return false;
+    this->width = width;
+    this->height = height;
+    return true;
+}
+
+void WmaskEXSurface::release() {
+    if (pixels) backend.destroy();
+    pixels = nullptr;
+    width = 0;
+    height = 0;
+}
+
+unsigned char* WmaskEXSurface::getPixels() const {
+    return pixels;
+}
+
+int WmaskEXSurface::getWidth() const {
+    return width;
+}
+
+int WmaskEXSurface::getHeight() const {
+    return height;
+}
+
+int WmaskEXSurface::getStride() const {
+    return width * 4;
+}
@@ -0,0 +1,36 @@
+#ifndef WMASKEXSURFACE_H
+#define WMASKEXSURFACE_H
+
+// Platform side of a WmaskEXSurface: a top-down BGRA8 bitmap the CPU writes the pixels of. The
+// spine window implements it with a DIB section selected into a memory DC.
+class WmaskEXSurfaceBackend {
+public:
+    virtual ~WmaskEXSurfaceBackend() = default;
+    // Creates a transparent width * height bitmap and returns its pixels, nullptr on failure
+    virtual unsigned char* create(int width, int height) = 0;
+    virtual void destroy() = 0;
+};
+
+// Bitmap a layered window is composited from, kept across frames and only recreated when the
+// window size changes. Rows are width * 4 bytes without padding.
+class WmaskEXSurface {
+public:
+    explicit WmaskEXSurface(WmaskEXSurfaceBackend& backend);
+    ~WmaskEXSurface();
+    // Makes the bitmap width * height, returns whether it was recreated and so is transparent.
+    // A failed or empty bitmap has no pixels and is retried by the next call.
+    bool ensure(int width, int height);
+    void release();
+    unsigned char* getPixels() const;
+    int getWidth() const;
+    int getHeight() const;
+    int getStride() const;
+
+private:
+    WmaskEXSurfaceBackend& backend;
+    unsigned char* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+};
+
+#endif // WMASKEXSURFACE_H
@@ -0,0 +1,101 @@
+#include "WmaskEXUpdatePool.h"
+
+#include <algorithm>
+#include <utility>
+
+struct WmaskEXUpdatePool::Task {
+    std::wstring strand;
+    Job job;
+    bool started = false;
+    bool done = false;
+};
+
+WmaskEXUpdatePool::WmaskEXUpdatePool(unsigned int threads) {
+    if (threads == 0) threads = std::clamp(std::max(std::thread::hardware_concurrency(), 2u) - 1, 1u, 8u);
+    for (unsigned int i = 0; i < threads; i++)
+        workers.emplace_back([this] { run(); });
+}
+
+WmaskEXUpdatePool::~WmaskEXUpdatePool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    runnable.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+WmaskEXUpdatePool::Ticket WmaskEXUpdatePool::submit(const std::wstring& strand, Job job) {
+    Ticket task = std::make_shared<Task>();
+    task->strand = strand;
+    task->job = std::move(job);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(task);
+    }
+    runnable.notify_one();
+    return task;
+}
+
+void WmaskEXUpdatePool::wait(const Ticket& ticket) {
+    if (!ticket) return;
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!ticket->started) {
+        // Jobs of the same strand queued earlier have to run first
+        auto it = std::find(queue.begin(), queue.end(), ticket);
+        bool free = it != queue.end() && !busyStrands.contains(ticket->strand)
+            && std::none_of(queue.begin(), it, [&](const Ticket& task) { return !ticket->strand.empty() && task->strand == ticket->strand; });
+        if (free) {
+            queue.erase(it);
+            execute(ticket, lock);
+        }
+    }
+    finished.wait(lock, [&] { return ticket->done; });
+}
+
+unsigned int WmaskEXUpdatePool::getThreads() const {
+    return (unsigned int) workers.size();
+}
+
+void WmaskEXUpdatePool::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        Ticket task;
+        runnable.wait(lock, [&] {
+            task = takeRunnable();
+            return task || (stopping && queue.empty());
+        });
+        if (!task) return;
+        execute(task, lock);
+    }
+}
+
+WmaskEXUpdatePool::Ticket WmaskEXUpdatePool::takeRunnable() {
+    // The first task of a free strand is also its earliest, so each strand keeps its order
+    for (auto it = queue.begin(); it != queue.end(); it++) {
+        const std::wstring& strand = (*it)->strand;
+        if (strand.empty() || !busyStrands.contains(strand)) {
+            Ticket task = *it;
+            queue.erase(it);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void WmaskEXUpdatePool::execute(const Ticket& task, std::unique_lock<std::mutex>& lock) {
+    task->started = true;
+    if (!task->strand.empty()) busyStrands.insert(task->strand);
+    Job job = std::move(task->job);
+    lock.unlock();
+    job();
+    // Whatever the job captured is released before its waiter returns
+    job = nullptr;
+    lock.lock();
+    task->done = true;
+    if (!task->strand.empty()) {
+        busyStrands.erase(task->strand);
+        runnable.notify_all();
+    }
+    finished.notify_all();
+}
@@ -0,0 +1,56 @@
+#ifndef WMASKEXUPDATEPOOL_H
+#define WMASKEXUPDATEPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs the CPU side of overlay frames, i.e. advancing the animation and building the render
+// commands, on worker threads shared by all overlays, so the frames of many overlays are prepared
+// in parallel and their owner thread only has to submit them. Jobs on the same non-empty strand
+// run one at a time in submission order, e.g. those of runtimes sharing skeleton data, which
+// Spine writes to while rendering sequences.
+class WmaskEXUpdatePool {
+public:
+    using Job = std::function<void()>;
+    struct Task;
+    // A submitted job, to be passed to wait()
+    using Ticket = std::shared_ptr<Task>;
+
+    // 0 threads leaves one hardware thread to the owner thread and uses the others, at most 8
+    explicit WmaskEXUpdatePool(unsigned int threads = 0);
+    // Runs the jobs still queued, then joins the workers
+    ~WmaskEXUpdatePool();
+
+    WmaskEXUpdatePool(const WmaskEXUpdatePool&) = delete;
+    WmaskEXUpdatePool& operator=(const WmaskEXUpdatePool&) = delete;
+
+    Ticket submit(const std::wstring& strand, Job job);
+    // Returns once the job of ticket has run. A job no worker has started yet runs on the calling
+    // thread if its strand allows, so waiting does not idle while the workers run other jobs.
+    void wait(const Ticket& ticket);
+    unsigned int getThreads() const;
+
+private:
+    void run();
+    // Removes and returns the first queued task whose strand is free, nullptr if there is none
+    Ticket takeRunnable();
+    // Runs task with the mutex held by lock released meanwhile
+    void execute(const Ticket& task, std::unique_lock<std::mutex>& lock);
+
+    std::mutex mutex;
+    std::condition_variable runnable; // a task was queued, a strand got free or the pool stops
+    std::condition_variable finished; // a task has run
+    bool stopping = false;
+    std::deque<Ticket> queue;
+    std::set<std::wstring> busyStrands; // strands of the running tasks
+    std::vector<std::thread> workers; // Declared last, so they start after every other member is constructed
+};
+
+#endif // WMASKEXUPDATEPOOL_H
@@ -2,6 +2,7 @@
 
 std::wofstream WmaskEXLog::logFile; 
 bool WmaskEXLog::initialized = false; 
+std::mutex WmaskEXLog::mutex; 
 
 void WmaskEXLog::init(const std::wstring& logFilePath) {
     if (!initialized) {
@@ -12,6 +13,8 @@ void WmaskEXLog::init(const std::wstring& logFilePath) {
 }
 
 void WmaskEXLog::log(const std::wstring& message) {
+    // The preloader logs from its worker thread
+    std::lock_guard<std::mutex> lock(mutex); 
     if (!initialized) init(); 
     auto now = std::chrono::system_clock::now(); 
     auto time_t = std::chrono::system_clock::to_time_t(now); 
@@ -30,205 +33,6 @@ void WmaskEXLog::close() {
     }
 }
 
-// ========== Spine资源直接解析函数 ========== //
-struct ParsedSkeletonInfo {
-    std::string version;
-    float x = 0.0f;
-    float y = 0.0f;
-    float width = 0.0f;
-    float height = 0.0f;
-    bool valid = false;
-};
-
-ParsedSkeletonInfo parseJsonSkeleton(const std::wstring& jsonPath) {
-    ParsedSkeletonInfo info;
-    try {
-        std::ifstream ifs(jsonPath);
-        if (!ifs) return info;
-        
-        // 读取文件前2KB来查找skeleton部分
-        const size_t bufferSize = 2048;
-        std::string buffer(bufferSize, '\0');
-        ifs.read(&buffer[0], bufferSize);
-        size_t bytesRead = ifs.gcount();
-        buffer.resize(bytesRead);
-        
-        // 查找skeleton对象
-        size_t skeletonPos = buffer.find("\"skeleton\"");
-        if (skeletonPos == std::string::npos) return info;
-        
-        // 查找skeleton对象开始的 '{'
-        size_t bracePos = buffer.find('{', skeletonPos);
-        if (bracePos == std::string::npos) return info;
-        
-        size_t skeletonEnd = buffer.find('}', bracePos);
-        if (skeletonEnd == std::string::npos) skeletonEnd = buffer.length();
-        
-        // 解析字符串字段的lambda
-        auto parseStringField = [&](const std::string& fieldName) -> std::string {
-            size_t fieldPos = buffer.find("\"" + fieldName + "\"", bracePos);
-            if (fieldPos != std::string::npos && fieldPos < skeletonEnd) {
-                size_t colonPos = buffer.find(':', fieldPos);
-                if (colonPos != std::string::npos) {
-                    size_t quoteStart = buffer.find('"', colonPos);
-                    size_t quoteEnd = buffer.find('"', quoteStart + 1);
-                    if (quoteStart != std::string::npos && quoteEnd != std::string::npos) {
-                        return buffer.substr(quoteStart + 1, quoteEnd - quoteStart - 1);
-                    }
-                }
-            }
-            return "";
-        };
-        
-        // 解析数字字段的lambda
-        auto parseFloatField = [&](const std::string& fieldName) -> float {
-            size_t fieldPos = buffer.find("\"" + fieldName + "\"", bracePos);
-            if (fieldPos != std::string::npos && fieldPos < skeletonEnd) {
-                size_t colonPos = buffer.find(':', fieldPos);
-                if (colonPos != std::string::npos) {
-                    size_t numStart = colonPos + 1;
-                    while (numStart < buffer.length() && (buffer[numStart] == ' ' || buffer[numStart] == '\t')) numStart++;
-                    size_t numEnd = numStart;
-                    while (numEnd < buffer.length() && (std::isdigit(buffer[numEnd]) || buffer[numEnd] == '.' || buffer[numEnd] == '-')) numEnd++;
-                    if (numEnd > numStart) {
-                        return std::stof(buffer.substr(numStart, numEnd - numStart));
-                    }
-                }
-            }
-            return 0.0f;
-        };
-        
-        // 解析所有字段
-        info.version = parseStringField("spine");
-        if (info.version.empty()) return info;
-        
-        info.x = parseFloatField("x");
-        info.y = parseFloatField("y");
-        info.width = parseFloatField("width");
-        info.height = parseFloatField("height");
-        
-        info.valid = true;
-    } catch (...) {}
-    return info;
-}
-
-ParsedSkeletonInfo parseSkelSkeleton(const std::wstring& skelPath) {
-    ParsedSkeletonInfo info;
-    try {
-        std::ifstream ifs(skelPath, std::ios::binary);
-        if (!ifs) return info;
-        
-        auto readVarint = [](std::istream& s) -> int {
-            int result = 0;
-            int shift = 0;
-            while (true) {
-                char b;
-                s.read(&b, 1);
-                result |= (b & 0x7F) << shift;
-                if (!(b & 0x80)) break;
-                shift += 7;
-            }
-            return result;
-        };
-        auto readString = [&](std::istream& s) -> std::string {
-            int len = readVarint(s);
-            if (len == 0) return std::string();
-            std::string str(len - 1, '\0');
-            s.read(&str[0], len - 1);
-            return str;
-        };
-        auto readInt = [](std::istream& s) -> int {
-            int result = 0;
-            char b;
-            s.read(&b, 1); result = (uint8_t)b;
-            result <<= 8;
-            s.read(&b, 1); result |= (uint8_t)b;
-            result <<= 8;
-            s.read(&b, 1); result |= (uint8_t)b;
-            result <<= 8;
-            s.read(&b, 1); result |= (uint8_t)b;
-            return result;
-        };
-        auto readFloat = [&](std::istream& s) -> float {
-            union {
-                int intValue;
-                float floatValue;
-            } intToFloat;
-            intToFloat.intValue = readInt(s);
-            return intToFloat.floatValue;
-        };
-        
-        // 先读取前64字节来检测版本
-        std::streampos startPos = ifs.tellg();
-        char buffer[64];
-        ifs.read(buffer, 64);
-        ifs.seekg(startPos); // 重置到开始位置
-        
-        std::string bufferStr(buffer, 64);
-        bool isNewFormat = false;
-        
-        // 在缓冲区中查找版本字符串
-        if (bufferStr.find("4.2.") != std::string::npos ||
-            bufferStr.find("4.1.") != std::string::npos ||
-            bufferStr.find("4.0.") != std::string::npos) {
-            isNewFormat = true;
-        } else if (bufferStr.find("3.8.") != std::string::npos ||
-                   bufferStr.find("3.7.") != std::string::npos) {
-            isNewFormat = false;
-        } else {
-            // 如果没找到明确版本标识，尝试新格式
-            isNewFormat = true;
-        }
-        
-        if (isNewFormat) {
-            // 新格式（4.0+）：先读两个int作为hash
-            readInt(ifs); // lowHash
-            readInt(ifs); // highHash
-            info.version = readString(ifs);
-        } else {
-            // 旧格式（3.7, 3.8）：直接读取hash字符串
-            readString(ifs); // hash
-            info.version = readString(ifs); // version
-        }
-        
-        // 根据版本读取bounds
-        std::string v = info.version.substr(0, 3);
-        if (v == "3.7") {
-            // 3.7版本没有x,y字段
-            info.x = 0.0f;
-            info.y = 0.0f;
-            info.width = readFloat(ifs);
-            info.height = readFloat(ifs);
-        } else {
-            // 3.8+ 版本有x,y,width,height
-            info.x = readFloat(ifs);
-            info.y = readFloat(ifs);
-            info.width = readFloat(ifs);
-            info.height = readFloat(ifs);
-        }
-        
-        info.valid = true;
-    } catch (...) {}
-    return info;
-}
-
-bool parseAtlasPMA(const std::wstring& atlasPath, bool defaultPma) {
-    try {
-        std::ifstream ifs(atlasPath);
-        if (!ifs) return defaultPma;
-        std::string line;
-        int lineCount = 0;
-        while (std::getline(ifs, line) && lineCount < 10) {
-            lineCount++;
-            if (line.find("pma") != std::string::npos) {
-                if (line.find("true") != std::string::npos) return true;
-                else return false;
-            }
-        }
-        return defaultPma;
-    } catch (...) { return defaultPma; }
-}
-
 WmaskEXAssetConfig::SpineVersion getSpineVersionFromString(const std::string& versionStr) {
     if (versionStr.starts_with("3.7")) return WmaskEXAssetConfig::SpineVersion::SV_37;
     if (versionStr.starts_with("3.8")) return WmaskEXAssetConfig::SpineVersion::SV_38;
@@ -299,104 +103,114 @@ bool getRandomAsset(const std::wstring& assetsPath, bool defaultPma, WmaskEXAsse
         LOG(L"ERROR: Assets path invalid: " + assetsPath);
         return false;
     }
-    
-    struct SpineAssetPaths {
-        fs::path atlasFile;
-        fs::path jsonFile;
-        fs::path skelFile;
-    };
-    
-    std::vector<SpineAssetPaths> spineAssets;
-    std::vector<fs::path> imageAssets;
 
-    // 扫描 Spine 资源：以 .atlas 文件为基准，只收集路径
-    for (const auto& entry : fs::recursive_directory_iterator(assetsDir)) {
-        if (entry.is_regular_file()) {
-            fs::path filePath = entry.path();
-            
-            // 检查是否是 .atlas 文件
-            if (filePath.extension() == L".atlas") {
-                auto stem = filePath.stem();
-                auto dir = filePath.parent_path();
-                fs::path jsonFile = dir / (stem.wstring() + L".json");
-                fs::path skelFile = dir / (stem.wstring() + L".skel");
-                
-                // 检查同名的 .json 或 .skel 文件是否存在
-                if (fs::exists(jsonFile) || fs::exists(skelFile)) {
-                    spineAssets.push_back({filePath, jsonFile, skelFile});
-                }
-            }
+    // 每个资源目录一个持久化索引，只重新扫描修改时间变化过的子目录
+    struct CachedAssetIndex {
+        std::unique_ptr<WmaskEXAssetIndex> index;
+        float lastRefreshTime = 0.0f;
+    };
+    static std::map<std::wstring, CachedAssetIndex> assetIndices;
+    float currentTime = getCurrentTimeInSeconds();
+    CachedAssetIndex& cached = assetIndices[assetsPath];
+    if (!cached.index) {
+        // 索引文件名取资源路径的 FNV-1a 哈希
+        uint64_t hash = 14695981039346656037ull;
+        for (wchar_t c : assetsPath) {
+            hash ^= static_cast<uint64_t>(c);
+            hash *= 1099511628211ull;
         }
+        std::wstringstream indexName;
+        indexName << std::hex << std::setw(16) << std::setfill(L'0') << hash << L".json";
+        cached.index = std::make_unique<WmaskEXAssetIndex>(assetsDir, fs::path(wmaskEXAssetIndexDirectory) / indexName.str(), validImageExtensions);
+        cached.index->load();
+        if (cached.index->refresh()) cached.index->save();
+        cached.lastRefreshTime = currentTime;
+    } else if (currentTime - cached.lastRefreshTime > wmaskEXAssetIndexRefreshDuration) {
+        if (cached.index->refresh()) cached.index->save();
+        cached.lastRefreshTime = currentTime;
     }
 
-    // 扫描图片资源：只收集路径
-    for (const auto& entry : fs::directory_iterator(assetsDir)) {
-        if (entry.is_regular_file()) {
-            fs::path filePath = entry.path();
-            
-            std::wstring ext = filePath.extension().wstring();
-            std::transform(ext.begin(), ext.end(), ext.begin(), ::towlower);
-            if (validImageExtensions.contains(ext)) {
-                imageAssets.push_back(filePath);
-            }
-        }
-    }
-    
-    // 计算总资源数量
-    size_t totalAssets = spineAssets.size() + imageAssets.size();
-    if (totalAssets == 0) {
+    const auto& assets = cached.index->getAssets();
+    if (assets.empty()) {
         return false;
     }
-    
+
     // 随机选择一个资源
     static std::random_device rd;
     static std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, totalAssets - 1);
-    size_t selectedIndex = dis(gen);
-    
+    std::uniform_int_distribution<size_t> dis(0, assets.size() - 1);
+    const WmaskEXIndexedAsset& asset = assets[dis(gen)];
+
     // 如果选中的是Spine资源
-    if (selectedIndex < spineAssets.size()) {
-        const auto& spineAsset = spineAssets[selectedIndex];
-        
+    if (asset.isSpine) {
         assetConfig.type = WmaskEXAssetConfig::AssetType::AT_Spine;
-        assetConfig.assetPath = spineAsset.atlasFile.wstring();
-        assetConfig.pma = true;
-        
-        bool parseSuccess = false;
-
-        ParsedSkeletonInfo info;
-        if (fs::exists(spineAsset.skelFile)) {
-            info = parseSkelSkeleton(spineAsset.skelFile.wstring());
-        } else if (fs::exists(spineAsset.jsonFile)) {
-            info = parseJsonSkeleton(spineAsset.jsonFile.wstring());
-        }
-
-        if (info.valid) {
-            assetConfig.spineVersion = getSpineVersionFromString(info.version);
-            assetConfig.bounds.x = info.x;
-            assetConfig.bounds.y = info.y;
-            assetConfig.bounds.width = info.width;
-            assetConfig.bounds.height = info.height;
-            assetConfig.pma = parseAtlasPMA(spineAsset.atlasFile.wstring(), defaultPma);
-            parseSuccess = true;
-        }
-        
-        // 如果解析失败，返回false
-        if (!parseSuccess || assetConfig.spineVersion == WmaskEXAssetConfig::SpineVersion::SV_Invalid) {
-            return false;
-        }
-        
-        return true;
+        assetConfig.assetPath = asset.path.wstring();
+        assetConfig.spineVersion = getSpineVersionFromString(asset.version);
+        assetConfig.bounds = asset.bounds;
+        assetConfig.pma = asset.pma.value_or(defaultPma);
+        return assetConfig.spineVersion != WmaskEXAssetConfig::SpineVersion::SV_Invalid;
     }
     // 如果选中的是图片资源
     else {
-        size_t imageIndex = selectedIndex - spineAssets.size();
         assetConfig.type = WmaskEXAssetConfig::AssetType::AT_Image;
-        assetConfig.assetPath = imageAssets[imageIndex].wstring();
+        assetConfig.assetPath = asset.path.wstring();
         return true;
     }
 }
 
+fs::path getSkeletonPath(const fs::path& atlasPath) {
+    // 同名的 .skel 优先于 .json
+    fs::path skelPath = fs::path(atlasPath).replace_extension(L".skel");
+    if (fs::exists(skelPath)) return skelPath;
+    return fs::path(atlasPath).replace_extension(L".json");
+}
+
+// Exact bounds of the spine assets, measured in the background and kept next to the asset indices.
+// Never destroyed, a measurement may still run while the process exits.
+WmaskEXBoundsCache& getWmaskEXBoundsCache() {
+    static WmaskEXBoundsCache* cache = [] {
+        auto* cache = new WmaskEXBoundsCache(fs::path(wmaskEXAssetIndexDirectory) / wmaskEXBoundsCacheFile);
+        cache->load();
+        return cache;
+    }();
+    return *cache;
+}
+
+WmaskEXPreloadedAsset preloadWmaskEXAsset(const std::wstring& assetsPath, bool defaultPma, HGLRC shareContext) {
+    WmaskEXPreloadedAsset preloaded;
+    preloaded.valid = getRandomAsset(assetsPath, defaultPma, preloaded.assetConfig);
+    if (!preloaded.valid || preloaded.assetConfig.type != WmaskEXAssetConfig::AssetType::AT_Spine)
+        return preloaded;
+    // 只解析文件和解码纹理，纹理上传和窗口创建留给 UI 线程
+    preloaded.spineRuntime.reset(createSpineRuntime(preloaded.assetConfig.spineVersion));
+    preloaded.spineRuntime->setShareGroup(shareContext);
+    fs::path atlasPath = preloaded.assetConfig.assetPath;
+    fs::path skeletonPath = getSkeletonPath(atlasPath);
+    std::u8string atlasPathString = atlasPath.u8string();
+    std::u8string skeletonPathString = skeletonPath.u8string();
+
+    // The header's bounds are often off, use the measured ones once the cache has them
+    WmaskEXBoundsCache& boundsCache = getWmaskEXBoundsCache();
+    std::string boundsKey = boundsCache.getKey({ atlasPath, skeletonPath });
+    if (auto exact = boundsCache.find(boundsKey)) {
+        if (exact->bounds.width > 0 && exact->bounds.height > 0) preloaded.assetConfig.bounds = exact->bounds;
+        preloaded.assetConfig.animationBounds = exact->animations;
+    } else {
+        WmaskEXAssetConfig::SpineVersion spineVersion = preloaded.assetConfig.spineVersion;
+        boundsCache.request(boundsKey, [spineVersion, atlasPathString, skeletonPathString]() -> std::optional<std::map<std::string, Bounds>> {
+            std::unique_ptr<ISpineRuntime> runtime(createSpineRuntime(spineVersion));
+            std::map<std::string, Bounds> animations;
+            if (!runtime || !runtime->measureBounds(reinterpret_cast<const char*>(atlasPathString.c_str()), reinterpret_cast<const char*>(skeletonPathString.c_str()), animations))
+                return std::nullopt;
+            return animations;
+        });
+    }
+    // A failed preload is retried and logged by init() when the window is created
+    if (!preloaded.spineRuntime->preload(reinterpret_cast<const char*>(atlasPathString.c_str()), reinterpret_cast<const char*>(skeletonPathString.c_str())))
+        preloaded.spineRuntime.reset();
+    return preloaded;
+}
+
 bool openConfig(const std::wstring& configFilePath, std::map<std::wstring, WmaskEXConfig>& configs) {
     configs.clear();
     try {
@@ -8,7 +8,9 @@
 #include <gdiplus.h>
 #include <Psapi.h>
 
+#include <cfloat>
 #include <chrono>
+#include <cmath>
 #include <filesystem>
 #include <fstream>
 #include <glbinding/gl/gl.h>
@@ -16,6 +18,8 @@
 #include <glbinding/Binding.h>
 #include <iomanip>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <random>
 #include <set>
@@ -24,6 +28,15 @@
 #include <vector>
 #include "res/resource.h"
 #include "ISpineRuntime.h"
+#include "PhaseStats.h"
+#include "WmaskEXAssetIndex.h"
+#include "WmaskEXPreloader.h"
+#include "WmaskEXBackendSelector.h"
+#include "WmaskEXBoundsCache.h"
+#include "WmaskEXFramePacer.h"
+#include "WmaskEXReadbackRing.h"
+#include "WmaskEXSurface.h"
+#include "WmaskEXUpdatePool.h"
 
 #pragma comment(linker,"\"/manifestdependency:type='win32' \
 name='Microsoft.Windows.Common-Controls' version='6.0.0.0' \
@@ -51,7 +64,14 @@ using namespace gl;
 const int wmaskEXRefreshDuration = 100; // ms
 const int wmaskEXImageRefreshDuration = 100; // ms
 const int wmaskEXSpineRefreshDuration = 40; // ms
+const int wmaskEXSpineIdleRefreshDuration = 200; // ms
+const int wmaskEXSpineHiddenRefreshDuration = 1000; // ms
 const double wmaskEXSpineAnimationMinDuration = 0.5; // s
+const float wmaskEXSpineDefaultMix = 0.2f; // s
+const int wmaskEXSpineViewMargin = 2; // px kept around an animation's box, for filtering and poses between the measured ones
+const float wmaskEXAssetIndexRefreshDuration = 60.0f; // s
+const wchar_t* const wmaskEXAssetIndexDirectory = L".wmaskex-index";
+const wchar_t* const wmaskEXBoundsCacheFile = L"bounds.json"; // in wmaskEXAssetIndexDirectory
 const std::set<std::wstring> validImageExtensions = { L".png", L".jpg", L".jpeg", L".bmp", L".ico", L".tiff", L".exif", L".wmf", L".emf" };
 const std::vector<std::string> validSpineVersions = { "3.7", "3.8", "4.0", "4.1", "4.2" };
 
@@ -107,9 +127,17 @@ struct WmaskEXAssetConfig {
     std::wstring assetPath;
     SpineVersion spineVersion;
     Bounds bounds;
+    std::map<std::string, Bounds> animationBounds; // measured boxes of the animations, empty until the bounds cache has the asset
     bool pma; 
 }; 
 
+// Next asset of a config, picked and loaded by the preloader's worker thread
+struct WmaskEXPreloadedAsset {
+    bool valid; 
+    WmaskEXAssetConfig assetConfig; 
+    std::unique_ptr<ISpineRuntime> spineRuntime; // preloaded with the asset, spine assets only
+}; 
+
 struct WmaskEXImage {
     WmaskEXConfig config;
     HWND parentHwnd; 
@@ -121,21 +149,49 @@ struct WmaskEXSpine {
     WmaskEXConfig config;
     HWND parentHwnd; 
     ISpineRuntime* spineRuntime;
+    WmaskEXAssetConfig::SpineVersion spineVersion; 
+    HGLRC shareContext; 
+    RenderBackend backend; 
+    WmaskEXBackendSelector backendSelector; 
+    bool switchingBackend; // a runtime drawing with the backend the selector picked is being built
     Bounds bounds;
+    std::map<std::string, Bounds> animationBounds; // measured boxes of the animations known so far
+    std::string measuringAnimation; // measured by the pending update, empty if none
+    Bounds measuredBounds; // written by the pending update
     bool pma;
     std::vector<std::string> skinNames;
     bool multiSkin; 
     std::vector<std::string> animationNames;
     std::vector<float> animationDurations;
     int curIdx; 
+    int prevIdx; // animation mixed out of since the last switch, -1 before the first one
+    int curSkin; 
     float lastUpdateTime;
     float lastUpdateAnimationTime;
+    float poseTime; // time the runtime's pose is advanced to, ahead of the tick showing it
+    float runtimeLag; // s the runtime's pose is behind poseTime, e.g. a new runtime at the start of the animation
+    WmaskEXUpdatePool::Ticket pendingUpdate; // advances and prepares the next frame on the update pool
+    float updateCost; // ms the last pending update took
+    float prepareCost; // ms of it spent preparing the frame
     HDC hdc;
     HGLRC hglrc;
     GLuint fboID, textureID;
-    std::vector<BYTE> pixels;
+    std::unique_ptr<WmaskEXReadbackBackend> readbackBackend; 
+    std::unique_ptr<WmaskEXReadbackRing> readbackRing; 
+    std::unique_ptr<WmaskEXSurfaceBackend> surfaceBackend; 
+    std::unique_ptr<WmaskEXSurface> surface; 
     SIZE parentSize; 
+    RECT frameView; // part of the parent's client area the pending update lays out its frame for
+    POINT viewOrigin; // of the part of the parent's client area the window covers
+    SIZE viewSize; // of the window, its viewport and its buffers
+    bool fullComposite; // the next frame must update the layered window as a whole, e.g. after a resize
+    WmaskEXFramePacer framePacer; 
+    int timerInterval; // ms
     int x, y; 
+    float scale; 
+    std::wstring assetPath; 
+    PhaseHistogram readbackTime; 
+    PhaseHistogram compositeTime; 
 }; 
 
 struct ChildHwndInfo {
@@ -157,6 +213,7 @@ public:
 private:
     static std::wofstream logFile; 
     static bool initialized; 
+    static std::mutex mutex; 
 }; 
 #define LOG(msg) WmaskEXLog::log(msg)
 
@@ -165,6 +222,8 @@ float getRandomFloat();
 float getCurrentTimeInSeconds();
 bool isValidWmaskEXParentWindow(HWND); 
 bool getRandomAsset(const std::wstring& assetsPath, bool defaultPma, WmaskEXAssetConfig& assetConfig);
+fs::path getSkeletonPath(const fs::path& atlasPath); 
+WmaskEXPreloadedAsset preloadWmaskEXAsset(const std::wstring& assetsPath, bool defaultPma, HGLRC shareContext); 
 bool openConfig(const std::wstring& configFilePath, std::map<std::wstring, WmaskEXConfig>& configs); 
 bool saveConfig(const std::wstring& configFilePath, const std::map<std::wstring, WmaskEXConfig>& configs); 
 
@@ -177,7 +236,9 @@ void registerWmaskEXImageClass();
 HWND createWmaskEXImageWindow(const WmaskEXConfig& config, const WmaskEXAssetConfig& assetConfig);
 
 void registerWmaskEXSpineClass();
-HWND createWmaskEXSpineWindow(const WmaskEXConfig& config, const WmaskEXAssetConfig& assetConfig);
+HWND createWmaskEXSpineWindow(const WmaskEXConfig& config, const WmaskEXAssetConfig& assetConfig, std::unique_ptr<ISpineRuntime> spineRuntime = nullptr);
+HGLRC getWmaskEXSpineShareContext(); 
+ISpineRuntime* createSpineRuntime(WmaskEXAssetConfig::SpineVersion spineVersion); 
 
 // ISpineRuntime Function
 extern "C" __declspec(dllimport) ISpineRuntime* createSpineRuntime37(); 
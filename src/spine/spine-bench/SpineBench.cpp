@@ -0,0 +1,521 @@
+#include "SpineBench.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <spine/spine.h>
+#include "PhaseStats.h"
+#include "spine-alloc.h"
+#include "spine-file.h"
+#include "spine-software.h"
+
+using namespace spine;
+
+/// A TextureLoader that loads nothing, pages get a dummy non-null texture so SkeletonRenderer
+/// batches them as usual
+class NoopTextureLoader : public TextureLoader {
+public:
+    void load(AtlasPage &page, const String &) override {
+#if defined(SPINE37) || defined(SPINE38) || defined(SPINE40)
+        page.setRendererObject(&page);
+#elif defined(SPINE41) || defined(SPINE42)
+        page.texture = &page;
+#endif
+    }
+
+    void unload(void *) override {}
+};
+
+/// A NoopTextureLoader that records the paths of the pages
+class PagePathLoader : public NoopTextureLoader {
+public:
+    void load(AtlasPage &page, const String &path) override {
+        NoopTextureLoader::load(page, path);
+        paths.push_back(path.buffer());
+    }
+
+    std::vector<std::string> paths;
+};
+
+/// Parses the skeleton file with the parser matching its extension
+static SkeletonData* readSkeletonData(Atlas* atlas, const std::string& skeletonPath, std::string& error) {
+    SkeletonData* skeletonData = nullptr;
+    if (skeletonPath.ends_with(".skel")) {
+        SkeletonBinary binary(atlas);
+        skeletonData = binary.readSkeletonDataFile(skeletonPath.c_str());
+        if (!skeletonData) error = binary.getError().buffer();
+    } else {
+        SkeletonJson json(atlas);
+        skeletonData = json.readSkeletonDataFile(skeletonPath.c_str());
+        if (!skeletonData) error = json.getError().buffer();
+    }
+    return skeletonData;
+}
+
+/// Same skin choice as the overlay: the default skin is often empty when others exist
+static void setOverlaySkin(Skeleton& skeleton, SkeletonData* skeletonData) {
+    Vector<Skin*>& skins = skeletonData->getSkins();
+    for (size_t i = 0; i < skins.size(); i++) {
+        if (skins[i] != skeletonData->getDefaultSkin()) {
+            skeleton.setSkin(skins[i]);
+            skeleton.setSlotsToSetupPose();
+            break;
+        }
+    }
+}
+
+/// Advances the skeleton by deltaTime, as SpineRuntime::update does
+static void updateSkeleton(AnimationState& state, Skeleton& skeleton, float deltaTime) {
+    state.update(deltaTime);
+    state.apply(skeleton);
+#if defined(SPINE37) || defined(SPINE38) || defined(SPINE40) || defined(SPINE42)
+    skeleton.update(deltaTime);
+#endif
+#if defined(SPINE37) || defined(SPINE38) || defined(SPINE40) || defined(SPINE41)
+    skeleton.updateWorldTransform();
+#elif defined(SPINE42)
+    skeleton.updateWorldTransform(Physics_Update);
+#endif
+}
+
+static bool runSpineBench(const SpineBenchCase& benchCase, SpineBenchResult& result) {
+    PhaseHistogram atlasParse, skeletonParse, skeletonSpawn, stateUpdate, stateApply, worldTransform, render, bounds;
+    NoopTextureLoader textureLoader;
+    Atlas* atlas = nullptr;
+    SkeletonData* skeletonData = nullptr;
+    spine_allocation_sites_reset();
+    for (int i = 0; i < std::max(benchCase.parseRepeats, 1); i++) {
+        if (skeletonData) delete skeletonData;
+        if (atlas) delete atlas;
+        {
+            ScopedPhaseTimer timer(&atlasParse);
+            atlas = new Atlas(benchCase.atlasPath.c_str(), &textureLoader);
+        }
+        ScopedPhaseTimer timer(&skeletonParse);
+        skeletonData = readSkeletonData(atlas, benchCase.skeletonPath, result.error);
+        if (!skeletonData) break;
+    }
+    result.loaded = skeletonData != nullptr;
+
+    if (skeletonData) {
+        for (int i = 0; i < benchCase.spawnRepeats; i++) {
+            ScopedPhaseTimer timer(&skeletonSpawn);
+            Skeleton spawned(skeletonData, benchCase.boneTransformBlock);
+        }
+        Skeleton skeleton(skeletonData, benchCase.boneTransformBlock);
+        AnimationStateData stateData(skeletonData);
+        AnimationState state(&stateData);
+        setOverlaySkin(skeleton, skeletonData);
+        SkeletonRenderer renderer;
+        Vector<float> boundsVertices;
+        Vector<Animation*>& animations = skeletonData->getAnimations();
+        result.animations = (int) animations.size();
+        for (size_t i = 0; i < animations.size(); i++) {
+            state.setAnimation(0, animations[i], true);
+            for (int frame = 0; frame < benchCase.framesPerAnimation; frame++) {
+                {
+                    ScopedPhaseTimer timer(&stateUpdate);
+                    state.update(benchCase.deltaTime);
+                }
+                {
+                    ScopedPhaseTimer timer(&stateApply);
+                    state.apply(skeleton);
+                }
+#if defined(SPINE37) || defined(SPINE38) || defined(SPINE40) || defined(SPINE42)
+                skeleton.update(benchCase.deltaTime);
+#endif
+                {
+                    ScopedPhaseTimer timer(&worldTransform);
+#if defined(SPINE37) || defined(SPINE38) || defined(SPINE40) || defined(SPINE41)
+                    skeleton.updateWorldTransform();
+#elif defined(SPINE42)
+                    skeleton.updateWorldTransform(Physics_Update);
+#endif
+                }
+                {
+                    ScopedPhaseTimer timer(&render);
+                    renderer.render(skeleton);
+                }
+                float x, y, width, height;
+                ScopedPhaseTimer timer(&bounds);
+                skeleton.getBounds(x, y, width, height, boundsVertices);
+            }
+            result.frames += benchCase.framesPerAnimation;
+        }
+    }
+
+    result.phases = {
+        atlasParse.getStats("Atlas"),
+        skeletonParse.getStats("SkeletonData"),
+        skeletonSpawn.getStats("Skeleton spawn"),
+        stateUpdate.getStats("AnimationState::update"),
+        stateApply.getStats("AnimationState::apply"),
+        worldTransform.getStats("Skeleton::updateWorldTransform"),
+        render.getStats("SkeletonRenderer::render"),
+        bounds.getStats("Skeleton::getBounds")
+    };
+    if (skeletonData) delete skeletonData;
+    if (atlas) delete atlas;
+    result.allocationSites = spine_allocation_sites(benchCase.allocationSites);
+    return result.loaded;
+}
+
+static const char* getSkinningKernelName(SkinningKernel kernel) {
+    switch (kernel) {
+    case SkinningKernel_SSE2: return "sse2";
+    case SkinningKernel_AVX2: return "avx2";
+    case SkinningKernel_NEON: return "neon";
+    default: return "scalar";
+    }
+}
+
+static bool checkSpineSkinning(const SpineBenchCase& benchCase, std::vector<SpineSkinningResult>& results, std::string& error) {
+    NoopTextureLoader textureLoader;
+    Atlas atlas(benchCase.atlasPath.c_str(), &textureLoader);
+    SkeletonData* skeletonData = readSkeletonData(&atlas, benchCase.skeletonPath, error);
+    if (!skeletonData) return false;
+
+    // SkinningKernel_None keeps the scalar loop, the reference every kernel is compared with
+    SkinningKernel best = VertexSkinning::getKernel();
+    std::vector<SkinningKernel> kernels = { SkinningKernel_None };
+    if (best == SkinningKernel_AVX2) kernels.push_back(SkinningKernel_SSE2);
+    if (best != SkinningKernel_None) kernels.push_back(best);
+    std::vector<PhaseHistogram> times(kernels.size());
+    std::vector<std::vector<float>> worldVertices(kernels.size());
+    results.assign(kernels.size(), SpineSkinningResult());
+
+    Skeleton skeleton(skeletonData, benchCase.boneTransformBlock);
+    AnimationStateData stateData(skeletonData);
+    AnimationState state(&stateData);
+    setOverlaySkin(skeleton, skeletonData);
+    Vector<Animation*>& animations = skeletonData->getAnimations();
+    for (size_t i = 0; i < animations.size(); i++) {
+        state.setAnimation(0, animations[i], true);
+        for (int frame = 0; frame < benchCase.framesPerAnimation; frame++) {
+            updateSkeleton(state, skeleton, benchCase.deltaTime);
+            Vector<Slot*>& slots = skeleton.getSlots();
+            for (size_t k = 0; k < kernels.size(); k++) {
+                VertexSkinning::setKernel(kernels[k]);
+                std::vector<float>& out = worldVertices[k];
+                out.clear();
+                ScopedPhaseTimer timer(&times[k]);
+                for (size_t s = 0; s < slots.size(); s++) {
+                    Attachment* attachment = slots[s]->getAttachment();
+                    if (!attachment || !attachment->getRTTI().instanceOf(VertexAttachment::rtti)) continue;
+                    VertexAttachment* vertexAttachment = (VertexAttachment*) attachment;
+                    if (vertexAttachment->getBones().size() == 0) continue;
+                    size_t offset = out.size();
+                    out.resize(offset + vertexAttachment->getWorldVerticesLength());
+                    vertexAttachment->computeWorldVertices(*slots[s], 0, vertexAttachment->getWorldVerticesLength(), out.data(), offset, 2);
+                }
+            }
+            for (size_t k = 0; k < kernels.size(); k++) {
+                const std::vector<float>& reference = worldVertices[0];
+                SpineSkinningResult& result = results[k];
+                result.vertices += (int) reference.size();
+                for (size_t j = 0; j < reference.size(); j++) {
+                    if (!memcmp(&reference[j], &worldVertices[k][j], sizeof(float))) continue;
+                    result.mismatches++;
+                    float difference = std::fabs(reference[j] - worldVertices[k][j]) / std::max(1.0f, std::fabs(reference[j]));
+                    result.maxError = std::max(result.maxError, difference);
+                }
+            }
+        }
+    }
+    VertexSkinning::setKernel(best);
+    for (size_t k = 0; k < kernels.size(); k++) {
+        results[k].kernel = getSkinningKernelName(kernels[k]);
+        results[k].time = times[k].getStats("weighted skinning");
+    }
+    delete skeletonData;
+    return true;
+}
+
+/// The class name comparison of RTTI::isExactly before it compared addresses
+static bool isExactlyByName(const RTTI& rtti, const RTTI& other) {
+#if defined(SPINE37)
+    return rtti.getClassName() == other.getClassName();
+#else
+    return !strcmp(rtti.getClassName(), other.getClassName());
+#endif
+}
+
+/// Classifies the attachments of the skeleton with the checks SkeletonRenderer::render makes, and
+/// returns a sum of the classes so both comparisons can be told apart and cannot be optimized out
+template<bool byName>
+static int classifyAttachments(Skeleton& skeleton) {
+    Vector<Slot*>& slots = skeleton.getSlots();
+    int sum = 0;
+    for (size_t i = 0; i < slots.size(); i++) {
+        Attachment* attachment = slots[i]->getAttachment();
+        if (!attachment) continue;
+        const RTTI& rtti = attachment->getRTTI();
+        int type = 0;
+        if (byName ? isExactlyByName(rtti, RegionAttachment::rtti) : rtti.isExactly(RegionAttachment::rtti)) type = 1;
+        else if (byName ? isExactlyByName(rtti, MeshAttachment::rtti) : rtti.isExactly(MeshAttachment::rtti)) type = 2;
+        else if (byName ? isExactlyByName(rtti, ClippingAttachment::rtti) : rtti.isExactly(ClippingAttachment::rtti)) type = 3;
+        sum += type * (int) (i + 1);
+    }
+    return sum;
+}
+
+static bool checkSpineRtti(const SpineBenchCase& benchCase, SpineRttiResult& result, std::string& error) {
+    NoopTextureLoader textureLoader;
+    Atlas atlas(benchCase.atlasPath.c_str(), &textureLoader);
+    SkeletonData* skeletonData = readSkeletonData(&atlas, benchCase.skeletonPath, error);
+    if (!skeletonData) return false;
+
+    Skeleton skeleton(skeletonData, benchCase.boneTransformBlock);
+    AnimationStateData stateData(skeletonData);
+    AnimationState state(&stateData);
+    setOverlaySkin(skeleton, skeletonData);
+    PhaseHistogram names, addresses;
+    Vector<Animation*>& animations = skeletonData->getAnimations();
+    for (size_t i = 0; i < animations.size(); i++) {
+        state.setAnimation(0, animations[i], true);
+        for (int frame = 0; frame < benchCase.framesPerAnimation; frame++) {
+            updateSkeleton(state, skeleton, benchCase.deltaTime);
+            int slots = 0;
+            for (size_t s = 0; s < skeleton.getSlots().size(); s++)
+                if (skeleton.getSlots()[s]->getAttachment()) slots++;
+            result.slots = std::max(result.slots, slots);
+            // Alternate which comparison runs first, so neither always finds the slots in the cache
+            int byName, byAddress;
+            for (int pass = 0; pass < 2; pass++) {
+                if ((pass + frame) % 2 == 0) {
+                    ScopedPhaseTimer timer(&names);
+                    byName = classifyAttachments<true>(skeleton);
+                } else {
+                    ScopedPhaseTimer timer(&addresses);
+                    byAddress = classifyAttachments<false>(skeleton);
+                }
+            }
+            if (byName != byAddress) result.mismatches++;
+        }
+    }
+    result.names = names.getStats("RTTI by class name");
+    result.addresses = addresses.getStats("RTTI by address");
+    delete skeletonData;
+    return true;
+}
+
+static bool checkSpineDecode(const SpineBenchCase& benchCase, SpineDecodeResult& result, std::string& error) {
+    PagePathLoader textureLoader;
+    {
+        Atlas atlas(benchCase.atlasPath.c_str(), &textureLoader);
+    }
+    const std::vector<std::string>& paths = textureLoader.paths;
+    if (paths.empty()) {
+        error = "No atlas pages";
+        return false;
+    }
+    result.pages = (int) paths.size();
+    PhaseHistogram sequential, batched;
+    for (int repeat = 0; repeat < benchCase.parseRepeats; repeat++) {
+        std::vector<image_t*> images, batchImages;
+        {
+            ScopedPhaseTimer timer(&sequential);
+            for (const auto& path : paths) images.push_back(image_load(path.c_str()));
+        }
+        {
+            // Includes starting and joining the pool, as loading an atlas does when no other is loaded
+            ScopedPhaseTimer timer(&batched);
+            image_batch_t* batch = image_batch_create();
+            for (const auto& path : paths) image_batch_add(batch, path.c_str());
+            for (int i = 0; i < (int) paths.size(); i++) batchImages.push_back(image_batch_take(batch, i));
+            image_batch_dispose(batch);
+        }
+        for (size_t i = 0; i < paths.size(); i++) {
+            if (!images[i]) {
+                error = "Failed to decode " + paths[i];
+            } else if (!batchImages[i] || batchImages[i]->width != images[i]->width || batchImages[i]->height != images[i]->height
+                || memcmp(batchImages[i]->pixels, images[i]->pixels, (size_t) images[i]->width * images[i]->height * 4)) {
+                result.mismatches++;
+            }
+            image_dispose(images[i]);
+            image_dispose(batchImages[i]);
+        }
+        if (!error.empty()) return false;
+    }
+    result.sequential = sequential.getStats("image_load one page after another");
+    result.batch = batched.getStats("image_batch");
+    return true;
+}
+
+/// FNV-1a over the bytes of data
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*) data;
+    for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 1099511628211ull;
+    return hash;
+}
+
+/// Hash of the render commands by value, textures are left out since they differ between atlases
+static uint64_t hashRenderCommands(RenderCommand* command) {
+    uint64_t hash = 14695981039346656037ull;
+    for (; command; command = command->next) {
+        hash = hashBytes(hash, command->positions, command->numVertices * 2 * sizeof(float));
+        hash = hashBytes(hash, command->uvs, command->numVertices * 2 * sizeof(float));
+        hash = hashBytes(hash, command->colors, command->numVertices * sizeof(uint32_t));
+        hash = hashBytes(hash, command->darkColors, command->numVertices * sizeof(uint32_t));
+        hash = hashBytes(hash, command->indices, command->numIndices * sizeof(uint16_t));
+        hash = hashBytes(hash, &command->blendMode, sizeof(command->blendMode));
+    }
+    return hash;
+}
+
+class SpineBenchInstance : public ISpineBenchInstance {
+public:
+    ~SpineBenchInstance() override {
+        delete state;
+        delete stateData;
+        delete skeleton;
+        delete skeletonData;
+        delete atlas;
+    }
+
+    bool load(const SpineBenchCase& benchCase, int animation, std::string& error) {
+        atlas = new Atlas(benchCase.atlasPath.c_str(), &textureLoader);
+        skeletonData = readSkeletonData(atlas, benchCase.skeletonPath, error);
+        if (!skeletonData) return false;
+        Vector<Animation*>& animations = skeletonData->getAnimations();
+        if (animations.size() == 0) {
+            error = "No animations";
+            return false;
+        }
+        skeleton = new Skeleton(skeletonData, benchCase.boneTransformBlock);
+        stateData = new AnimationStateData(skeletonData);
+        state = new AnimationState(stateData);
+        setOverlaySkin(*skeleton, skeletonData);
+        state->setAnimation(0, animations[animation % animations.size()], true);
+        return true;
+    }
+
+    void tick(float deltaTime) override {
+        updateSkeleton(*state, *skeleton, deltaTime);
+        frame = hashRenderCommands(renderer.render(*skeleton));
+    }
+
+    uint64_t getFrame() override {
+        return frame;
+    }
+
+private:
+    NoopTextureLoader textureLoader;
+    Atlas* atlas = nullptr;
+    SkeletonData* skeletonData = nullptr;
+    Skeleton* skeleton = nullptr;
+    AnimationStateData* stateData = nullptr;
+    AnimationState* state = nullptr;
+    SkeletonRenderer renderer;
+    uint64_t frame = 0;
+};
+
+static ISpineBenchInstance* createSpineBenchInstance(const SpineBenchCase& benchCase, int animation, std::string& error) {
+    auto* instance = new SpineBenchInstance();
+    if (!instance->load(benchCase, animation, error)) {
+        delete instance;
+        return nullptr;
+    }
+    return instance;
+}
+
+#if defined(SPINE37)
+extern "C" SPINE_BENCH_API bool runSpineBench37(const SpineBenchCase& benchCase, SpineBenchResult& result) {
+    return runSpineBench(benchCase, result);
+}
+
+extern "C" SPINE_BENCH_API ISpineBenchInstance* createSpineBenchInstance37(const SpineBenchCase& benchCase, int animation, std::string& error) {
+    return createSpineBenchInstance(benchCase, animation, error);
+}
+
+extern "C" SPINE_BENCH_API bool checkSpineSkinning37(const SpineBenchCase& benchCase, std::vector<SpineSkinningResult>& results, std::string& error) {
+    return checkSpineSkinning(benchCase, results, error);
+}
+
+extern "C" SPINE_BENCH_API bool checkSpineRtti37(const SpineBenchCase& benchCase, SpineRttiResult& result, std::string& error) {
+    return checkSpineRtti(benchCase, result, error);
+}
+
+extern "C" SPINE_BENCH_API bool checkSpineDecode37(const SpineBenchCase& benchCase, SpineDecodeResult& result, std::string& error) {
+    return checkSpineDecode(benchCase, result, error);
+}
+#elif defined(SPINE38)
+extern "C" SPINE_BENCH_API bool runSpineBench38(const SpineBenchCase& benchCase, SpineBenchResult& result) {
+    return runSpineBench(benchCase, result);
+}
+
+extern "C" SPINE_BENCH_API ISpineBenchInstance* createSpineBenchInstance38(const SpineBenchCase& benchCase, int animation, std::string& error) {
+    return createSpineBenchInstance(benchCase, animation, error);
+}
+
+extern "C" SPINE_BENCH_API bool checkSpineSkinning38(const SpineBenchCase& benchCase, std::vector<SpineSkinningResult>& results, std::string& error) {
+    return checkSpineSkinning(benchCase, results, error);
+}
+
+extern "C" SPINE_BENCH_API bool checkSpineRtti38(const SpineBenchCase& benchCase, SpineRttiResult& result, std::string& error) {
+    return checkSpineRtti(benchCase, result, error);
+}
+
+extern "C" SPINE_BENCH_API bool checkSpineDecode38(const SpineBenchCase& benchCase, SpineDecodeResult& result, std::string& error) {
+    return checkSpineDecode(benchCase, result, error);
+}
+#elif defined(SPINE40)
+extern "C" SPINE_BENCH_API bool runSpineBench40(const SpineBenchCase& benchCase, SpineBenchResult& result) {
+    return runSpineBench(benchCase, result);
+}
+
+extern "C" SPINE_BENCH_API ISpineBenchInstance* createSpineBenchInstance40(const SpineBenchCase& benchCase, int animation, std::string& error) {
+    return createSpineBenchInstance(benchCase, animation, error);
+}
+
+extern "C" SPINE_BENCH_API bool checkSpineSkinning40(const SpineBenchCase& benchCase, std::vector<SpineSkinningResult>& results, std::string& error) {
+    return checkSpineSkinning(benchCase, results, error);
+}
+
+extern "C" SPINE_BENCH_API bool checkSpineRtti40(const SpineBenchCase& benchCase, SpineRttiResult& result, std::string& error) {
+    return checkSpineRtti(benchCase, result, error);
+}
+
+extern "C" SPINE_BENCH_API bool checkSpineDecode40(const SpineBenchCase& benchCase, SpineDecodeResult& result, std::string& error) {
+    return checkSpineDecode(benchCase, result, error);
+}
+#elif defined(SPINE41)
+extern "C" SPINE_BENCH_API bool runSpineBench41(const SpineBenchCase& benchCase, SpineBenchResult& result) {
+    return runSpineBench(benchCase, result);
+}
+
+extern "C" SPINE_BENCH_API ISpineBenchInstance* createSpineBenchInstance41(const SpineBenchCase& benchCase, int animation, std::string& error) {
+    return createSpineBenchInstance(benchCase, animation, error);
+}
+
+extern "C" SPINE_BENCH_API bool checkSpineSkinning41(const SpineBenchCase& benchCase, std::vector<SpineSkinningResult>& results, std::string& error) {
+    return checkSpineSkinning(benchCase, results, error);
+}
+
+extern "C" SPINE_BENCH_API bool checkSpineRtti41(const SpineBenchCase& benchCase, SpineRttiResult& result, std::string& error) {
+    return checkSpineRtti(benchCase, result, error);
+}
+
+extern "C" SPINE_BENCH_API bool checkSpineDecode41(const SpineBenchCase& benchCase, SpineDecodeResult& result, std::string& error) {
+    return checkSpineDecode(benchCase, result, error);
+}
+#elif defined(SPINE42)
+extern "C" SPINE_BENCH_API bool runSpineBench42(const SpineBenchCase& benchCase, SpineBenchResult& result) {
+    return runSpineBench(benchCase, result);
+}
+
+extern "C" SPINE_BENCH_API ISpineBenchInstance* createSpineBenchInstance42(const SpineBenchCase& benchCase, int animation, std::string& error) {
+    return createSpineBenchInstance(benchCase, animation, error);
+}
+
+extern "C" SPINE_BENCH_API bool checkSpineSkinning42(const SpineBenchCase& benchCase, std::vector<SpineSkinningResult>& results, std::string& error) {
+    return checkSpineSkinning(benchCase, results, error);
+}
+
+extern "C" SPINE_BENCH_API bool checkSpineRtti42(const SpineBenchCase& benchCase, SpineRttiResult& result, std::string& error) {
+    return checkSpineRtti(benchCase, result, error);
+}
+
+extern "C" SPINE_BENCH_API bool checkSpineDecode42(const SpineBenchCase& benchCase, SpineDecodeResult& result, std::string& error) {
+    return checkSpineDecode(benchCase, result, error);
+}
+#endif
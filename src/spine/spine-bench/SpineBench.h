@@ -0,0 +1,125 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ISpineRuntime.h"
+
+#if defined(_WIN32)
+#define SPINE_BENCH_API __declspec(dllexport)
+#else
+#define SPINE_BENCH_API __attribute__((visibility("default")))
+#endif
+
+/// One asset to benchmark and how long to run it
+struct SpineBenchCase {
+    std::string atlasPath;
+    std::string skeletonPath;
+    int parseRepeats = 5;
+    int spawnRepeats = 100; // skeletons created and destroyed from the parsed data
+    int framesPerAnimation = 120;
+    float deltaTime = 1.0f / 60.0f;
+    bool boneTransformBlock = false; // see Skeleton::getBoneTransforms
+    size_t allocationSites = 20; // busiest call sites reported if the allocator counts them
+    int warmupFrames = 10; // frames of each animation after its first loop left out of the allocation check
+};
+
+/// Timings of one asset. phases holds the atlas and skeleton parse, the creation and destruction of a
+/// Skeleton, AnimationState::update, AnimationState::apply, Skeleton::updateWorldTransform,
+/// SkeletonRenderer::render and Skeleton::getBounds.
+struct SpineBenchResult {
+    bool loaded = false;
+    std::string error;
+    int animations = 0;
+    int frames = 0;
+    std::vector<PhaseStats> phases;
+    std::vector<AllocationSite> allocationSites; // of the whole run, empty unless WMASKEX_SPINE_ALLOCATOR is pool-stats
+};
+
+/// Weighted skinning of one SIMD kernel compared with the scalar loop over the frames of a case
+struct SpineSkinningResult {
+    std::string kernel;
+    int vertices = 0; // weighted world vertices compared, x and y each
+    int mismatches = 0; // of them not bit-identical to the scalar loop
+    float maxError = 0; // largest difference, relative to the magnitude of the value if above 1
+    PhaseStats time; // of all weighted attachments of a frame
+};
+
+/// The RTTI::isExactly checks of SkeletonRenderer::render over the frames of a case, comparing
+/// the RTTI objects by address as the runtimes do and by class name as they did before
+struct SpineRttiResult {
+    int slots = 0; // with an attachment, the most of any frame
+    int mismatches = 0; // frames where both comparisons classified an attachment differently
+    PhaseStats names; // per frame
+    PhaseStats addresses; // per frame
+};
+
+/// The atlas pages of a case decoded one after another with image_load and in parallel with an
+/// image_batch_t, each run once per parse repeat
+struct SpineDecodeResult {
+    int pages = 0;
+    int mismatches = 0; // pages the batch decoded differently from image_load
+    PhaseStats sequential; // of all pages
+    PhaseStats batch; // of all pages
+};
+
+/// One headless overlay of a case with its own skeleton data, ticked like the overlay's frames by
+/// the stress run of the update pool
+class ISpineBenchInstance {
+public:
+    virtual ~ISpineBenchInstance() = default;
+    /// Advances the animation by deltaTime and builds the render commands of the new pose
+    virtual void tick(float deltaTime) = 0;
+    /// Hash of the vertices, indices and blend modes of the render commands of the last tick, equal
+    /// for instances of the same case in the same pose
+    virtual uint64_t getFrame() = 0;
+};
+
+/// Runs a case through the Spine runtime of one version. Each version lives in its own shared
+/// library exporting nothing else, since all runtimes define the same spine:: symbols.
+extern "C" SPINE_BENCH_API bool runSpineBench37(const SpineBenchCase& benchCase, SpineBenchResult& result);
+extern "C" SPINE_BENCH_API bool runSpineBench38(const SpineBenchCase& benchCase, SpineBenchResult& result);
+extern "C" SPINE_BENCH_API bool runSpineBench40(const SpineBenchCase& benchCase, SpineBenchResult& result);
+extern "C" SPINE_BENCH_API bool runSpineBench41(const SpineBenchCase& benchCase, SpineBenchResult& result);
+extern "C" SPINE_BENCH_API bool runSpineBench42(const SpineBenchCase& benchCase, SpineBenchResult& result);
+
+/// Skins the weighted attachments of every frame of a case with the scalar loop and each SIMD
+/// kernel the CPU supports, the scalar loop being the first result. Returns false and sets error if
+/// the case does not load.
+extern "C" SPINE_BENCH_API bool checkSpineSkinning37(const SpineBenchCase& benchCase, std::vector<SpineSkinningResult>& results, std::string& error);
+extern "C" SPINE_BENCH_API bool checkSpineSkinning38(const SpineBenchCase& benchCase, std::vector<SpineSkinningResult>& results, std::string& error);
+extern "C" SPINE_BENCH_API bool checkSpineSkinning40(const SpineBenchCase& benchCase, std::vector<SpineSkinningResult>& results, std::string& error);
+extern "C" SPINE_BENCH_API bool checkSpineSkinning41(const SpineBenchCase& benchCase, std::vector<SpineSkinningResult>& results, std::string& error);
+extern "C" SPINE_BENCH_API bool checkSpineSkinning42(const SpineBenchCase& benchCase, std::vector<SpineSkinningResult>& results, std::string& error);
+
+/// Creates the runtime the overlay loads for a version, see ISpineRuntime. Built into the library
+/// of the version without OpenGL, so it only draws with RB_Software.
+extern "C" SPINE_BENCH_API ISpineRuntime* createSpineRuntime37();
+extern "C" SPINE_BENCH_API ISpineRuntime* createSpineRuntime38();
+extern "C" SPINE_BENCH_API ISpineRuntime* createSpineRuntime40();
+extern "C" SPINE_BENCH_API ISpineRuntime* createSpineRuntime41();
+extern "C" SPINE_BENCH_API ISpineRuntime* createSpineRuntime42();
+
+/// Times the attachment type checks of SkeletonRenderer::render over the frames of a case with
+/// both RTTI comparisons. Returns false and sets error if the case does not load.
+extern "C" SPINE_BENCH_API bool checkSpineRtti37(const SpineBenchCase& benchCase, SpineRttiResult& result, std::string& error);
+extern "C" SPINE_BENCH_API bool checkSpineRtti38(const SpineBenchCase& benchCase, SpineRttiResult& result, std::string& error);
+extern "C" SPINE_BENCH_API bool checkSpineRtti40(const SpineBenchCase& benchCase, SpineRttiResult& result, std::string& error);
+extern "C" SPINE_BENCH_API bool checkSpineRtti41(const SpineBenchCase& benchCase, SpineRttiResult& result, std::string& error);
+extern "C" SPINE_BENCH_API bool checkSpineRtti42(const SpineBenchCase& benchCase, SpineRttiResult& result, std::string& error);
+
+/// Times decoding the atlas pages of a case one after another and with an image_batch_t, and
+/// compares the images. Returns false and sets error if a page does not load.
+extern "C" SPINE_BENCH_API bool checkSpineDecode37(const SpineBenchCase& benchCase, SpineDecodeResult& result, std::string& error);
+extern "C" SPINE_BENCH_API bool checkSpineDecode38(const SpineBenchCase& benchCase, SpineDecodeResult& result, std::string& error);
+extern "C" SPINE_BENCH_API bool checkSpineDecode40(const SpineBenchCase& benchCase, SpineDecodeResult& result, std::string& error);
+extern "C" SPINE_BENCH_API bool checkSpineDecode41(const SpineBenchCase& benchCase, SpineDecodeResult& result, std::string& error);
+extern "C" SPINE_BENCH_API bool checkSpineDecode42(const SpineBenchCase& benchCase, SpineDecodeResult& result, std::string& error);
+
+/// Creates an instance of a case looping its animation with the given index, modulo the number of
+/// animations. Returns nullptr and sets error if the case does not load.
+extern "C" SPINE_BENCH_API ISpineBenchInstance* createSpineBenchInstance37(const SpineBenchCase& benchCase, int animation, std::string& error);
+extern "C" SPINE_BENCH_API ISpineBenchInstance* createSpineBenchInstance38(const SpineBenchCase& benchCase, int animation, std::string& error);
+extern "C" SPINE_BENCH_API ISpineBenchInstance* createSpineBenchInstance40(const SpineBenchCase& benchCase, int animation, std::string& error);
+extern "C" SPINE_BENCH_API ISpineBenchInstance* createSpineBenchInstance41(const SpineBenchCase& benchCase, int animation, std::string& error);
+extern "C" SPINE_BENCH_API ISpineBenchInstance* createSpineBenchInstance42(const SpineBenchCase& benchCase, int animation, std::string& error);
@@ -0,0 +1,501 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <new>
+#include <nlohmann/json.hpp>
+#include "PhaseStats.h"
+#include "SpineBench.h"
+#include "WmaskEXAssetIndex.h"
+#include "WmaskEXUpdatePool.h"
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+static std::string toUtf8(const fs::path& path) {
+    std::u8string s = path.u8string();
+    return std::string(s.begin(), s.end());
+}
+
+typedef bool (*SpineBenchFunction)(const SpineBenchCase&, SpineBenchResult&);
+
+/// Runtime for a skeleton version, the same mapping the overlay uses
+static SpineBenchFunction getSpineBenchFunction(const std::string& version, std::string& runtime) {
+    if (version.starts_with("3.7")) { runtime = "37"; return runSpineBench37; }
+    if (version.starts_with("3.8")) { runtime = "38"; return runSpineBench38; }
+    if (version.starts_with("4.0")) { runtime = "40"; return runSpineBench40; }
+    if (version.starts_with("4.1")) { runtime = "41"; return runSpineBench41; }
+    if (version.starts_with("4.2")) { runtime = "42"; return runSpineBench42; }
+    return nullptr;
+}
+
+typedef ISpineBenchInstance* (*SpineBenchInstanceFactory)(const SpineBenchCase&, int, std::string&);
+
+static SpineBenchInstanceFactory getSpineBenchInstanceFactory(const std::string& runtime) {
+    if (runtime == "37") return createSpineBenchInstance37;
+    if (runtime == "38") return createSpineBenchInstance38;
+    if (runtime == "40") return createSpineBenchInstance40;
+    if (runtime == "41") return createSpineBenchInstance41;
+    if (runtime == "42") return createSpineBenchInstance42;
+    return nullptr;
+}
+
+typedef bool (*SpineSkinningCheck)(const SpineBenchCase&, std::vector<SpineSkinningResult>&, std::string&);
+
+static SpineSkinningCheck getSpineSkinningCheck(const std::string& runtime) {
+    if (runtime == "37") return checkSpineSkinning37;
+    if (runtime == "38") return checkSpineSkinning38;
+    if (runtime == "40") return checkSpineSkinning40;
+    if (runtime == "41") return checkSpineSkinning41;
+    if (runtime == "42") return checkSpineSkinning42;
+    return nullptr;
+}
+
+/// Largest relative difference a SIMD kernel may have to the scalar loop. On x86 the kernels do
+/// the same float operations and match bit for bit, compilers fusing the scalar loop's multiplies
+/// and adds, as GCC does on ARM, make it round slightly differently.
+static const float skinningTolerance = 1e-5f;
+
+/// Compares the weighted skinning of every SIMD kernel with the scalar loop
+static json runSkinningCheck(SpineSkinningCheck check, const SpineBenchCase& benchCase, bool& failed) {
+    std::vector<SpineSkinningResult> results;
+    std::string error;
+    if (!check(benchCase, results, error)) {
+        failed = true;
+        return { {"error", error} };
+    }
+    json kernels = json::object();
+    for (const auto& result : results) {
+        if (result.maxError > skinningTolerance) failed = true;
+        kernels[result.kernel] = {
+            {"vertices", result.vertices},
+            {"mismatches", result.mismatches},
+            {"maxError", result.maxError},
+            {"p50Ms", result.time.p50},
+            {"p99Ms", result.time.p99}
+        };
+    }
+    return kernels;
+}
+
+/// operator new calls of any thread while countNew is set. On Linux this replacement also serves
+/// the runtime libraries, on Windows every DLL keeps the one of its C runtime and only the pooled
+/// allocator sees their allocations.
+static std::atomic<bool> countNew = false;
+static std::atomic<uint64_t> newCalls = 0;
+
+void* operator new(size_t size) {
+    if (countNew.load(std::memory_order_relaxed)) newCalls.fetch_add(1, std::memory_order_relaxed);
+    if (void* mem = malloc(size ? size : 1)) return mem;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* mem) noexcept {
+    free(mem);
+}
+
+void operator delete(void* mem, size_t) noexcept {
+    free(mem);
+}
+
+typedef ISpineRuntime* (*SpineRuntimeFactory)();
+
+static SpineRuntimeFactory getSpineRuntimeFactory(const std::string& runtime) {
+    if (runtime == "37") return createSpineRuntime37;
+    if (runtime == "38") return createSpineRuntime38;
+    if (runtime == "40") return createSpineRuntime40;
+    if (runtime == "41") return createSpineRuntime41;
+    if (runtime == "42") return createSpineRuntime42;
+    return nullptr;
+}
+
+/// Side of the square viewport the allocation check draws into
+static const int allocationViewport = 256;
+
+/// Heap allocations of the frames of a case once each animation is warmed up, which should be none
+struct SpineAllocationResult {
+    int frames = 0; // checked, after the warm-up of each animation
+    uint64_t allocations = 0; // allocations and reallocations of the runtime library in them
+    uint64_t newCalls = 0; // operator new calls in them
+    std::vector<AllocationSite> sites; // that allocated in them, busiest first
+};
+
+/// One frame of an overlay showing the animation
+static void drawOverlayFrame(ISpineRuntime& runtime, const std::string& animation, float deltaTime) {
+    runtime.update(deltaTime);
+    if (runtime.hasChanged()) {
+        runtime.prepare(false);
+        runtime.draw(false);
+    }
+    runtime.getDirtyRect();
+    runtime.getAnimationBounds(animation);
+}
+
+/// Loops every animation of the case through the frames of an overlay on the software backend, its
+/// first loop and warmupFrames more as warm-up, and counts the allocations of the frames after
+static bool checkSpineAllocations(SpineRuntimeFactory factory, const SpineBenchCase& benchCase, SpineAllocationResult& result, std::string& error) {
+    std::unique_ptr<ISpineRuntime> runtime(factory());
+    runtime->setRenderBackend(RenderBackend::RB_Software);
+    if (!runtime->init(benchCase.atlasPath, benchCase.skeletonPath)) {
+        error = "Failed to load";
+        return false;
+    }
+    std::vector<std::string> skins = runtime->getAllSkins();
+    if (!skins.empty()) runtime->setSkin(skins[0]);
+    runtime->createRenderer();
+    runtime->setViewportSize(allocationViewport, allocationViewport, 1.0f);
+    std::map<std::pair<std::string, int>, AllocationSite> sites;
+    for (const auto& [animation, duration] : runtime->getAllAnimations()) {
+        // Fit the animation into the viewport, the overlay sizes its window to the bounds
+        Bounds bounds = runtime->getAnimationBounds(animation);
+        float scale = bounds.width > 0 && bounds.height > 0 ? allocationViewport / std::max(bounds.width, bounds.height) : 1.0f;
+        runtime->setScale(scale);
+        runtime->setPosition(-bounds.x * scale, -bounds.y * scale);
+        // A loop visits every key, so buffers reach the size the animation needs
+        runtime->setAnimation(animation);
+        int loopFrames = (int) std::ceil(duration / benchCase.deltaTime);
+        for (int frame = 0; frame < loopFrames + benchCase.warmupFrames; frame++)
+            drawOverlayFrame(*runtime, animation, benchCase.deltaTime);
+        runtime->resetAllocationSites();
+        newCalls = 0;
+        countNew = true;
+        for (int frame = 0; frame < benchCase.framesPerAnimation; frame++)
+            drawOverlayFrame(*runtime, animation, benchCase.deltaTime);
+        countNew = false;
+        result.frames += benchCase.framesPerAnimation;
+        result.newCalls += newCalls;
+        for (const auto& site : runtime->getAllocationSites(benchCase.allocationSites)) {
+            AllocationSite& merged = sites.try_emplace(std::make_pair(site.file, site.line), AllocationSite{ site.file, site.line, 0, 0, 0, 0, 0 }).first->second;
+            merged.allocations += site.allocations;
+            merged.reallocations += site.reallocations;
+            merged.frees += site.frees;
+            merged.bytes += site.bytes;
+            result.allocations += site.allocations + site.reallocations;
+        }
+    }
+    for (const auto& entry : sites) result.sites.push_back(entry.second);
+    std::sort(result.sites.begin(), result.sites.end(), [](const AllocationSite& a, const AllocationSite& b) {
+        return a.allocations + a.reallocations > b.allocations + b.reallocations;
+    });
+    runtime->dispose();
+    return true;
+}
+
+/// Checks that the warmed up frames of the case allocate nothing
+static json runAllocationCheck(SpineRuntimeFactory factory, const SpineBenchCase& benchCase, bool& failed) {
+    SpineAllocationResult result;
+    std::string error;
+    if (!checkSpineAllocations(factory, benchCase, result, error)) {
+        failed = true;
+        return { {"error", error} };
+    }
+    if (result.allocations > 0 || result.newCalls > 0) failed = true;
+    json sites = json::array();
+    for (const auto& site : result.sites)
+        sites.push_back({ {"file", site.file}, {"line", site.line}, {"allocations", site.allocations}, {"reallocations", site.reallocations}, {"bytes", site.bytes} });
+    return {
+        {"frames", result.frames},
+        {"allocations", result.allocations},
+        {"newCalls", result.newCalls},
+        {"sites", sites}
+    };
+}
+
+typedef bool (*SpineRttiCheck)(const SpineBenchCase&, SpineRttiResult&, std::string&);
+
+static SpineRttiCheck getSpineRttiCheck(const std::string& runtime) {
+    if (runtime == "37") return checkSpineRtti37;
+    if (runtime == "38") return checkSpineRtti38;
+    if (runtime == "40") return checkSpineRtti40;
+    if (runtime == "41") return checkSpineRtti41;
+    if (runtime == "42") return checkSpineRtti42;
+    return nullptr;
+}
+
+/// Times the attachment type checks of the renderer with RTTI compared by address and by name
+static json runRttiCheck(SpineRttiCheck check, const SpineBenchCase& benchCase, bool& failed) {
+    SpineRttiResult result;
+    std::string error;
+    if (!check(benchCase, result, error)) {
+        failed = true;
+        return { {"error", error} };
+    }
+    if (result.mismatches > 0) failed = true;
+    return {
+        {"slots", result.slots},
+        {"mismatches", result.mismatches},
+        {"byName", { {"p50Ms", result.names.p50}, {"p99Ms", result.names.p99} }},
+        {"byAddress", { {"p50Ms", result.addresses.p50}, {"p99Ms", result.addresses.p99} }}
+    };
+}
+
+typedef bool (*SpineDecodeCheck)(const SpineBenchCase&, SpineDecodeResult&, std::string&);
+
+static SpineDecodeCheck getSpineDecodeCheck(const std::string& runtime) {
+    if (runtime == "37") return checkSpineDecode37;
+    if (runtime == "38") return checkSpineDecode38;
+    if (runtime == "40") return checkSpineDecode40;
+    if (runtime == "41") return checkSpineDecode41;
+    if (runtime == "42") return checkSpineDecode42;
+    return nullptr;
+}
+
+/// Times decoding the atlas pages one after another and on the decode pool
+static json runDecodeCheck(SpineDecodeCheck check, const SpineBenchCase& benchCase, bool& failed) {
+    SpineDecodeResult result;
+    std::string error;
+    if (!check(benchCase, result, error)) {
+        failed = true;
+        return { {"error", error} };
+    }
+    if (result.mismatches > 0) failed = true;
+    return {
+        {"pages", result.pages},
+        {"mismatches", result.mismatches},
+        {"sequential", { {"p50Ms", result.sequential.p50}, {"p99Ms", result.sequential.p99} }},
+        {"batch", { {"p50Ms", result.batch.p50}, {"p99Ms", result.batch.p99} }}
+    };
+}
+
+/// Ticks count instances of the case on the update pool like overlays, each looping another
+/// animation with its own frame times, and checks the render commands of every frame against the
+/// same instance ticked alone on this thread
+static json runStress(SpineBenchInstanceFactory create, const SpineBenchCase& benchCase, int count, WmaskEXUpdatePool& pool, bool& failed) {
+    std::vector<std::unique_ptr<ISpineBenchInstance>> pooled, serial;
+    std::string error;
+    for (int i = 0; i < count; i++) {
+        pooled.emplace_back(create(benchCase, i, error));
+        serial.emplace_back(create(benchCase, i, error));
+        if (!pooled.back() || !serial.back()) {
+            failed = true;
+            return { {"error", error} };
+        }
+    }
+    // Overlays tick at different rates, here every 1 to 3 frames
+    auto deltaTime = [&](int instance, int frame) { return benchCase.deltaTime * (1 + (instance + frame) % 3); };
+    PhaseHistogram serialTime, pooledTime;
+    std::vector<WmaskEXUpdatePool::Ticket> tickets(count);
+    int mismatches = 0;
+    for (int frame = 0; frame < benchCase.framesPerAnimation; frame++) {
+        {
+            ScopedPhaseTimer timer(&serialTime);
+            for (int i = 0; i < count; i++) serial[i]->tick(deltaTime(i, frame));
+        }
+        {
+            ScopedPhaseTimer timer(&pooledTime);
+            for (int i = 0; i < count; i++)
+                tickets[i] = pool.submit(L"", [&, i, frame] { pooled[i]->tick(deltaTime(i, frame)); });
+            // Waiting from the back lets this thread run the jobs no worker has started yet
+            for (int i = count - 1; i >= 0; i--) pool.wait(tickets[i]);
+        }
+        for (int i = 0; i < count; i++)
+            if (pooled[i]->getFrame() != serial[i]->getFrame()) mismatches++;
+    }
+    if (mismatches > 0) failed = true;
+    PhaseStats serialStats = serialTime.getStats("serial");
+    PhaseStats pooledStats = pooledTime.getStats("pooled");
+    return {
+        {"instances", count},
+        {"threads", pool.getThreads()},
+        {"frames", benchCase.framesPerAnimation},
+        {"mismatches", mismatches},
+        {"serialFrame", { {"p50Ms", serialStats.p50}, {"p99Ms", serialStats.p99} }},
+        {"pooledFrame", { {"p50Ms", pooledStats.p50}, {"p99Ms", pooledStats.p99} }}
+    };
+}
+
+/// Keeps stdout to itself for the JSON report and points everything else printed there, like the
+/// runtimes' texture load errors, at stderr. Returns the stream of the report, stdout if the two
+/// cannot be kept apart.
+static FILE* takeStdoutForReport() {
+    fflush(stdout);
+#if defined(_WIN32)
+    int reportFd = _dup(_fileno(stdout));
+    FILE* report = reportFd >= 0 ? _fdopen(reportFd, "w") : nullptr;
+    if (reportFd >= 0 && !report) _close(reportFd);
+    if (report) _dup2(_fileno(stderr), _fileno(stdout));
+#else
+    int reportFd = dup(STDOUT_FILENO);
+    FILE* report = reportFd >= 0 ? fdopen(reportFd, "w") : nullptr;
+    if (reportFd >= 0 && !report) close(reportFd);
+    if (report) dup2(STDERR_FILENO, STDOUT_FILENO);
+#endif
+    return report ? report : stdout;
+}
+
+static void printUsage() {
+    fprintf(stderr,
+        "usage: spine_bench <assets dir> [options]\n"
+        "  --frames N         frames per animation (default 120)\n"
+        "  --parse-repeats N  times each asset is parsed (default 5)\n"
+        "  --instances N      also tick N instances of each asset on the update pool and check\n"
+        "                     their frames against a serial run (default 0, off)\n"
+        "  --threads N        workers of the update pool (default 0, one less than the cores)\n"
+        "  --skinning         also compare the SIMD skinning kernels with the scalar loop\n"
+        "  --bone-block       keep the world transforms of the bones of each skeleton in one block\n"
+        "  --allocator NAME   allocator of the runtimes: system, pool or pool-stats, which also\n"
+        "                     reports the busiest allocation sites (default system)\n"
+        "  --allocations      also check that the overlay's frames on the software backend allocate\n"
+        "                     nothing once each animation looped and N more warm-up frames passed,\n"
+        "                     implies --allocator pool-stats\n"
+        "  --warmup N         warm-up frames of the allocation check (default 10)\n"
+        "  --rtti             also time the attachment type checks of the renderer with RTTI\n"
+        "                     compared by address and by class name\n"
+        "  --decode           also time decoding the atlas pages one after another and in parallel\n"
+        "  --output FILE      write the JSON report to FILE instead of stdout, where it is the only\n"
+        "                     output either way\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage();
+        return 2;
+    }
+    fs::path assetsPath = argv[1];
+    SpineBenchCase options;
+    std::string outputPath;
+    int instances = 0;
+    unsigned int threads = 0;
+    bool skinning = false;
+    std::string allocator = "system";
+    bool allocations = false;
+    bool rtti = false;
+    bool decode = false;
+    for (int i = 2; i < argc; i++) {
+        if (!strcmp(argv[i], "--frames") && i + 1 < argc) options.framesPerAnimation = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--parse-repeats") && i + 1 < argc) options.parseRepeats = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--output") && i + 1 < argc) outputPath = argv[++i];
+        else if (!strcmp(argv[i], "--instances") && i + 1 < argc) instances = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc) threads = (unsigned int) atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--skinning")) skinning = true;
+        else if (!strcmp(argv[i], "--bone-block")) options.boneTransformBlock = true;
+        else if (!strcmp(argv[i], "--allocator") && i + 1 < argc) allocator = argv[++i];
+        else if (!strcmp(argv[i], "--allocations")) allocations = true;
+        else if (!strcmp(argv[i], "--warmup") && i + 1 < argc) options.warmupFrames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--rtti")) rtti = true;
+        else if (!strcmp(argv[i], "--decode")) decode = true;
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (allocator != "system" && allocator != "pool" && allocator != "pool-stats") {
+        printUsage();
+        return 2;
+    }
+    if (allocations) allocator = "pool-stats";
+    // Read by each runtime library when it first allocates, so before any case runs
+#if defined(_WIN32)
+    _putenv_s("WMASKEX_SPINE_ALLOCATOR", allocator.c_str());
+#else
+    setenv("WMASKEX_SPINE_ALLOCATOR", allocator.c_str(), 1);
+#endif
+
+    FILE* reportStream = outputPath.empty() ? takeStdoutForReport() : nullptr;
+
+    // The index is only used in memory to find the assets and their versions
+    WmaskEXAssetIndex index(assetsPath, fs::path(), {});
+    index.refresh();
+
+    json report = {
+        {"assetsPath", toUtf8(assetsPath)},
+        {"framesPerAnimation", options.framesPerAnimation},
+        {"parseRepeats", options.parseRepeats},
+        {"boneTransformBlock", options.boneTransformBlock},
+        {"allocator", allocator},
+        {"assets", json::array()}
+    };
+    std::unique_ptr<WmaskEXUpdatePool> pool;
+    if (instances > 0) pool = std::make_unique<WmaskEXUpdatePool>(threads);
+    int failures = 0;
+    for (const auto& asset : index.getAssets()) {
+        if (!asset.isSpine) continue;
+        SpineBenchCase benchCase = options;
+        fs::path skeletonPath = fs::path(asset.path).replace_extension(".skel");
+        if (!fs::exists(skeletonPath)) skeletonPath.replace_extension(".json");
+        benchCase.atlasPath = toUtf8(asset.path);
+        benchCase.skeletonPath = toUtf8(skeletonPath);
+
+        json entry = {
+            {"atlas", benchCase.atlasPath},
+            {"skeleton", benchCase.skeletonPath},
+            {"version", asset.version}
+        };
+        std::string runtime;
+        SpineBenchFunction run = getSpineBenchFunction(asset.version, runtime);
+        SpineBenchResult result;
+        if (!run) result.error = "Unsupported spine version";
+        else run(benchCase, result);
+        if (!result.loaded) failures++;
+
+        entry["runtime"] = runtime;
+        entry["loaded"] = result.loaded;
+        if (!result.error.empty()) entry["error"] = result.error;
+        entry["animations"] = result.animations;
+        entry["frames"] = result.frames;
+        json phases = json::object();
+        for (const auto& phase : result.phases)
+            phases[phase.phase] = { {"samples", phase.samples}, {"p50Ms", phase.p50}, {"p99Ms", phase.p99} };
+        entry["phases"] = phases;
+        if (!result.allocationSites.empty()) {
+            json sites = json::array();
+            for (const auto& site : result.allocationSites)
+                sites.push_back({
+                    {"file", site.file}, {"line", site.line}, {"allocations", site.allocations},
+                    {"reallocations", site.reallocations}, {"frees", site.frees}, {"bytes", site.bytes},
+                    {"liveBytes", site.liveBytes}
+                });
+            entry["allocationSites"] = sites;
+        }
+        if (pool && result.loaded) {
+            bool failed = false;
+            entry["stress"] = runStress(getSpineBenchInstanceFactory(runtime), benchCase, instances, *pool, failed);
+            if (failed) failures++;
+        }
+        if (skinning && result.loaded) {
+            bool failed = false;
+            entry["skinning"] = runSkinningCheck(getSpineSkinningCheck(runtime), benchCase, failed);
+            if (failed) failures++;
+        }
+        if (allocations && result.loaded) {
+            bool failed = false;
+            entry["allocations"] = runAllocationCheck(getSpineRuntimeFactory(runtime), benchCase, failed);
+            if (failed) failures++;
+        }
+        if (rtti && result.loaded) {
+            bool failed = false;
+            entry["rtti"] = runRttiCheck(getSpineRttiCheck(runtime), benchCase, failed);
+            if (failed) failures++;
+        }
+        if (decode && result.loaded) {
+            bool failed = false;
+            entry["decode"] = runDecodeCheck(getSpineDecodeCheck(runtime), benchCase, failed);
+            if (failed) failures++;
+        }
+        report["assets"].push_back(entry);
+    }
+
+    if (reportStream) {
+        fprintf(reportStream, "%s\n", report.dump(2).c_str());
+        fflush(reportStream);
+    } else {
+        std::ofstream ofs(outputPath);
+        ofs << report.dump(2) << std::endl;
+        if (!ofs) {
+            fprintf(stderr, "Failed to write %s\n", outputPath.c_str());
+            return 1;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -77,7 +77,8 @@ public:
 	static bool isYDown();
 
 	/// @param parent May be NULL.
-	Bone(BoneData &data, Skeleton &skeleton, Bone *parent = NULL);
+	/// @param transform VertexSkinning::TransformStride floats the skeleton keeps the world transform in.
+	Bone(BoneData &data, Skeleton &skeleton, Bone *parent, float *transform);
 
 	/// Same as updateWorldTransform. This method exists for Bone to implement Spine::Updatable.
 	virtual void update();
@@ -226,6 +227,9 @@ public:
 private:
 	static bool yDown;
 
+	/// Offsets of the world transform in _transform
+	enum { A, B, C, D, WorldX, WorldY };
+
 	BoneData &_data;
 	Skeleton &_skeleton;
 	Bone *_parent;
@@ -233,8 +237,7 @@ private:
 	float _x, _y, _rotation, _scaleX, _scaleY, _shearX, _shearY;
 	float _ax, _ay, _arotation, _ascaleX, _ascaleY, _ashearX, _ashearY;
 	bool _appliedValid;
-	float _a, _b, _worldX;
-	float _c, _d, _worldY;
+	float *_transform; // a, b, c, d, worldX, worldY and padding, kept by the skeleton
 	bool _sorted;
 
 	/// Computes the individual applied transform values from the world transform. This can be useful to perform processing using
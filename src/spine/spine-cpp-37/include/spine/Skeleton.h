@@ -93,7 +93,8 @@ class SP_API Skeleton : public SpineObject {
 	friend class TwoColorTimeline;
 
 public:
-	explicit Skeleton(SkeletonData *skeletonData);
+	/// @param boneTransformBlock Keeps the world transforms of the bones in one block, see getBoneTransforms.
+	explicit Skeleton(SkeletonData *skeletonData, bool boneTransformBlock = false);
 
 	~Skeleton();
 
@@ -173,6 +174,11 @@ public:
 
 	Vector<Bone *> &getBones();
 
+	/// World transforms of the bones in the order of getBones, VertexSkinning::TransformStride floats
+	/// each: a, b, c, d, worldX, worldY and padding. The bones read and write them in place, so code
+	/// reading many bones walks one block. NULL unless the skeleton was created with boneTransformBlock.
+	float *getBoneTransforms();
+
 	Vector<Updatable *> &getUpdateCacheList();
 
 	Vector<Slot *> &getSlots();
@@ -213,6 +219,8 @@ public:
 
 private:
 	SkeletonData *_data;
+	char *_arena; // the bones with their world transforms, slots and constraints in one allocation, or NULL
+	float *_boneTransforms;
 	Vector<Bone *> _bones;
 	Vector<Slot *> _slots;
 	Vector<Slot *> _drawOrder;
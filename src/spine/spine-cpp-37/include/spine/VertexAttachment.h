@@ -34,8 +34,12 @@
 
 #include <spine/Vector.h>
 
+#include <atomic>
+
 namespace spine {
     class Slot;
+
+    class VertexSkinning;
     
     /// An attachment with vertices that are transformed by one or more bones and can be deformed by a slot's vertices.
     class SP_API VertexAttachment : public Attachment {
@@ -81,9 +85,14 @@ namespace spine {
         size_t _worldVerticesLength;
         
     private:
+        std::atomic<VertexSkinning *> _skinning;
+
         const int _id;
         
         static int getNextID();
+
+        /// The layout the weighted vertices are skinned with, built on first use. NULL if SIMD skinning is off.
+        VertexSkinning *getSkinning();
     };
 }
 
@@ -0,0 +1,103 @@
+/******************************************************************************
+ * Spine Runtimes License Agreement
+ * Last updated May 1, 2019. Replaces all prior versions.
+ *
+ * Copyright (c) 2013-2019, Esoteric Software LLC
+ *
+ * Integration of the Spine Runtimes into software or otherwise creating
+ * derivative works of the Spine Runtimes is permitted under the terms and
+ * conditions of Section 2 of the Spine Editor License Agreement:
+ * http://esotericsoftware.com/spine-editor-license
+ *
+ * Otherwise, it is permitted to integrate the Spine Runtimes into software
+ * or otherwise create derivative works of the Spine Runtimes (collectively,
+ * "Products"), provided that each user of the Products must obtain their own
+ * Spine Editor license and redistribution of the Products in any form must
+ * include this license and copyright notice.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ESOTERIC SOFTWARE LLC "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL ESOTERIC SOFTWARE LLC BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES, BUSINESS
+ * INTERRUPTION, OR LOSS OF USE, DATA, OR PROFITS) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#ifndef Spine_VertexSkinning_h
+#define Spine_VertexSkinning_h
+
+#include <spine/SpineObject.h>
+#include <spine/Vector.h>
+
+namespace spine {
+	/// Instruction sets VertexSkinning can compute with
+	enum SkinningKernel {
+		SkinningKernel_None,
+		SkinningKernel_SSE2,
+		SkinningKernel_AVX2,
+		SkinningKernel_NEON
+	};
+
+	/// The weighted vertices of a VertexAttachment, laid out for skinning several vertices at once.
+	/// Vertices with the same number of bones form a group. A group stores its influences one after
+	/// another, each as one array per field with a lane per vertex, so a kernel walks them without
+	/// chasing bone pointers. Bones are renumbered to the distinct bones the attachment uses.
+	class SP_API VertexSkinning : public SpineObject {
+	public:
+		/// Most distinct bones compute copies transforms for, attachments with more keep the scalar loop
+		/// unless their skeleton has a transform block
+		static const int MaxBones = 128;
+
+		/// Floats per bone in the transforms passed to compute: a, b, c, d, worldX, worldY and padding
+		static const int TransformStride = 8;
+
+		/// Builds the layout of the bones and vertices arrays of a weighted VertexAttachment
+		VertexSkinning(Vector<int> &bones, Vector<float> &vertices);
+
+		/// Skeleton index of each renumbered bone
+		Vector<int> &getBones();
+
+		/// Computes every world vertex like the weighted loop of VertexAttachment::computeWorldVertices,
+		/// with the same float operations in the same order, so the results are identical.
+		/// @param transforms TransformStride floats for each bone of getBones().
+		/// @param deform The slot's deform, NULL if it has none.
+		void compute(const float *transforms, const float *deform, float *worldVertices, size_t offset, size_t stride);
+
+		/// Like compute, reading the transforms of the bones straight from the block of a skeleton
+		/// created with boneTransformBlock, so nothing is copied and any bone count works.
+		/// @param boneTransforms Skeleton::getBoneTransforms.
+		void computeFromSkeleton(const float *boneTransforms, const float *deform, float *worldVertices, size_t offset,
+								 size_t stride);
+
+		/// The kernel compute uses, picked once from what the CPU supports. SkinningKernel_None makes
+		/// VertexAttachment keep its scalar loop.
+		static SkinningKernel getKernel();
+
+		/// Selects the kernel for benchmarks and tests. The CPU must support it, and no skeleton may be
+		/// computing meanwhile.
+		static void setKernel(SkinningKernel kernel);
+
+	private:
+		void skin(const float *transforms, Vector<int> &transformOffsets, const float *deform, float *worldVertices,
+				  size_t offset, size_t stride);
+
+		Vector<int> _bones;
+		Vector<int> _groupInfluences;
+		Vector<int> _groupVertices;
+		Vector<int> _groupLanes; // vertices rounded up to whole lane blocks
+		Vector<int> _groupStart; // of the group's first influence in the lane arrays
+		Vector<int> _targets; // vertex index of each lane, in the order of the groups
+		Vector<int> _transformOffsets; // renumbered bone * TransformStride of each lane
+		Vector<int> _boneOffsets; // skeleton bone * TransformStride of each lane
+		Vector<int> _deformOffsets; // index of the lane's x in the deform array
+		Vector<float> _x;
+		Vector<float> _y;
+		Vector<float> _weights;
+	};
+}
+
+#endif /* Spine_VertexSkinning_h */
@@ -47,10 +47,10 @@ void IkConstraint::apply(Bone &bone, float targetX, float targetY, bool compress
 	Bone *p = bone.getParent();
 	float id, x, y, tx, ty, rotationIK;
 	if (!bone._appliedValid) bone.updateAppliedTransform();
-	id = 1 / (p->_a * p->_d - p->_b * p->_c);
-	x = targetX - p->_worldX, y = targetY - p->_worldY;
-	tx = (x * p->_d - y * p->_b) * id - bone._ax;
-	ty = (y * p->_a - x * p->_c) * id - bone._ay;
+	id = 1 / (p->_transform[Bone::A] * p->_transform[Bone::D] - p->_transform[Bone::B] * p->_transform[Bone::C]);
+	x = targetX - p->_transform[Bone::WorldX], y = targetY - p->_transform[Bone::WorldY];
+	tx = (x * p->_transform[Bone::D] - y * p->_transform[Bone::B]) * id - bone._ax;
+	ty = (y * p->_transform[Bone::A] - x * p->_transform[Bone::C]) * id - bone._ay;
 	rotationIK = MathUtil::atan2(ty, tx) * MathUtil::Rad_Deg - bone._ashearX - bone._arotation;
 	if (bone._ascaleX < 0) rotationIK += 180;
 	if (rotationIK > 180) rotationIK -= 360;
@@ -110,23 +110,23 @@ void IkConstraint::apply(Bone &parent, Bone &child, float targetX, float targetY
 	u = (r < 0 ? -r : r) <= 0.0001f;
 	if (!u) {
 		cy = 0;
-		cwx = parent._a * cx + parent._worldX;
-		cwy = parent._c * cx + parent._worldY;
+		cwx = parent._transform[Bone::A] * cx + parent._transform[Bone::WorldX];
+		cwy = parent._transform[Bone::C] * cx + parent._transform[Bone::WorldY];
 	} else {
 		cy = child._ay;
-		cwx = parent._a * cx + parent._b * cy + parent._worldX;
-		cwy = parent._c * cx + parent._d * cy + parent._worldY;
+		cwx = parent._transform[Bone::A] * cx + parent._transform[Bone::B] * cy + parent._transform[Bone::WorldX];
+		cwy = parent._transform[Bone::C] * cx + parent._transform[Bone::D] * cy + parent._transform[Bone::WorldY];
 	}
-	id = 1 / (pp->_a * pp->_d - pp->_b * pp->_c);
-	x = targetX - pp->_worldX;
-	y = targetY - pp->_worldY;
-	tx = (x * pp->_d - y * pp->_b) * id - px;
-	ty = (y * pp->_a - x * pp->_c) * id - py;
+	id = 1 / (pp->_transform[Bone::A] * pp->_transform[Bone::D] - pp->_transform[Bone::B] * pp->_transform[Bone::C]);
+	x = targetX - pp->_transform[Bone::WorldX];
+	y = targetY - pp->_transform[Bone::WorldY];
+	tx = (x * pp->_transform[Bone::D] - y * pp->_transform[Bone::B]) * id - px;
+	ty = (y * pp->_transform[Bone::A] - x * pp->_transform[Bone::C]) * id - py;
 	dd = tx * tx + ty * ty;
-	x = cwx - pp->_worldX;
-	y = cwy - pp->_worldY;
-	dx = (x * pp->_d - y * pp->_b) * id - px;
-	dy = (y * pp->_a - x * pp->_c) * id - py;
+	x = cwx - pp->_transform[Bone::WorldX];
+	y = cwy - pp->_transform[Bone::WorldY];
+	dx = (x * pp->_transform[Bone::D] - y * pp->_transform[Bone::B]) * id - px;
+	dy = (y * pp->_transform[Bone::A] - x * pp->_transform[Bone::C]) * id - py;
 	l1 = MathUtil::sqrt(dx * dx + dy * dy);
 	l2 = child.getData().getLength() * csx;
 	if (u) {
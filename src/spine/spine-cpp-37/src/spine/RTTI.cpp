@@ -47,14 +47,14 @@ const std::string &RTTI::getClassName() const {
 }
 
 bool RTTI::isExactly(const RTTI &rtti) const {
-	return (this->_className == rtti._className);
+	return (this == &rtti);
 }
 
 bool RTTI::instanceOf(const RTTI &rtti) const {
 	const RTTI *pCompare = this;
 
 	while (pCompare) {
-		if (pCompare->_className == rtti._className) {
+		if (pCompare == &rtti) {
 			return true;
 		}
 
@@ -51,11 +51,39 @@
 #include <spine/MeshAttachment.h>
 #include <spine/PathAttachment.h>
 
+#include <spine/VertexSkinning.h>
 #include <spine/ContainerUtil.h>
 
 using namespace spine;
 
-Skeleton::Skeleton(SkeletonData *skeletonData) :
+/// Alignment of every object in the arena of a skeleton
+static const size_t ArenaAlignment = 16;
+
+/// Bytes count objects of size bytes take in the arena, each starting aligned
+static size_t getArenaSize(size_t size, size_t count) {
+	return (size + ArenaAlignment - 1) / ArenaAlignment * ArenaAlignment * count;
+}
+
+/// Takes size bytes from the arena, or allocates them on their own when the skeleton has no arena
+static void *takeFromArena(char *&arena, size_t size) {
+	if (!arena) return SpineExtension::calloc<char>(size, __FILE__, __LINE__);
+	void *object = arena;
+	arena += getArenaSize(size, 1);
+	return object;
+}
+
+/// Destroys the objects the arena holds, last first like ContainerUtil::cleanUpVectorOfPointers. With
+/// freeItems they were allocated on their own and are freed too.
+template<typename T>
+static void destroyInArena(Vector<T *> &items, bool freeItems) {
+	for (int i = (int) items.size() - 1; i >= 0; i--) {
+		items[i]->~T();
+		if (freeItems) SpineExtension::free(items[i], __FILE__, __LINE__);
+	}
+	items.clear();
+}
+
+Skeleton::Skeleton(SkeletonData *skeletonData, bool boneTransformBlock) :
 		_data(skeletonData),
 		_skin(NULL),
 		_color(1, 1, 1, 1),
@@ -64,16 +92,33 @@ Skeleton::Skeleton(SkeletonData *skeletonData) :
 		_scaleY(1),
 		_x(0),
 		_y(0) {
+	// One allocation holds every bone with its world transform, slot and constraint. With
+	// boneTransformBlock the world transforms come first in one block, else each follows its bone
+	size_t transformSize = VertexSkinning::TransformStride * sizeof(float);
+	size_t arenaSize = getArenaSize(transformSize, _data->getBones().size()) +
+					   getArenaSize(sizeof(Bone), _data->getBones().size()) +
+					   getArenaSize(sizeof(Slot), _data->getSlots().size()) +
+					   getArenaSize(sizeof(IkConstraint), _data->getIkConstraints().size()) +
+					   getArenaSize(sizeof(TransformConstraint), _data->getTransformConstraints().size()) +
+					   getArenaSize(sizeof(PathConstraint), _data->getPathConstraints().size());
+	// Without the arena, empty or failing to allocate, every object is allocated on its own
+	_arena = arenaSize > 0 ? SpineExtension::calloc<char>(arenaSize, __FILE__, __LINE__) : NULL;
+	char *arena = _arena;
+	_boneTransforms = boneTransformBlock ? (float *) takeFromArena(arena, transformSize * _data->getBones().size()) : NULL;
+
 	_bones.ensureCapacity(_data->getBones().size());
 	for (size_t i = 0; i < _data->getBones().size(); ++i) {
 		BoneData *data = _data->getBones()[i];
 
+		void *memory = takeFromArena(arena, sizeof(Bone));
+		float *transform = _boneTransforms ? _boneTransforms + i * VertexSkinning::TransformStride : (float *) takeFromArena(arena, transformSize);
+
 		Bone *bone;
 		if (data->getParent() == NULL) {
-			bone = new(__FILE__, __LINE__) Bone(*data, *this, NULL);
+			bone = new (memory) Bone(*data, *this, NULL, transform);
 		} else {
 			Bone *parent = _bones[data->getParent()->getIndex()];
-			bone = new(__FILE__, __LINE__) Bone(*data, *this, parent);
+			bone = new (memory) Bone(*data, *this, parent, transform);
 			parent->getChildren().add(bone);
 		}
 
@@ -86,7 +131,7 @@ Skeleton::Skeleton(SkeletonData *skeletonData) :
 		SlotData *data = _data->getSlots()[i];
 
 		Bone *bone = _bones[data->getBoneData().getIndex()];
-		Slot *slot = new(__FILE__, __LINE__) Slot(*data, *bone);
+		Slot *slot = new (takeFromArena(arena, sizeof(Slot))) Slot(*data, *bone);
 
 		_slots.add(slot);
 		_drawOrder.add(slot);
@@ -96,7 +141,7 @@ Skeleton::Skeleton(SkeletonData *skeletonData) :
 	for (size_t i = 0; i < _data->getIkConstraints().size(); ++i) {
 		IkConstraintData *data = _data->getIkConstraints()[i];
 
-		IkConstraint *constraint = new(__FILE__, __LINE__) IkConstraint(*data, *this);
+		IkConstraint *constraint = new (takeFromArena(arena, sizeof(IkConstraint))) IkConstraint(*data, *this);
 
 		_ikConstraints.add(constraint);
 	}
@@ -105,7 +150,7 @@ Skeleton::Skeleton(SkeletonData *skeletonData) :
 	for (size_t i = 0; i < _data->getTransformConstraints().size(); ++i) {
 		TransformConstraintData *data = _data->getTransformConstraints()[i];
 
-		TransformConstraint *constraint = new(__FILE__, __LINE__) TransformConstraint(*data, *this);
+		TransformConstraint *constraint = new (takeFromArena(arena, sizeof(TransformConstraint))) TransformConstraint(*data, *this);
 
 		_transformConstraints.add(constraint);
 	}
@@ -114,7 +159,7 @@ Skeleton::Skeleton(SkeletonData *skeletonData) :
 	for (size_t i = 0; i < _data->getPathConstraints().size(); ++i) {
 		PathConstraintData *data = _data->getPathConstraints()[i];
 
-		PathConstraint *constraint = new(__FILE__, __LINE__) PathConstraint(*data, *this);
+		PathConstraint *constraint = new (takeFromArena(arena, sizeof(PathConstraint))) PathConstraint(*data, *this);
 
 		_pathConstraints.add(constraint);
 	}
@@ -123,11 +168,20 @@ Skeleton::Skeleton(SkeletonData *skeletonData) :
 }
 
 Skeleton::~Skeleton() {
-	ContainerUtil::cleanUpVectorOfPointers(_bones);
-	ContainerUtil::cleanUpVectorOfPointers(_slots);
-	ContainerUtil::cleanUpVectorOfPointers(_ikConstraints);
-	ContainerUtil::cleanUpVectorOfPointers(_transformConstraints);
-	ContainerUtil::cleanUpVectorOfPointers(_pathConstraints);
+	if (!_arena) {
+		// Every object and world transform was allocated on its own
+		if (_boneTransforms) {
+			SpineExtension::free(_boneTransforms, __FILE__, __LINE__);
+		} else {
+			for (size_t i = 0; i < _bones.size(); ++i) SpineExtension::free(_bones[i]->_transform, __FILE__, __LINE__);
+		}
+	}
+	destroyInArena(_bones, !_arena);
+	destroyInArena(_slots, !_arena);
+	destroyInArena(_ikConstraints, !_arena);
+	destroyInArena(_transformConstraints, !_arena);
+	destroyInArena(_pathConstraints, !_arena);
+	if (_arena) SpineExtension::free(_arena, __FILE__, __LINE__);
 }
 
 void Skeleton::updateCache() {
@@ -454,6 +508,10 @@ SkeletonData *Skeleton::getData() {
 	return _data;
 }
 
+float *Skeleton::getBoneTransforms() {
+	return _boneTransforms;
+}
+
 Vector<Bone *> &Skeleton::getBones() {
 	return _bones;
 }
@@ -107,6 +107,7 @@
 #include <spine/Updatable.h>
 #include <spine/Vector.h>
 #include <spine/VertexAttachment.h>
+#include <spine/VertexSkinning.h>
 #include <spine/VertexEffect.h>
 #include <spine/Vertices.h>
 
@@ -50,7 +50,7 @@ bool Bone::isYDown() {
 	return yDown;
 }
 
-Bone::Bone(BoneData &data, Skeleton &skeleton, Bone *parent) : Updatable(),
+Bone::Bone(BoneData &data, Skeleton &skeleton, Bone *parent, float *transform) : Updatable(),
 	_data(data),
 	_skeleton(skeleton),
 	_parent(parent),
@@ -69,15 +69,16 @@ Bone::Bone(BoneData &data, Skeleton &skeleton, Bone *parent) : Updatable(),
 	_ashearX(0),
 	_ashearY(0),
 	_appliedValid(false),
-	_a(1),
-	_b(0),
-	_worldX(0),
-	_c(0),
-	_d(1),
-	_worldY(0),
+	_transform(transform),
 	_sorted(false),
 	_active(false)
 {
+	_transform[A] = 1;
+	_transform[B] = 0;
+	_transform[WorldX] = 0;
+	_transform[C] = 0;
+	_transform[D] = 1;
+	_transform[WorldY] = 0;
 	setToSetupPose();
 }
 
@@ -107,22 +108,22 @@ void Bone::updateWorldTransform(float x, float y, float rotation, float scaleX,
 		float rotationY = rotation + 90 + shearY;
 		float sx = _skeleton.getScaleX();
 		float sy = _skeleton.getScaleY();
-		_a = MathUtil::cosDeg(rotation + shearX) * scaleX * sx;
-		_b = MathUtil::cosDeg(rotationY) * scaleY * sx;
-		_c = MathUtil::sinDeg(rotation + shearX) * scaleX * sy;
-		_d = MathUtil::sinDeg(rotationY) * scaleY * sy;
-		_worldX = x * sx + _skeleton.getX();
-		_worldY = y * sy + _skeleton.getY();
+		_transform[A] = MathUtil::cosDeg(rotation + shearX) * scaleX * sx;
+		_transform[B] = MathUtil::cosDeg(rotationY) * scaleY * sx;
+		_transform[C] = MathUtil::sinDeg(rotation + shearX) * scaleX * sy;
+		_transform[D] = MathUtil::sinDeg(rotationY) * scaleY * sy;
+		_transform[WorldX] = x * sx + _skeleton.getX();
+		_transform[WorldY] = y * sy + _skeleton.getY();
 		return;
 	}
 
-	pa = parent->_a;
-	pb = parent->_b;
-	pc = parent->_c;
-	pd = parent->_d;
+	pa = parent->_transform[A];
+	pb = parent->_transform[B];
+	pc = parent->_transform[C];
+	pd = parent->_transform[D];
 
-	_worldX = pa * x + pb * y + parent->_worldX;
-	_worldY = pc * x + pd * y + parent->_worldY;
+	_transform[WorldX] = pa * x + pb * y + parent->_transform[WorldX];
+	_transform[WorldY] = pc * x + pd * y + parent->_transform[WorldY];
 
 	switch (_data.getTransformMode()) {
 	case TransformMode_Normal: {
@@ -131,18 +132,18 @@ void Bone::updateWorldTransform(float x, float y, float rotation, float scaleX,
 		float lb = MathUtil::cosDeg(rotationY) * scaleY;
 		float lc = MathUtil::sinDeg(rotation + shearX) * scaleX;
 		float ld = MathUtil::sinDeg(rotationY) * scaleY;
-		_a = pa * la + pb * lc;
-		_b = pa * lb + pb * ld;
-		_c = pc * la + pd * lc;
-		_d = pc * lb + pd * ld;
+		_transform[A] = pa * la + pb * lc;
+		_transform[B] = pa * lb + pb * ld;
+		_transform[C] = pc * la + pd * lc;
+		_transform[D] = pc * lb + pd * ld;
 		return;
 	}
 	case TransformMode_OnlyTranslation: {
 		float rotationY = rotation + 90 + shearY;
-		_a = MathUtil::cosDeg(rotation + shearX) * scaleX;
-		_b = MathUtil::cosDeg(rotationY) * scaleY;
-		_c = MathUtil::sinDeg(rotation + shearX) * scaleX;
-		_d = MathUtil::sinDeg(rotationY) * scaleY;
+		_transform[A] = MathUtil::cosDeg(rotation + shearX) * scaleX;
+		_transform[B] = MathUtil::cosDeg(rotationY) * scaleY;
+		_transform[C] = MathUtil::sinDeg(rotation + shearX) * scaleX;
+		_transform[D] = MathUtil::sinDeg(rotationY) * scaleY;
 		break;
 	}
 	case TransformMode_NoRotationOrReflection: {
@@ -166,10 +167,10 @@ void Bone::updateWorldTransform(float x, float y, float rotation, float scaleX,
 		lb = MathUtil::cosDeg(ry) * scaleY;
 		lc = MathUtil::sinDeg(rx) * scaleX;
 		ld = MathUtil::sinDeg(ry) * scaleY;
-		_a = pa * la - pb * lc;
-		_b = pa * lb - pb * ld;
-		_c = pc * la + pd * lc;
-		_d = pc * lb + pd * ld;
+		_transform[A] = pa * la - pb * lc;
+		_transform[B] = pa * lb - pb * ld;
+		_transform[C] = pc * la + pd * lc;
+		_transform[D] = pc * lb + pd * ld;
 		break;
 	}
 	case TransformMode_NoScale:
@@ -195,17 +196,17 @@ void Bone::updateWorldTransform(float x, float y, float rotation, float scaleX,
 		lb = MathUtil::cosDeg(90 + shearY) * scaleY;
 		lc = MathUtil::sinDeg(shearX) * scaleX;
 		ld = MathUtil::sinDeg(90 + shearY) * scaleY;
-		_a = za * la + zb * lc;
-		_b = za * lb + zb * ld;
-		_c = zc * la + zd * lc;
-		_d = zc * lb + zd * ld;
+		_transform[A] = za * la + zb * lc;
+		_transform[B] = za * lb + zb * ld;
+		_transform[C] = zc * la + zd * lc;
+		_transform[D] = zc * lb + zd * ld;
 		break;
 	}
 	}
-	_a *= _skeleton.getScaleX();
-	_b *= _skeleton.getScaleX();
-	_c *= _skeleton.getScaleY();
-	_d *= _skeleton.getScaleY();
+	_transform[A] *= _skeleton.getScaleX();
+	_transform[B] *= _skeleton.getScaleX();
+	_transform[C] *= _skeleton.getScaleY();
+	_transform[D] *= _skeleton.getScaleY();
 }
 
 void Bone::setToSetupPose() {
@@ -220,29 +221,29 @@ void Bone::setToSetupPose() {
 }
 
 void Bone::worldToLocal(float worldX, float worldY, float &outLocalX, float &outLocalY) {
-	float a = _a;
-	float b = _b;
-	float c = _c;
-	float d = _d;
+	float a = _transform[A];
+	float b = _transform[B];
+	float c = _transform[C];
+	float d = _transform[D];
 
 	float invDet = 1 / (a * d - b * c);
-	float x = worldX - _worldX;
-	float y = worldY - _worldY;
+	float x = worldX - _transform[WorldX];
+	float y = worldY - _transform[WorldY];
 
 	outLocalX = (x * d * invDet - y * b * invDet);
 	outLocalY = (y * a * invDet - x * c * invDet);
 }
 
 void Bone::localToWorld(float localX, float localY, float &outWorldX, float &outWorldY) {
-	outWorldX = localX * _a + localY * _b + _worldX;
-	outWorldY = localX * _c + localY * _d + _worldY;
+	outWorldX = localX * _transform[A] + localY * _transform[B] + _transform[WorldX];
+	outWorldY = localX * _transform[C] + localY * _transform[D] + _transform[WorldY];
 }
 
 float Bone::worldToLocalRotation(float worldRotation) {
 	float sin = MathUtil::sinDeg(worldRotation);
 	float cos = MathUtil::cosDeg(worldRotation);
 
-	return MathUtil::atan2(_a * sin - _c * cos, _d * cos - _b * sin) * MathUtil::Rad_Deg + this->_rotation - this->_shearX;
+	return MathUtil::atan2(_transform[A] * sin - _transform[C] * cos, _transform[D] * cos - _transform[B] * sin) * MathUtil::Rad_Deg + this->_rotation - this->_shearX;
 }
 
 float Bone::localToWorldRotation(float localRotation) {
@@ -250,22 +251,22 @@ float Bone::localToWorldRotation(float localRotation) {
 	float sin = MathUtil::sinDeg(localRotation);
 	float cos = MathUtil::cosDeg(localRotation);
 
-	return MathUtil::atan2(cos * _c + sin * _d, cos * _a + sin * _b) * MathUtil::Rad_Deg;
+	return MathUtil::atan2(cos * _transform[C] + sin * _transform[D], cos * _transform[A] + sin * _transform[B]) * MathUtil::Rad_Deg;
 }
 
 void Bone::rotateWorld(float degrees) {
-	float a = _a;
-	float b = _b;
-	float c = _c;
-	float d = _d;
+	float a = _transform[A];
+	float b = _transform[B];
+	float c = _transform[C];
+	float d = _transform[D];
 
 	float cos = MathUtil::cosDeg(degrees);
 	float sin = MathUtil::sinDeg(degrees);
 
-	_a = cos * a - sin * c;
-	_b = cos * b - sin * d;
-	_c = sin * a + cos * c;
-	_d = sin * b + cos * d;
+	_transform[A] = cos * a - sin * c;
+	_transform[B] = cos * b - sin * d;
+	_transform[C] = sin * a + cos * c;
+	_transform[D] = sin * b + cos * d;
 
 	_appliedValid = false;
 }
@@ -276,12 +277,12 @@ float Bone::getWorldToLocalRotationX() {
 		return _arotation;
 	}
 
-	float pa = parent->_a;
-	float pb = parent->_b;
-	float pc = parent->_c;
-	float pd = parent->_d;
-	float a = _a;
-	float c = _c;
+	float pa = parent->_transform[A];
+	float pb = parent->_transform[B];
+	float pc = parent->_transform[C];
+	float pd = parent->_transform[D];
+	float a = _transform[A];
+	float c = _transform[C];
 
 	return MathUtil::atan2(pa * c - pc * a, pd * a - pb * c) * MathUtil::Rad_Deg;
 }
@@ -292,12 +293,12 @@ float Bone::getWorldToLocalRotationY() {
 		return _arotation;
 	}
 
-	float pa = parent->_a;
-	float pb = parent->_b;
-	float pc = parent->_c;
-	float pd = parent->_d;
-	float b = _b;
-	float d = _d;
+	float pa = parent->_transform[A];
+	float pb = parent->_transform[B];
+	float pc = parent->_transform[C];
+	float pd = parent->_transform[D];
+	float b = _transform[B];
+	float d = _transform[D];
 
 	return MathUtil::atan2(pa * d - pc * b, pd * b - pb * d) * MathUtil::Rad_Deg;
 }
@@ -431,67 +432,67 @@ void Bone::setAShearY(float inValue) {
 }
 
 float Bone::getA() {
-	return _a;
+	return _transform[A];
 }
 
 void Bone::setA(float inValue) {
-	_a = inValue;
+	_transform[A] = inValue;
 }
 
 float Bone::getB() {
-	return _b;
+	return _transform[B];
 }
 
 void Bone::setB(float inValue) {
-	_b = inValue;
+	_transform[B] = inValue;
 }
 
 float Bone::getC() {
-	return _c;
+	return _transform[C];
 }
 
 void Bone::setC(float inValue) {
-	_c = inValue;
+	_transform[C] = inValue;
 }
 
 float Bone::getD() {
-	return _d;
+	return _transform[D];
 }
 
 void Bone::setD(float inValue) {
-	_d = inValue;
+	_transform[D] = inValue;
 }
 
 float Bone::getWorldX() {
-	return _worldX;
+	return _transform[WorldX];
 }
 
 void Bone::setWorldX(float inValue) {
-	_worldX = inValue;
+	_transform[WorldX] = inValue;
 }
 
 float Bone::getWorldY() {
-	return _worldY;
+	return _transform[WorldY];
 }
 
 void Bone::setWorldY(float inValue) {
-	_worldY = inValue;
+	_transform[WorldY] = inValue;
 }
 
 float Bone::getWorldRotationX() {
-	return MathUtil::atan2(_c, _a) * MathUtil::Rad_Deg;
+	return MathUtil::atan2(_transform[C], _transform[A]) * MathUtil::Rad_Deg;
 }
 
 float Bone::getWorldRotationY() {
-	return MathUtil::atan2(_d, _b) * MathUtil::Rad_Deg;
+	return MathUtil::atan2(_transform[D], _transform[B]) * MathUtil::Rad_Deg;
 }
 
 float Bone::getWorldScaleX() {
-	return MathUtil::sqrt(_a * _a + _c * _c);
+	return MathUtil::sqrt(_transform[A] * _transform[A] + _transform[C] * _transform[C]);
 }
 
 float Bone::getWorldScaleY() {
-	return MathUtil::sqrt(_b * _b + _d * _d);
+	return MathUtil::sqrt(_transform[B] * _transform[B] + _transform[D] * _transform[D]);
 }
 
 bool Bone::isAppliedValid() {
@@ -505,25 +506,25 @@ void Bone::updateAppliedTransform() {
 	Bone *parent = _parent;
 	_appliedValid = 1;
 	if (!parent) {
-		_ax = _worldX;
-		_ay = _worldY;
-		_arotation = MathUtil::atan2(_c, _a) * MathUtil::Rad_Deg;
-		_ascaleX = MathUtil::sqrt(_a * _a + _c * _c);
-		_ascaleY = MathUtil::sqrt(_b * _b + _d * _d);
+		_ax = _transform[WorldX];
+		_ay = _transform[WorldY];
+		_arotation = MathUtil::atan2(_transform[C], _transform[A]) * MathUtil::Rad_Deg;
+		_ascaleX = MathUtil::sqrt(_transform[A] * _transform[A] + _transform[C] * _transform[C]);
+		_ascaleY = MathUtil::sqrt(_transform[B] * _transform[B] + _transform[D] * _transform[D]);
 		_ashearX = 0;
-		_ashearY = MathUtil::atan2(_a * _b + _c * _d, _a * _d - _b * _c) * MathUtil::Rad_Deg;
+		_ashearY = MathUtil::atan2(_transform[A] * _transform[B] + _transform[C] * _transform[D], _transform[A] * _transform[D] - _transform[B] * _transform[C]) * MathUtil::Rad_Deg;
 	} else {
-		float pa = parent->_a, pb = parent->_b, pc = parent->_c, pd = parent->_d;
+		float pa = parent->_transform[A], pb = parent->_transform[B], pc = parent->_transform[C], pd = parent->_transform[D];
 		float pid = 1 / (pa * pd - pb * pc);
-		float dx = _worldX - parent->_worldX, dy = _worldY - parent->_worldY;
+		float dx = _transform[WorldX] - parent->_transform[WorldX], dy = _transform[WorldY] - parent->_transform[WorldY];
 		float ia = pid * pd;
 		float id = pid * pa;
 		float ib = pid * pb;
 		float ic = pid * pc;
-		float ra = ia * _a - ib * _c;
-		float rb = ia * _b - ib * _d;
-		float rc = id * _c - ic * _a;
-		float rd = id * _d - ic * _b;
+		float ra = ia * _transform[A] - ib * _transform[C];
+		float rb = ia * _transform[B] - ib * _transform[D];
+		float rc = id * _transform[C] - ic * _transform[A];
+		float rd = id * _transform[D] - ic * _transform[B];
 		_ax = (dx * pd * pid - dy * pb * pid);
 		_ay = (dy * pa * pid - dx * pc * pid);
 		_ashearX = 0;
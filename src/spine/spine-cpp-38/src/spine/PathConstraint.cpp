@@ -111,14 +111,14 @@ void PathConstraint::update() {
 				_spaces[++i] = 0;
 			} else if (percentSpacing) {
 				if (scale) {
-					float x = setupLength * bone._a, y = setupLength * bone._c;
+					float x = setupLength * bone._transform[Bone::A], y = setupLength * bone._transform[Bone::C];
 					float length = MathUtil::sqrt(x * x + y * y);
 					_lengths[i] = length;
 				}
 				_spaces[++i] = spacing;
 			} else {
-				float x = setupLength * bone._a;
-				float y = setupLength * bone._c;
+				float x = setupLength * bone._transform[Bone::A];
+				float y = setupLength * bone._transform[Bone::C];
 				float length = MathUtil::sqrt(x * x + y * y);
 				if (scale) {
 					_lengths[i] = length;
@@ -150,8 +150,8 @@ void PathConstraint::update() {
 	for (size_t i = 0, p = 3; i < boneCount; i++, p += 3) {
 		Bone *boneP = _bones[i];
 		Bone &bone = *boneP;
-		bone._worldX += (boneX - bone._worldX) * translateMix;
-		bone._worldY += (boneY - bone._worldY) * translateMix;
+		bone._transform[Bone::WorldX] += (boneX - bone._transform[Bone::WorldX]) * translateMix;
+		bone._transform[Bone::WorldY] += (boneY - bone._transform[Bone::WorldY]) * translateMix;
 		float x = positions[p];
 		float y = positions[p + 1];
 		float dx = x - boneX;
@@ -160,8 +160,8 @@ void PathConstraint::update() {
 			float length = _lengths[i];
 			if (length >= PathConstraint::EPSILON) {
 				float s = (MathUtil::sqrt(dx * dx + dy * dy) / length - 1) * rotateMix + 1;
-				bone._a *= s;
-				bone._c *= s;
+				bone._transform[Bone::A] *= s;
+				bone._transform[Bone::C] *= s;
 			}
 		}
 
@@ -169,7 +169,7 @@ void PathConstraint::update() {
 		boneY = y;
 
 		if (rotate) {
-			float a = bone._a, b = bone._b, c = bone._c, d = bone._d, r, cos, sin;
+			float a = bone._transform[Bone::A], b = bone._transform[Bone::B], c = bone._transform[Bone::C], d = bone._transform[Bone::D], r, cos, sin;
 			if (tangents)
 				r = positions[p - 1];
 			else if (_spaces[i + 1] < PathConstraint::EPSILON)
@@ -196,10 +196,10 @@ void PathConstraint::update() {
 			r *= rotateMix;
 			cos = MathUtil::cos(r);
 			sin = MathUtil::sin(r);
-			bone._a = cos * a - sin * c;
-			bone._b = cos * b - sin * d;
-			bone._c = sin * a + cos * c;
-			bone._d = sin * b + cos * d;
+			bone._transform[Bone::A] = cos * a - sin * c;
+			bone._transform[Bone::B] = cos * b - sin * d;
+			bone._transform[Bone::C] = sin * a + cos * c;
+			bone._transform[Bone::D] = sin * b + cos * d;
 		}
 
 		bone._appliedValid = false;
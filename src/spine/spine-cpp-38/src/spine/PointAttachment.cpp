@@ -51,8 +51,8 @@ void PointAttachment::computeWorldPosition(Bone &bone, float &ox, float &oy) {
 float PointAttachment::computeWorldRotation(Bone &bone) {
 	float cos = MathUtil::cosDeg(_rotation);
 	float sin = MathUtil::sinDeg(_rotation);
-	float ix = cos * bone._a + sin * bone._b;
-	float iy = cos * bone._c + sin * bone._d;
+	float ix = cos * bone._transform[Bone::A] + sin * bone._transform[Bone::B];
+	float iy = cos * bone._transform[Bone::C] + sin * bone._transform[Bone::D];
 
 	return MathUtil::atan2(iy, ix) * MathUtil::Rad_Deg;
 }
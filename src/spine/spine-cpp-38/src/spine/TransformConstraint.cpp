@@ -137,7 +137,7 @@ void TransformConstraint::setShearMix(float inValue) {
 void TransformConstraint::applyAbsoluteWorld() {
 	float rotateMix = _rotateMix, translateMix = _translateMix, scaleMix = _scaleMix, shearMix = _shearMix;
 	Bone &target = *_target;
-	float ta = target._a, tb = target._b, tc = target._c, td = target._d;
+	float ta = target._transform[Bone::A], tb = target._transform[Bone::B], tc = target._transform[Bone::C], td = target._transform[Bone::D];
 	float degRadReflect = ta * td - tb * tc > 0 ? MathUtil::Deg_Rad : -MathUtil::Deg_Rad;
 	float offsetRotation = _data._offsetRotation * degRadReflect, offsetShearY = _data._offsetShearY * degRadReflect;
 
@@ -148,7 +148,7 @@ void TransformConstraint::applyAbsoluteWorld() {
 		bool modified = false;
 
 		if (rotateMix != 0) {
-			float a = bone._a, b = bone._b, c = bone._c, d = bone._d;
+			float a = bone._transform[Bone::A], b = bone._transform[Bone::B], c = bone._transform[Bone::C], d = bone._transform[Bone::D];
 			float r = MathUtil::atan2(tc, ta) - MathUtil::atan2(c, a) + offsetRotation;
 			if (r > MathUtil::Pi)
 				r -= MathUtil::Pi_2;
@@ -157,39 +157,39 @@ void TransformConstraint::applyAbsoluteWorld() {
 
 			r *= rotateMix;
 			float cos = MathUtil::cos(r), sin = MathUtil::sin(r);
-			bone._a = cos * a - sin * c;
-			bone._b = cos * b - sin * d;
-			bone._c = sin * a + cos * c;
-			bone._d = sin * b + cos * d;
+			bone._transform[Bone::A] = cos * a - sin * c;
+			bone._transform[Bone::B] = cos * b - sin * d;
+			bone._transform[Bone::C] = sin * a + cos * c;
+			bone._transform[Bone::D] = sin * b + cos * d;
 			modified = true;
 		}
 
 		if (translateMix != 0) {
 			float tx, ty;
 			target.localToWorld(_data._offsetX, _data._offsetY, tx, ty);
-			bone._worldX += (tx - bone._worldX) * translateMix;
-			bone._worldY += (ty - bone._worldY) * translateMix;
+			bone._transform[Bone::WorldX] += (tx - bone._transform[Bone::WorldX]) * translateMix;
+			bone._transform[Bone::WorldY] += (ty - bone._transform[Bone::WorldY]) * translateMix;
 			modified = true;
 		}
 
 		if (scaleMix > 0) {
-			float s = MathUtil::sqrt(bone._a * bone._a + bone._c * bone._c);
+			float s = MathUtil::sqrt(bone._transform[Bone::A] * bone._transform[Bone::A] + bone._transform[Bone::C] * bone._transform[Bone::C]);
 
 			if (s > 0.00001f) s = (s + (MathUtil::sqrt(ta * ta + tc * tc) - s + _data._offsetScaleX) * scaleMix) / s;
-			bone._a *= s;
-			bone._c *= s;
-			s = MathUtil::sqrt(bone._b * bone._b + bone._d * bone._d);
+			bone._transform[Bone::A] *= s;
+			bone._transform[Bone::C] *= s;
+			s = MathUtil::sqrt(bone._transform[Bone::B] * bone._transform[Bone::B] + bone._transform[Bone::D] * bone._transform[Bone::D]);
 
 			if (s > 0.00001f) s = (s + (MathUtil::sqrt(tb * tb + td * td) - s + _data._offsetScaleY) * scaleMix) / s;
-			bone._b *= s;
-			bone._d *= s;
+			bone._transform[Bone::B] *= s;
+			bone._transform[Bone::D] *= s;
 			modified = true;
 		}
 
 		if (shearMix > 0) {
-			float b = bone._b, d = bone._d;
+			float b = bone._transform[Bone::B], d = bone._transform[Bone::D];
 			float by = MathUtil::atan2(d, b);
-			float r = MathUtil::atan2(td, tb) - MathUtil::atan2(tc, ta) - (by - MathUtil::atan2(bone._c, bone._a));
+			float r = MathUtil::atan2(td, tb) - MathUtil::atan2(tc, ta) - (by - MathUtil::atan2(bone._transform[Bone::C], bone._transform[Bone::A]));
 			if (r > MathUtil::Pi)
 				r -= MathUtil::Pi_2;
 			else if (r < -MathUtil::Pi)
@@ -197,8 +197,8 @@ void TransformConstraint::applyAbsoluteWorld() {
 
 			r = by + (r + offsetShearY) * shearMix;
 			float s = MathUtil::sqrt(b * b + d * d);
-			bone._b = MathUtil::cos(r) * s;
-			bone._d = MathUtil::sin(r) * s;
+			bone._transform[Bone::B] = MathUtil::cos(r) * s;
+			bone._transform[Bone::D] = MathUtil::sin(r) * s;
 			modified = true;
 		}
 
@@ -209,7 +209,7 @@ void TransformConstraint::applyAbsoluteWorld() {
 void TransformConstraint::applyRelativeWorld() {
 	float rotateMix = _rotateMix, translateMix = _translateMix, scaleMix = _scaleMix, shearMix = _shearMix;
 	Bone &target = *_target;
-	float ta = target._a, tb = target._b, tc = target._c, td = target._d;
+	float ta = target._transform[Bone::A], tb = target._transform[Bone::B], tc = target._transform[Bone::C], td = target._transform[Bone::D];
 	float degRadReflect = ta * td - tb * tc > 0 ? MathUtil::Deg_Rad : -MathUtil::Deg_Rad;
 	float offsetRotation = _data._offsetRotation * degRadReflect, offsetShearY = _data._offsetShearY * degRadReflect;
 	for (size_t i = 0; i < _bones.size(); ++i) {
@@ -219,7 +219,7 @@ void TransformConstraint::applyRelativeWorld() {
 		bool modified = false;
 
 		if (rotateMix != 0) {
-			float a = bone._a, b = bone._b, c = bone._c, d = bone._d;
+			float a = bone._transform[Bone::A], b = bone._transform[Bone::B], c = bone._transform[Bone::C], d = bone._transform[Bone::D];
 			float r = MathUtil::atan2(tc, ta) + offsetRotation;
 			if (r > MathUtil::Pi)
 				r -= MathUtil::Pi_2;
@@ -228,28 +228,28 @@ void TransformConstraint::applyRelativeWorld() {
 
 			r *= rotateMix;
 			float cos = MathUtil::cos(r), sin = MathUtil::sin(r);
-			bone._a = cos * a - sin * c;
-			bone._b = cos * b - sin * d;
-			bone._c = sin * a + cos * c;
-			bone._d = sin * b + cos * d;
+			bone._transform[Bone::A] = cos * a - sin * c;
+			bone._transform[Bone::B] = cos * b - sin * d;
+			bone._transform[Bone::C] = sin * a + cos * c;
+			bone._transform[Bone::D] = sin * b + cos * d;
 			modified = true;
 		}
 
 		if (translateMix != 0) {
 			float tx, ty;
 			target.localToWorld(_data._offsetX, _data._offsetY, tx, ty);
-			bone._worldX += tx * translateMix;
-			bone._worldY += ty * translateMix;
+			bone._transform[Bone::WorldX] += tx * translateMix;
+			bone._transform[Bone::WorldY] += ty * translateMix;
 			modified = true;
 		}
 
 		if (scaleMix > 0) {
 			float s = (MathUtil::sqrt(ta * ta + tc * tc) - 1 + _data._offsetScaleX) * scaleMix + 1;
-			bone._a *= s;
-			bone._c *= s;
+			bone._transform[Bone::A] *= s;
+			bone._transform[Bone::C] *= s;
 			s = (MathUtil::sqrt(tb * tb + td * td) - 1 + _data._offsetScaleY) * scaleMix + 1;
-			bone._b *= s;
-			bone._d *= s;
+			bone._transform[Bone::B] *= s;
+			bone._transform[Bone::D] *= s;
 			modified = true;
 		}
 
@@ -260,11 +260,11 @@ void TransformConstraint::applyRelativeWorld() {
 			else if (r < -MathUtil::Pi)
 				r += MathUtil::Pi_2;
 
-			float b = bone._b, d = bone._d;
+			float b = bone._transform[Bone::B], d = bone._transform[Bone::D];
 			r = MathUtil::atan2(d, b) + (r - MathUtil::Pi / 2 + offsetShearY) * shearMix;
 			float s = MathUtil::sqrt(b * b + d * d);
-			bone._b = MathUtil::cos(r) * s;
-			bone._d = MathUtil::sin(r) * s;
+			bone._transform[Bone::B] = MathUtil::cos(r) * s;
+			bone._transform[Bone::D] = MathUtil::sin(r) * s;
 			modified = true;
 		}
 
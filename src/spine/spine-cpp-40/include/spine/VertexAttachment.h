@@ -34,9 +34,13 @@
 
 #include <spine/Vector.h>
 
+#include <atomic>
+
 namespace spine {
 	class Slot;
 
+	class VertexSkinning;
+
 	/// An attachment with vertices that are transformed by one or more bones and can be deformed by a slot's vertices.
 	class SP_API VertexAttachment : public Attachment {
 		friend class SkeletonBinary;
@@ -92,9 +96,14 @@ namespace spine {
 		VertexAttachment *_deformAttachment;
 
 	private:
+		std::atomic<VertexSkinning *> _skinning;
+
 		const int _id;
 
 		static int getNextID();
+
+		/// The layout the weighted vertices are skinned with, built on first use. NULL if SIMD skinning is off.
+		VertexSkinning *getSkinning();
 	};
 }
 
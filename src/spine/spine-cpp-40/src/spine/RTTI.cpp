@@ -47,13 +47,13 @@ const char *RTTI::getClassName() const {
 }
 
 bool RTTI::isExactly(const RTTI &rtti) const {
-	return !strcmp(this->_className, rtti._className);
+	return this == &rtti;
 }
 
 bool RTTI::instanceOf(const RTTI &rtti) const {
 	const RTTI *pCompare = this;
 	while (pCompare) {
-		if (!strcmp(pCompare->_className, rtti._className)) return true;
+		if (pCompare == &rtti) return true;
 		pCompare = pCompare->_pBaseRTTI;
 	}
 	return false;
@@ -101,7 +101,8 @@ namespace spine {
 		static bool isYDown();
 
 		/// @param parent May be NULL.
-		Bone(BoneData &data, Skeleton &skeleton, Bone *parent = NULL);
+		/// @param transform VertexSkinning::TransformStride floats the skeleton keeps the world transform in.
+		Bone(BoneData &data, Skeleton &skeleton, Bone *parent, float *transform);
 
 		/// Same as updateWorldTransform. This method exists for Bone to implement Spine::Updatable.
 		virtual void update();
@@ -256,14 +257,16 @@ namespace spine {
 	private:
 		static bool yDown;
 
+		/// Offsets of the world transform in _transform
+		enum { A, B, C, D, WorldX, WorldY };
+
 		BoneData &_data;
 		Skeleton &_skeleton;
 		Bone *_parent;
 		Vector<Bone *> _children;
 		float _x, _y, _rotation, _scaleX, _scaleY, _shearX, _shearY;
 		float _ax, _ay, _arotation, _ascaleX, _ascaleY, _ashearX, _ashearY;
-		float _a, _b, _worldX;
-		float _c, _d, _worldY;
+		float *_transform; // a, b, c, d, worldX, worldY and padding, kept by the skeleton
 		bool _sorted;
 		bool _active;
 	};
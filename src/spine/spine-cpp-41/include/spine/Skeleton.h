@@ -113,7 +113,8 @@ namespace spine {
 		friend class TwoColorTimeline;
 
 	public:
-		explicit Skeleton(SkeletonData *skeletonData);
+		/// @param boneTransformBlock Keeps the world transforms of the bones in one block, see getBoneTransforms.
+		explicit Skeleton(SkeletonData *skeletonData, bool boneTransformBlock = false);
 
 		~Skeleton();
 
@@ -186,6 +187,11 @@ namespace spine {
 
 		Vector<Bone *> &getBones();
 
+		/// World transforms of the bones in the order of getBones, VertexSkinning::TransformStride floats
+		/// each: a, b, c, d, worldX, worldY and padding. The bones read and write them in place, so code
+		/// reading many bones walks one block. NULL unless the skeleton was created with boneTransformBlock.
+		float *getBoneTransforms();
+
 		Vector<Updatable *> &getUpdateCacheList();
 
 		Vector<Slot *> &getSlots();
@@ -222,6 +228,8 @@ namespace spine {
 
 	private:
 		SkeletonData *_data;
+		char *_arena; // the bones with their world transforms, slots and constraints in one allocation, or NULL
+		float *_boneTransforms;
 		Vector<Bone *> _bones;
 		Vector<Slot *> _slots;
 		Vector<Slot *> _drawOrder;
@@ -33,16 +33,18 @@
 
 #include <spine/Bone.h>
 #include <spine/Skeleton.h>
+#include <spine/VertexSkinning.h>
 
 using namespace spine;
 
 RTTI_IMPL(VertexAttachment, Attachment)
 
 VertexAttachment::VertexAttachment(const String &name) : Attachment(name), _worldVerticesLength(0),
-														 _timelineAttachment(this), _id(getNextID()) {
+														 _timelineAttachment(this), _skinning(NULL), _id(getNextID()) {
 }
 
 VertexAttachment::~VertexAttachment() {
+	delete _skinning.load();
 }
 
 void VertexAttachment::computeWorldVertices(Slot &slot, Vector<float> &worldVertices) {
@@ -69,9 +71,9 @@ void VertexAttachment::computeWorldVertices(Slot &slot, size_t start, size_t cou
 		if (deformArray->size() > 0) vertices = deformArray;
 
 		Bone &bone = slot._bone;
-		float x = bone._worldX;
-		float y = bone._worldY;
-		float a = bone._a, b = bone._b, c = bone._c, d = bone._d;
+		float x = bone._transform[Bone::WorldX];
+		float y = bone._transform[Bone::WorldY];
+		float a = bone._transform[Bone::A], b = bone._transform[Bone::B], c = bone._transform[Bone::C], d = bone._transform[Bone::D];
 		for (size_t vv = start, w = offset; w < count; vv += 2, w += stride) {
 			float vx = (*vertices)[vv];
 			float vy = (*vertices)[vv + 1];
@@ -81,6 +83,34 @@ void VertexAttachment::computeWorldVertices(Slot &slot, size_t start, size_t cou
 		return;
 	}
 
+	VertexSkinning *skinning = start == 0 && count == offset + (_worldVerticesLength >> 1) * stride ? getSkinning() : NULL;
+	float *boneTransforms = skeleton.getBoneTransforms();
+	if (skinning && boneTransforms) {
+		// The skeleton keeps the transforms of all bones in one block, skin straight from it
+		skinning->computeFromSkeleton(boneTransforms, deformArray->size() > 0 ? deformArray->buffer() : NULL, worldVertices,
+									  offset, stride);
+		return;
+	}
+	if (skinning && skinning->getBones().size() <= (size_t) VertexSkinning::MaxBones) {
+		// Copy the transforms of the bones once, then skin several vertices at a time
+		Vector<int> &skinningBones = skinning->getBones();
+		Vector<Bone *> &skeletonBones = skeleton.getBones();
+		float transforms[VertexSkinning::MaxBones * VertexSkinning::TransformStride];
+		for (size_t i = 0, t = 0; i < skinningBones.size(); i++, t += VertexSkinning::TransformStride) {
+			Bone &bone = *skeletonBones[skinningBones[i]];
+			transforms[t] = bone._transform[Bone::A];
+			transforms[t + 1] = bone._transform[Bone::B];
+			transforms[t + 2] = bone._transform[Bone::C];
+			transforms[t + 3] = bone._transform[Bone::D];
+			transforms[t + 4] = bone._transform[Bone::WorldX];
+			transforms[t + 5] = bone._transform[Bone::WorldY];
+			transforms[t + 6] = 0;
+			transforms[t + 7] = 0;
+		}
+		skinning->compute(transforms, deformArray->size() > 0 ? deformArray->buffer() : NULL, worldVertices, offset, stride);
+		return;
+	}
+
 	int v = 0, skip = 0;
 	for (size_t i = 0; i < start; i += 2) {
 		int n = (int) bones[v];
@@ -100,8 +130,8 @@ void VertexAttachment::computeWorldVertices(Slot &slot, size_t start, size_t cou
 				float vx = (*vertices)[b];
 				float vy = (*vertices)[b + 1];
 				float weight = (*vertices)[b + 2];
-				wx += (vx * bone._a + vy * bone._b + bone._worldX) * weight;
-				wy += (vx * bone._c + vy * bone._d + bone._worldY) * weight;
+				wx += (vx * bone._transform[Bone::A] + vy * bone._transform[Bone::B] + bone._transform[Bone::WorldX]) * weight;
+				wy += (vx * bone._transform[Bone::C] + vy * bone._transform[Bone::D] + bone._transform[Bone::WorldY]) * weight;
 			}
 			worldVertices[w] = wx;
 			worldVertices[w + 1] = wy;
@@ -117,8 +147,8 @@ void VertexAttachment::computeWorldVertices(Slot &slot, size_t start, size_t cou
 				float vx = (*vertices)[b] + (*deformArray)[f];
 				float vy = (*vertices)[b + 1] + (*deformArray)[f + 1];
 				float weight = (*vertices)[b + 2];
-				wx += (vx * bone._a + vy * bone._b + bone._worldX) * weight;
-				wy += (vx * bone._c + vy * bone._d + bone._worldY) * weight;
+				wx += (vx * bone._transform[Bone::A] + vy * bone._transform[Bone::B] + bone._transform[Bone::WorldX]) * weight;
+				wy += (vx * bone._transform[Bone::C] + vy * bone._transform[Bone::D] + bone._transform[Bone::WorldY]) * weight;
 			}
 			worldVertices[w] = wx;
 			worldVertices[w + 1] = wy;
@@ -159,7 +189,23 @@ int VertexAttachment::getNextID() {
 	return nextID++;
 }
 
+VertexSkinning *VertexAttachment::getSkinning() {
+	// Shared by every skeleton of the data, if two threads build it at once the first one wins
+	if (_bones.size() == 0 || VertexSkinning::getKernel() == SkinningKernel_None) return NULL;
+	VertexSkinning *skinning = _skinning.load(std::memory_order_acquire);
+	if (!skinning) {
+		skinning = new (__FILE__, __LINE__) VertexSkinning(_bones, _vertices);
+		VertexSkinning *built = NULL;
+		if (!_skinning.compare_exchange_strong(built, skinning, std::memory_order_acq_rel)) {
+			delete skinning;
+			skinning = built;
+		}
+	}
+	return skinning;
+}
+
 void VertexAttachment::copyTo(VertexAttachment *other) {
+	delete other->_skinning.exchange(NULL);
 	other->_bones.clearAndAddAll(this->_bones);
 	other->_vertices.clearAndAddAll(this->_vertices);
 	other->_worldVerticesLength = this->_worldVerticesLength;
@@ -0,0 +1,326 @@
+/******************************************************************************
+ * Spine Runtimes License Agreement
+ * Last updated July 28, 2023. Replaces all prior versions.
+ *
+ * Copyright (c) 2013-2023, Esoteric Software LLC
+ *
+ * Integration of the Spine Runtimes into software or otherwise creating
+ * derivative works of the Spine Runtimes is permitted under the terms and
+ * conditions of Section 2 of the Spine Editor License Agreement:
+ * http://esotericsoftware.com/spine-editor-license
+ *
+ * Otherwise, it is permitted to integrate the Spine Runtimes into software or
+ * otherwise create derivative works of the Spine Runtimes (collectively,
+ * "Products"), provided that each user of the Products must obtain their own
+ * Spine Editor license and redistribution of the Products in any form must
+ * include this license and copyright notice.
+ *
+ * THE SPINE RUNTIMES ARE PROVIDED BY ESOTERIC SOFTWARE LLC "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ESOTERIC SOFTWARE LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES,
+ * BUSINESS INTERRUPTION, OR LOSS OF USE, DATA, OR PROFITS) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THE
+ * SPINE RUNTIMES, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#include <spine/VertexSkinning.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SPINE_SKINNING_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SPINE_SKINNING_TARGET_AVX2
+#else
+#define SPINE_SKINNING_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(_M_ARM64) || defined(__aarch64__) || defined(__ARM_NEON)
+#define SPINE_SKINNING_ARM
+#include <arm_neon.h>
+#endif
+
+using namespace spine;
+
+/// Vertices a kernel skins at once, lanes of a group are padded to a multiple of it
+static const int BlockLanes = 8;
+
+/// One block of lanes of a group. The lane arrays point at the block's lanes of the group's first
+/// influence, the next influence follows lanes entries later.
+struct SkinningBlock {
+	int influences;
+	int lanes;
+	const int *transformOffsets;
+	const int *deformOffsets;
+	const float *x;
+	const float *y;
+	const float *weights;
+};
+
+typedef void (*SkinningBlockFunc)(const SkinningBlock &block, const float *transforms, const float *deform,
+								  float *worldX, float *worldY);
+
+#if defined(SPINE_SKINNING_X86)
+
+/// Loads the a, b, c, d and worldX, worldY of the bones of 4 lanes, one register per field
+static inline void loadTransformsSSE2(const float *transforms, const int *offsets, __m128 *a, __m128 *b, __m128 *c,
+									  __m128 *d, __m128 *x, __m128 *y) {
+	__m128 r0 = _mm_loadu_ps(transforms + offsets[0]);
+	__m128 r1 = _mm_loadu_ps(transforms + offsets[1]);
+	__m128 r2 = _mm_loadu_ps(transforms + offsets[2]);
+	__m128 r3 = _mm_loadu_ps(transforms + offsets[3]);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	*a = r0;
+	*b = r1;
+	*c = r2;
+	*d = r3;
+	__m128 t0 = _mm_loadu_ps(transforms + offsets[0] + 4);
+	__m128 t1 = _mm_loadu_ps(transforms + offsets[1] + 4);
+	__m128 t2 = _mm_loadu_ps(transforms + offsets[2] + 4);
+	__m128 t3 = _mm_loadu_ps(transforms + offsets[3] + 4);
+	_MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+	*x = t0;
+	*y = t1;
+}
+
+static void skinBlockSSE2(const SkinningBlock &block, const float *transforms, const float *deform, float *worldX,
+						  float *worldY) {
+	for (int half = 0; half < BlockLanes; half += 4) {
+		__m128 wx = _mm_setzero_ps(), wy = _mm_setzero_ps();
+		for (int i = 0, l = half; i < block.influences; i++, l += block.lanes) {
+			__m128 vx = _mm_loadu_ps(block.x + l);
+			__m128 vy = _mm_loadu_ps(block.y + l);
+			if (deform) {
+				const int *f = block.deformOffsets + l;
+				vx = _mm_add_ps(vx, _mm_setr_ps(deform[f[0]], deform[f[1]], deform[f[2]], deform[f[3]]));
+				vy = _mm_add_ps(vy, _mm_setr_ps(deform[f[0] + 1], deform[f[1] + 1], deform[f[2] + 1], deform[f[3] + 1]));
+			}
+			__m128 a, b, c, d, x, y;
+			loadTransformsSSE2(transforms, block.transformOffsets + l, &a, &b, &c, &d, &x, &y);
+			__m128 weight = _mm_loadu_ps(block.weights + l);
+			wx = _mm_add_ps(wx, _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, a), _mm_mul_ps(vy, b)), x), weight));
+			wy = _mm_add_ps(wy, _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, c), _mm_mul_ps(vy, d)), y), weight));
+		}
+		_mm_storeu_ps(worldX + half, wx);
+		_mm_storeu_ps(worldY + half, wy);
+	}
+}
+
+/// Gathers the bone fields with AVX2 and skins all 8 lanes at once. Multiplies and adds stay
+/// separate instructions, a fused multiply-add would round differently than the scalar loop.
+SPINE_SKINNING_TARGET_AVX2
+static void skinBlockAVX2(const SkinningBlock &block, const float *transforms, const float *deform, float *worldX,
+						  float *worldY) {
+	__m256 wx = _mm256_setzero_ps(), wy = _mm256_setzero_ps();
+	for (int i = 0, l = 0; i < block.influences; i++, l += block.lanes) {
+		__m256 vx = _mm256_loadu_ps(block.x + l);
+		__m256 vy = _mm256_loadu_ps(block.y + l);
+		if (deform) {
+			__m256i f = _mm256_loadu_si256((const __m256i *) (block.deformOffsets + l));
+			vx = _mm256_add_ps(vx, _mm256_i32gather_ps(deform, f, 4));
+			vy = _mm256_add_ps(vy, _mm256_i32gather_ps(deform + 1, f, 4));
+		}
+		__m256i t = _mm256_loadu_si256((const __m256i *) (block.transformOffsets + l));
+		__m256 a = _mm256_i32gather_ps(transforms, t, 4);
+		__m256 b = _mm256_i32gather_ps(transforms + 1, t, 4);
+		__m256 c = _mm256_i32gather_ps(transforms + 2, t, 4);
+		__m256 d = _mm256_i32gather_ps(transforms + 3, t, 4);
+		__m256 x = _mm256_i32gather_ps(transforms + 4, t, 4);
+		__m256 y = _mm256_i32gather_ps(transforms + 5, t, 4);
+		__m256 weight = _mm256_loadu_ps(block.weights + l);
+		wx = _mm256_add_ps(wx, _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, a), _mm256_mul_ps(vy, b)), x), weight));
+		wy = _mm256_add_ps(wy, _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, c), _mm256_mul_ps(vy, d)), y), weight));
+	}
+	_mm256_storeu_ps(worldX, wx);
+	_mm256_storeu_ps(worldY, wy);
+}
+
+static bool cpuSupportsAVX2() {
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#elif defined(SPINE_SKINNING_ARM)
+
+static inline void transposeNEON(float32x4_t r0, float32x4_t r1, float32x4_t r2, float32x4_t r3, float32x4_t *c0,
+								 float32x4_t *c1, float32x4_t *c2, float32x4_t *c3) {
+	float32x4x2_t t01 = vtrnq_f32(r0, r1);
+	float32x4x2_t t23 = vtrnq_f32(r2, r3);
+	*c0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+	*c1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+	*c2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+	*c3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+static void skinBlockNEON(const SkinningBlock &block, const float *transforms, const float *deform, float *worldX,
+						  float *worldY) {
+	for (int half = 0; half < BlockLanes; half += 4) {
+		float32x4_t wx = vdupq_n_f32(0), wy = vdupq_n_f32(0);
+		for (int i = 0, l = half; i < block.influences; i++, l += block.lanes) {
+			float32x4_t vx = vld1q_f32(block.x + l);
+			float32x4_t vy = vld1q_f32(block.y + l);
+			if (deform) {
+				const int *f = block.deformOffsets + l;
+				float dx[4] = {deform[f[0]], deform[f[1]], deform[f[2]], deform[f[3]]};
+				float dy[4] = {deform[f[0] + 1], deform[f[1] + 1], deform[f[2] + 1], deform[f[3] + 1]};
+				vx = vaddq_f32(vx, vld1q_f32(dx));
+				vy = vaddq_f32(vy, vld1q_f32(dy));
+			}
+			const int *t = block.transformOffsets + l;
+			float32x4_t a, b, c, d, x, y, unused0, unused1;
+			transposeNEON(vld1q_f32(transforms + t[0]), vld1q_f32(transforms + t[1]), vld1q_f32(transforms + t[2]),
+						  vld1q_f32(transforms + t[3]), &a, &b, &c, &d);
+			transposeNEON(vld1q_f32(transforms + t[0] + 4), vld1q_f32(transforms + t[1] + 4),
+						  vld1q_f32(transforms + t[2] + 4), vld1q_f32(transforms + t[3] + 4), &x, &y, &unused0, &unused1);
+			float32x4_t weight = vld1q_f32(block.weights + l);
+			wx = vaddq_f32(wx, vmulq_f32(vaddq_f32(vaddq_f32(vmulq_f32(vx, a), vmulq_f32(vy, b)), x), weight));
+			wy = vaddq_f32(wy, vmulq_f32(vaddq_f32(vaddq_f32(vmulq_f32(vx, c), vmulq_f32(vy, d)), y), weight));
+		}
+		vst1q_f32(worldX + half, wx);
+		vst1q_f32(worldY + half, wy);
+	}
+}
+
+#endif
+
+static SkinningKernel selectKernel() {
+#if defined(SPINE_SKINNING_X86)
+	return cpuSupportsAVX2() ? SkinningKernel_AVX2 : SkinningKernel_SSE2;
+#elif defined(SPINE_SKINNING_ARM)
+	return SkinningKernel_NEON;
+#else
+	return SkinningKernel_None;
+#endif
+}
+
+static SkinningBlockFunc selectBlockFunc(SkinningKernel kernel) {
+	switch (kernel) {
+#if defined(SPINE_SKINNING_X86)
+		case SkinningKernel_AVX2:
+			return skinBlockAVX2;
+		case SkinningKernel_SSE2:
+			return skinBlockSSE2;
+#elif defined(SPINE_SKINNING_ARM)
+		case SkinningKernel_NEON:
+			return skinBlockNEON;
+#endif
+		default:
+			return NULL;
+	}
+}
+
+static SkinningKernel skinningKernel = selectKernel();
+static SkinningBlockFunc skinningBlockFunc = selectBlockFunc(skinningKernel);
+
+VertexSkinning::VertexSkinning(Vector<int> &bones, Vector<float> &vertices) {
+	// Where each vertex starts in bones, the bone count followed by the bone indices
+	Vector<int> starts;
+	int maxInfluences = 0;
+	for (size_t v = 0; v < bones.size(); v += bones[v] + 1) {
+		starts.add((int) v);
+		if (bones[v] > maxInfluences) maxInfluences = bones[v];
+	}
+
+	Vector<int> group;
+	for (int n = 1; n <= maxInfluences; n++) {
+		group.clear();
+		for (size_t i = 0; i < starts.size(); i++)
+			if (bones[starts[i]] == n) group.add((int) i);
+		if (group.size() == 0) continue;
+		int count = (int) group.size();
+		int lanes = (count + BlockLanes - 1) / BlockLanes * BlockLanes;
+		_groupInfluences.add(n);
+		_groupVertices.add(count);
+		_groupLanes.add(lanes);
+		_groupStart.add((int) _x.size());
+		for (int l = 0; l < lanes; l++) _targets.add(l < count ? group[l] : 0);
+		for (int j = 0; j < n; j++) {
+			for (int l = 0; l < lanes; l++) {
+				if (l >= count) {
+					// Padding lanes skin vertex 0 of bone 0 with no weight and are never stored
+					_transformOffsets.add(0);
+					_boneOffsets.add(0);
+					_deformOffsets.add(0);
+					_x.add(0);
+					_y.add(0);
+					_weights.add(0);
+					continue;
+				}
+				int vertex = group[l];
+				int v = starts[vertex] + 1 + j;
+				// Influences before this one, each has 3 vertices values and 2 deform values
+				int influence = v - vertex - 1;
+				int bone = _bones.indexOf(bones[v]);
+				if (bone < 0) {
+					bone = (int) _bones.size();
+					_bones.add(bones[v]);
+				}
+				_transformOffsets.add(bone * TransformStride);
+				_boneOffsets.add(bones[v] * TransformStride);
+				_deformOffsets.add(influence * 2);
+				_x.add(vertices[influence * 3]);
+				_y.add(vertices[influence * 3 + 1]);
+				_weights.add(vertices[influence * 3 + 2]);
+			}
+		}
+	}
+}
+
+Vector<int> &VertexSkinning::getBones() {
+	return _bones;
+}
+
+void VertexSkinning::compute(const float *transforms, const float *deform, float *worldVertices, size_t offset,
+							 size_t stride) {
+	skin(transforms, _transformOffsets, deform, worldVertices, offset, stride);
+}
+
+void VertexSkinning::computeFromSkeleton(const float *boneTransforms, const float *deform, float *worldVertices,
+										 size_t offset, size_t stride) {
+	skin(boneTransforms, _boneOffsets, deform, worldVertices, offset, stride);
+}
+
+void VertexSkinning::skin(const float *transforms, Vector<int> &transformOffsets, const float *deform,
+						  float *worldVertices, size_t offset, size_t stride) {
+	float worldX[BlockLanes], worldY[BlockLanes];
+	for (size_t g = 0, target = 0; g < _groupInfluences.size(); target += _groupLanes[g], g++) {
+		int start = _groupStart[g];
+		int lanes = _groupLanes[g];
+		int count = _groupVertices[g];
+		for (int l = 0; l < lanes; l += BlockLanes) {
+			SkinningBlock block = {_groupInfluences[g], lanes, transformOffsets.buffer() + start + l,
+								   _deformOffsets.buffer() + start + l, _x.buffer() + start + l,
+								   _y.buffer() + start + l, _weights.buffer() + start + l};
+			skinningBlockFunc(block, transforms, deform, worldX, worldY);
+			int stored = count - l < BlockLanes ? count - l : BlockLanes;
+			for (int i = 0; i < stored; i++) {
+				size_t w = offset + _targets[target + l + i] * stride;
+				worldVertices[w] = worldX[i];
+				worldVertices[w + 1] = worldY[i];
+			}
+		}
+	}
+}
+
+SkinningKernel VertexSkinning::getKernel() {
+	return skinningKernel;
+}
+
+void VertexSkinning::setKernel(SkinningKernel kernel) {
+	skinningKernel = kernel;
+	skinningBlockFunc = selectBlockFunc(kernel);
+}
@@ -41,14 +41,14 @@ RTTI_IMPL(IkConstraint, Updatable)
 
 void IkConstraint::apply(Bone &bone, float targetX, float targetY, bool compress, bool stretch, bool uniform, float alpha) {
 	Bone *p = bone.getParent();
-	float pa = p->_a, pb = p->_b, pc = p->_c, pd = p->_d;
+	float pa = p->_transform[Bone::A], pb = p->_transform[Bone::B], pc = p->_transform[Bone::C], pd = p->_transform[Bone::D];
 	float rotationIK = -bone._ashearX - bone._arotation;
 	float tx = 0, ty = 0;
 
 	switch (bone._inherit) {
 		case Inherit_OnlyTranslation:
-			tx = (targetX - bone._worldX) * MathUtil::sign(bone.getSkeleton().getScaleX());
-			ty = (targetY - bone._worldY) * MathUtil::sign(bone.getSkeleton().getScaleY());
+			tx = (targetX - bone._transform[Bone::WorldX]) * MathUtil::sign(bone.getSkeleton().getScaleX());
+			ty = (targetY - bone._transform[Bone::WorldY]) * MathUtil::sign(bone.getSkeleton().getScaleY());
 			break;
 		case Inherit_NoRotationOrReflection: {
 			float s = MathUtil::abs(pa * pd - pb * pc) / MathUtil::max(0.0001f, pa * pa + pc * pc);
@@ -59,7 +59,7 @@ void IkConstraint::apply(Bone &bone, float targetX, float targetY, bool compress
 			rotationIK += MathUtil::atan2Deg(sc, sa);
 		}
 		default:
-			float x = targetX - p->_worldX, y = targetY - p->_worldY;
+			float x = targetX - p->_transform[Bone::WorldX], y = targetY - p->_transform[Bone::WorldY];
 			float d = pa * pd - pb * pc;
 			if (MathUtil::abs(d) <= 0.0001f) {
 				tx = 0;
@@ -80,8 +80,8 @@ void IkConstraint::apply(Bone &bone, float targetX, float targetY, bool compress
 		switch (bone._inherit) {
 			case Inherit_NoScale:
 			case Inherit_NoScaleOrReflection:
-				tx = targetX - bone._worldX;
-				ty = targetY - bone._worldY;
+				tx = targetX - bone._transform[Bone::WorldX];
+				ty = targetY - bone._transform[Bone::WorldY];
 			default:;
 		}
 
@@ -139,21 +139,21 @@ void IkConstraint::apply(Bone &parent, Bone &child, float targetX, float targetY
 	u = (r < 0 ? -r : r) <= 0.0001f;
 	if (!u || stretch) {
 		cy = 0;
-		cwx = parent._a * cx + parent._worldX;
-		cwy = parent._c * cx + parent._worldY;
+		cwx = parent._transform[Bone::A] * cx + parent._transform[Bone::WorldX];
+		cwy = parent._transform[Bone::C] * cx + parent._transform[Bone::WorldY];
 	} else {
 		cy = child._ay;
-		cwx = parent._a * cx + parent._b * cy + parent._worldX;
-		cwy = parent._c * cx + parent._d * cy + parent._worldY;
+		cwx = parent._transform[Bone::A] * cx + parent._transform[Bone::B] * cy + parent._transform[Bone::WorldX];
+		cwy = parent._transform[Bone::C] * cx + parent._transform[Bone::D] * cy + parent._transform[Bone::WorldY];
 	}
-	a = pp->_a;
-	b = pp->_b;
-	c = pp->_c;
-	d = pp->_d;
+	a = pp->_transform[Bone::A];
+	b = pp->_transform[Bone::B];
+	c = pp->_transform[Bone::C];
+	d = pp->_transform[Bone::D];
 	id = a * d - b * c;
 	id = MathUtil::abs(id) <= 0.0001f ? 0 : 1 / id;
-	x = cwx - pp->_worldX;
-	y = cwy - pp->_worldY;
+	x = cwx - pp->_transform[Bone::WorldX];
+	y = cwy - pp->_transform[Bone::WorldY];
 	dx = (x * d - y * b) * id - px;
 	dy = (y * a - x * c) * id - py;
 	l1 = MathUtil::sqrt(dx * dx + dy * dy);
@@ -163,8 +163,8 @@ void IkConstraint::apply(Bone &parent, Bone &child, float targetX, float targetY
 		child.updateWorldTransform(cx, cy, 0, child._ascaleX, child._ascaleY, child._ashearX, child._ashearY);
 		return;
 	}
-	x = targetX - pp->_worldX;
-	y = targetY - pp->_worldY;
+	x = targetX - pp->_transform[Bone::WorldX];
+	y = targetY - pp->_transform[Bone::WorldY];
 	tx = (x * d - y * b) * id - px;
 	ty = (y * a - x * c) * id - py;
 	dd = tx * tx + ty * ty;
@@ -91,8 +91,8 @@ void PathConstraint::update(Physics) {
 					Bone *boneP = _bones[i];
 					Bone &bone = *boneP;
 					float setupLength = bone._data.getLength();
-					float x = setupLength * bone._a;
-					float y = setupLength * bone._c;
+					float x = setupLength * bone._transform[Bone::A];
+					float y = setupLength * bone._transform[Bone::C];
 					_lengths[i] = MathUtil::sqrt(x * x + y * y);
 				}
 			}
@@ -111,7 +111,7 @@ void PathConstraint::update(Physics) {
 					if (scale) _lengths[i] = 0;
 					_spaces[++i] = spacing;
 				} else {
-					float x = setupLength * bone._a, y = setupLength * bone._c;
+					float x = setupLength * bone._transform[Bone::A], y = setupLength * bone._transform[Bone::C];
 					float length = MathUtil::sqrt(x * x + y * y);
 					if (scale) _lengths[i] = length;
 					_spaces[++i] = length;
@@ -136,7 +136,7 @@ void PathConstraint::update(Physics) {
 					if (scale) _lengths[i] = 0;
 					_spaces[++i] = spacing;
 				} else {
-					float x = setupLength * bone._a, y = setupLength * bone._c;
+					float x = setupLength * bone._transform[Bone::A], y = setupLength * bone._transform[Bone::C];
 					float length = MathUtil::sqrt(x * x + y * y);
 					if (scale) _lengths[i] = length;
 					_spaces[++i] = (lengthSpacing ? setupLength + spacing : spacing) * length / setupLength;
@@ -161,8 +161,8 @@ void PathConstraint::update(Physics) {
 	for (size_t i = 0, p = 3; i < boneCount; i++, p += 3) {
 		Bone *boneP = _bones[i];
 		Bone &bone = *boneP;
-		bone._worldX += (boneX - bone._worldX) * mixX;
-		bone._worldY += (boneY - bone._worldY) * mixY;
+		bone._transform[Bone::WorldX] += (boneX - bone._transform[Bone::WorldX]) * mixX;
+		bone._transform[Bone::WorldY] += (boneY - bone._transform[Bone::WorldY]) * mixY;
 		float x = positions[p];
 		float y = positions[p + 1];
 		float dx = x - boneX;
@@ -171,8 +171,8 @@ void PathConstraint::update(Physics) {
 			float length = _lengths[i];
 			if (length >= PathConstraint::EPSILON) {
 				float s = (MathUtil::sqrt(dx * dx + dy * dy) / length - 1) * mixRotate + 1;
-				bone._a *= s;
-				bone._c *= s;
+				bone._transform[Bone::A] *= s;
+				bone._transform[Bone::C] *= s;
 			}
 		}
 
@@ -180,7 +180,7 @@ void PathConstraint::update(Physics) {
 		boneY = y;
 
 		if (mixRotate > 0) {
-			float a = bone._a, b = bone._b, c = bone._c, d = bone._d, r, cos, sin;
+			float a = bone._transform[Bone::A], b = bone._transform[Bone::B], c = bone._transform[Bone::C], d = bone._transform[Bone::D], r, cos, sin;
 			if (tangents)
 				r = positions[p - 1];
 			else if (_spaces[i + 1] < PathConstraint::EPSILON)
@@ -207,10 +207,10 @@ void PathConstraint::update(Physics) {
 			r *= mixRotate;
 			cos = MathUtil::cos(r);
 			sin = MathUtil::sin(r);
-			bone._a = cos * a - sin * c;
-			bone._b = cos * b - sin * d;
-			bone._c = sin * a + cos * c;
-			bone._d = sin * b + cos * d;
+			bone._transform[Bone::A] = cos * a - sin * c;
+			bone._transform[Bone::B] = cos * b - sin * d;
+			bone._transform[Bone::C] = sin * a + cos * c;
+			bone._transform[Bone::D] = sin * b + cos * d;
 		}
 
 		bone.updateAppliedTransform();
@@ -328,7 +328,7 @@ void PhysicsConstraint::update(Physics physics) {
 			_remaining += delta;
 			_lastTime = _skeleton.getTime();
 
-			float bx = bone->_worldX, by = bone->_worldY;
+			float bx = bone->_transform[Bone::WorldX], by = bone->_transform[Bone::WorldY];
 			if (_reset) {
 				_reset = false;
 				_ux = bx;
@@ -367,13 +367,13 @@ void PhysicsConstraint::update(Physics physics) {
 							a -= t;
 						} while (a >= t);
 					}
-					if (x) bone->_worldX += _xOffset * mix * _data._x;
-					if (y) bone->_worldY += _yOffset * mix * _data._y;
+					if (x) bone->_transform[Bone::WorldX] += _xOffset * mix * _data._x;
+					if (y) bone->_transform[Bone::WorldY] += _yOffset * mix * _data._y;
 				}
 
 				if (rotateOrShearX || scaleX) {
-					float ca = MathUtil::atan2(bone->_c, bone->_a), c, s, mr = 0;
-					float dx = _cx - bone->_worldX, dy = _cy - bone->_worldY;
+					float ca = MathUtil::atan2(bone->_transform[Bone::C], bone->_transform[Bone::A]), c, s, mr = 0;
+					float dx = _cx - bone->_transform[Bone::WorldX], dy = _cy - bone->_transform[Bone::WorldY];
 					if (dx > qx)
 						dx = qx;
 					else if (dx < -qx)//
@@ -426,13 +426,13 @@ void PhysicsConstraint::update(Physics physics) {
 				_remaining = a;
 			}
 
-			_cx = bone->_worldX;
-			_cy = bone->_worldY;
+			_cx = bone->_transform[Bone::WorldX];
+			_cy = bone->_transform[Bone::WorldY];
 			break;
 		}
 		case Physics::Physics_Pose: {
-			if (x) bone->_worldX += _xOffset * mix * _data._x;
-			if (y) bone->_worldY += _yOffset * mix * _data._y;
+			if (x) bone->_transform[Bone::WorldX] += _xOffset * mix * _data._x;
+			if (y) bone->_transform[Bone::WorldY] += _yOffset * mix * _data._y;
 			break;
 		}
 	}
@@ -445,36 +445,36 @@ void PhysicsConstraint::update(Physics physics) {
 				r = o * _data._rotate;
 				s = MathUtil::sin(r);
 				c = MathUtil::cos(r);
-				a = bone->_b;
-				bone->_b = c * a - s * bone->_d;
-				bone->_d = s * a + c * bone->_d;
+				a = bone->_transform[Bone::B];
+				bone->_transform[Bone::B] = c * a - s * bone->_transform[Bone::D];
+				bone->_transform[Bone::D] = s * a + c * bone->_transform[Bone::D];
 			}
 			r += o * _data._shearX;
 			s = MathUtil::sin(r);
 			c = MathUtil::cos(r);
-			a = bone->_a;
-			bone->_a = c * a - s * bone->_c;
-			bone->_c = s * a + c * bone->_c;
+			a = bone->_transform[Bone::A];
+			bone->_transform[Bone::A] = c * a - s * bone->_transform[Bone::C];
+			bone->_transform[Bone::C] = s * a + c * bone->_transform[Bone::C];
 		} else {
 			o *= _data._rotate;
 			s = MathUtil::sin(o);
 			c = MathUtil::cos(o);
-			a = bone->_a;
-			bone->_a = c * a - s * bone->_c;
-			bone->_c = s * a + c * bone->_c;
-			a = bone->_b;
-			bone->_b = c * a - s * bone->_d;
-			bone->_d = s * a + c * bone->_d;
+			a = bone->_transform[Bone::A];
+			bone->_transform[Bone::A] = c * a - s * bone->_transform[Bone::C];
+			bone->_transform[Bone::C] = s * a + c * bone->_transform[Bone::C];
+			a = bone->_transform[Bone::B];
+			bone->_transform[Bone::B] = c * a - s * bone->_transform[Bone::D];
+			bone->_transform[Bone::D] = s * a + c * bone->_transform[Bone::D];
 		}
 	}
 	if (scaleX) {
 		float s = 1 + _scaleOffset * mix * _data._scaleX;
-		bone->_a *= s;
-		bone->_c *= s;
+		bone->_transform[Bone::A] *= s;
+		bone->_transform[Bone::C] *= s;
 	}
 	if (physics != Physics::Physics_Pose) {
-		_tx = l * bone->_a;
-		_ty = l * bone->_c;
+		_tx = l * bone->_transform[Bone::A];
+		_ty = l * bone->_transform[Bone::C];
 	}
 	bone->updateAppliedTransform();
 }
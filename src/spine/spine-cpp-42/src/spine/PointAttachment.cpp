@@ -46,8 +46,8 @@ void PointAttachment::computeWorldPosition(Bone &bone, float &ox, float &oy) {
 
 float PointAttachment::computeWorldRotation(Bone &bone) {
 	float r = _rotation * MathUtil::Deg_Rad, cosine = MathUtil::cos(r), sine = MathUtil::sin(r);
-	float x = cosine * bone._a + sine * bone._b;
-	float y = cosine * bone._c + sine * bone._d;
+	float x = cosine * bone._transform[Bone::A] + sine * bone._transform[Bone::B];
+	float y = cosine * bone._transform[Bone::C] + sine * bone._transform[Bone::D];
 	return MathUtil::atan2Deg(y, x);
 }
 
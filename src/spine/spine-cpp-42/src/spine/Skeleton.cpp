@@ -51,25 +51,71 @@
 #include <spine/TransformConstraintData.h>
 #include <spine/SkeletonClipping.h>
 
+#include <spine/VertexSkinning.h>
 #include <spine/ContainerUtil.h>
 
 #include <float.h>
 
 using namespace spine;
 
-Skeleton::Skeleton(SkeletonData *skeletonData)
+/// Alignment of every object in the arena of a skeleton
+static const size_t ArenaAlignment = 16;
+
+/// Bytes count objects of size bytes take in the arena, each starting aligned
+static size_t getArenaSize(size_t size, size_t count) {
+	return (size + ArenaAlignment - 1) / ArenaAlignment * ArenaAlignment * count;
+}
+
+/// Takes size bytes from the arena, or allocates them on their own when the skeleton has no arena
+static void *takeFromArena(char *&arena, size_t size) {
+	if (!arena) return SpineExtension::calloc<char>(size, __FILE__, __LINE__);
+	void *object = arena;
+	arena += getArenaSize(size, 1);
+	return object;
+}
+
+/// Destroys the objects the arena holds, last first like ContainerUtil::cleanUpVectorOfPointers. With
+/// freeItems they were allocated on their own and are freed too.
+template<typename T>
+static void destroyInArena(Vector<T *> &items, bool freeItems) {
+	for (int i = (int) items.size() - 1; i >= 0; i--) {
+		items[i]->~T();
+		if (freeItems) SpineExtension::free(items[i], __FILE__, __LINE__);
+	}
+	items.clear();
+}
+
+Skeleton::Skeleton(SkeletonData *skeletonData, bool boneTransformBlock)
 	: _data(skeletonData), _skin(NULL), _color(1, 1, 1, 1), _scaleX(1),
 	  _scaleY(1), _x(0), _y(0), _time(0) {
+	// One allocation holds every bone with its world transform, slot and constraint. With
+	// boneTransformBlock the world transforms come first in one block, else each follows its bone
+	size_t transformSize = VertexSkinning::TransformStride * sizeof(float);
+	size_t arenaSize = getArenaSize(transformSize, _data->getBones().size()) +
+					   getArenaSize(sizeof(Bone), _data->getBones().size()) +
+					   getArenaSize(sizeof(Slot), _data->getSlots().size()) +
+					   getArenaSize(sizeof(IkConstraint), _data->getIkConstraints().size()) +
+					   getArenaSize(sizeof(TransformConstraint), _data->getTransformConstraints().size()) +
+					   getArenaSize(sizeof(PathConstraint), _data->getPathConstraints().size()) +
+					   getArenaSize(sizeof(PhysicsConstraint), _data->getPhysicsConstraints().size());
+	// Without the arena, empty or failing to allocate, every object is allocated on its own
+	_arena = arenaSize > 0 ? SpineExtension::calloc<char>(arenaSize, __FILE__, __LINE__) : NULL;
+	char *arena = _arena;
+	_boneTransforms = boneTransformBlock ? (float *) takeFromArena(arena, transformSize * _data->getBones().size()) : NULL;
+
 	_bones.ensureCapacity(_data->getBones().size());
 	for (size_t i = 0; i < _data->getBones().size(); ++i) {
 		BoneData *data = _data->getBones()[i];
 
+		void *memory = takeFromArena(arena, sizeof(Bone));
+		float *transform = _boneTransforms ? _boneTransforms + i * VertexSkinning::TransformStride : (float *) takeFromArena(arena, transformSize);
+
 		Bone *bone;
 		if (data->getParent() == NULL) {
-			bone = new (__FILE__, __LINE__) Bone(*data, *this, NULL);
+			bone = new (memory) Bone(*data, *this, NULL, transform);
 		} else {
 			Bone *parent = _bones[data->getParent()->getIndex()];
-			bone = new (__FILE__, __LINE__) Bone(*data, *this, parent);
+			bone = new (memory) Bone(*data, *this, parent, transform);
 			parent->getChildren().add(bone);
 		}
 
@@ -82,7 +128,7 @@ Skeleton::Skeleton(SkeletonData *skeletonData)
 		SlotData *data = _data->getSlots()[i];
 
 		Bone *bone = _bones[data->getBoneData().getIndex()];
-		Slot *slot = new (__FILE__, __LINE__) Slot(*data, *bone);
+		Slot *slot = new (takeFromArena(arena, sizeof(Slot))) Slot(*data, *bone);
 
 		_slots.add(slot);
 		_drawOrder.add(slot);
@@ -93,7 +139,7 @@ Skeleton::Skeleton(SkeletonData *skeletonData)
 		IkConstraintData *data = _data->getIkConstraints()[i];
 
 		IkConstraint *constraint =
-				new (__FILE__, __LINE__) IkConstraint(*data, *this);
+				new (takeFromArena(arena, sizeof(IkConstraint))) IkConstraint(*data, *this);
 
 		_ikConstraints.add(constraint);
 	}
@@ -103,7 +149,7 @@ Skeleton::Skeleton(SkeletonData *skeletonData)
 		TransformConstraintData *data = _data->getTransformConstraints()[i];
 
 		TransformConstraint *constraint =
-				new (__FILE__, __LINE__) TransformConstraint(*data, *this);
+				new (takeFromArena(arena, sizeof(TransformConstraint))) TransformConstraint(*data, *this);
 
 		_transformConstraints.add(constraint);
 	}
@@ -113,7 +159,7 @@ Skeleton::Skeleton(SkeletonData *skeletonData)
 		PathConstraintData *data = _data->getPathConstraints()[i];
 
 		PathConstraint *constraint =
-				new (__FILE__, __LINE__) PathConstraint(*data, *this);
+				new (takeFromArena(arena, sizeof(PathConstraint))) PathConstraint(*data, *this);
 
 		_pathConstraints.add(constraint);
 	}
@@ -123,7 +169,7 @@ Skeleton::Skeleton(SkeletonData *skeletonData)
 		PhysicsConstraintData *data = _data->getPhysicsConstraints()[i];
 
 		PhysicsConstraint *constraint =
-				new (__FILE__, __LINE__) PhysicsConstraint(*data, *this);
+				new (takeFromArena(arena, sizeof(PhysicsConstraint))) PhysicsConstraint(*data, *this);
 
 		_physicsConstraints.add(constraint);
 	}
@@ -132,12 +178,21 @@ Skeleton::Skeleton(SkeletonData *skeletonData)
 }
 
 Skeleton::~Skeleton() {
-	ContainerUtil::cleanUpVectorOfPointers(_bones);
-	ContainerUtil::cleanUpVectorOfPointers(_slots);
-	ContainerUtil::cleanUpVectorOfPointers(_ikConstraints);
-	ContainerUtil::cleanUpVectorOfPointers(_transformConstraints);
-	ContainerUtil::cleanUpVectorOfPointers(_pathConstraints);
-	ContainerUtil::cleanUpVectorOfPointers(_physicsConstraints);
+	if (!_arena) {
+		// Every object and world transform was allocated on its own
+		if (_boneTransforms) {
+			SpineExtension::free(_boneTransforms, __FILE__, __LINE__);
+		} else {
+			for (size_t i = 0; i < _bones.size(); ++i) SpineExtension::free(_bones[i]->_transform, __FILE__, __LINE__);
+		}
+	}
+	destroyInArena(_bones, !_arena);
+	destroyInArena(_slots, !_arena);
+	destroyInArena(_ikConstraints, !_arena);
+	destroyInArena(_transformConstraints, !_arena);
+	destroyInArena(_pathConstraints, !_arena);
+	destroyInArena(_physicsConstraints, !_arena);
+	if (_arena) SpineExtension::free(_arena, __FILE__, __LINE__);
 }
 
 void Skeleton::updateCache() {
@@ -256,9 +311,9 @@ void Skeleton::updateWorldTransform(Physics physics, Bone *parent) {
 	// Apply the parent bone transform to the root bone. The root bone always
 	// inherits scale, rotation and reflection.
 	Bone *rootBone = getRootBone();
-	float pa = parent->_a, pb = parent->_b, pc = parent->_c, pd = parent->_d;
-	rootBone->_worldX = pa * _x + pb * _y + parent->_worldX;
-	rootBone->_worldY = pc * _x + pd * _y + parent->_worldY;
+	float pa = parent->_transform[Bone::A], pb = parent->_transform[Bone::B], pc = parent->_transform[Bone::C], pd = parent->_transform[Bone::D];
+	rootBone->_transform[Bone::WorldX] = pa * _x + pb * _y + parent->_transform[Bone::WorldX];
+	rootBone->_transform[Bone::WorldY] = pc * _x + pd * _y + parent->_transform[Bone::WorldY];
 
 	float rx = (rootBone->_rotation + rootBone->_shearX) * MathUtil::Deg_Rad;
 	float ry = (rootBone->_rotation + 90 + rootBone->_shearY) * MathUtil::Deg_Rad;
@@ -266,10 +321,10 @@ void Skeleton::updateWorldTransform(Physics physics, Bone *parent) {
 	float lb = MathUtil::cos(ry) * rootBone->_scaleY;
 	float lc = MathUtil::sin(rx) * rootBone->_scaleX;
 	float ld = MathUtil::sin(ry) * rootBone->_scaleY;
-	rootBone->_a = (pa * la + pb * lc) * _scaleX;
-	rootBone->_b = (pa * lb + pb * ld) * _scaleX;
-	rootBone->_c = (pc * la + pd * lc) * _scaleY;
-	rootBone->_d = (pc * lb + pd * ld) * _scaleY;
+	rootBone->_transform[Bone::A] = (pa * la + pb * lc) * _scaleX;
+	rootBone->_transform[Bone::B] = (pa * lb + pb * ld) * _scaleX;
+	rootBone->_transform[Bone::C] = (pc * la + pd * lc) * _scaleY;
+	rootBone->_transform[Bone::D] = (pc * lb + pd * ld) * _scaleY;
 
 	// Update everything except root bone.
 	Bone *rb = getRootBone();
@@ -541,6 +596,8 @@ Bone *Skeleton::getRootBone() { return _bones.size() == 0 ? NULL : _bones[0]; }
 
 SkeletonData *Skeleton::getData() { return _data; }
 
+float *Skeleton::getBoneTransforms() { return _boneTransforms; }
+
 Vector<Bone *> &Skeleton::getBones() { return _bones; }
 
 Vector<Updatable *> &Skeleton::getUpdateCacheList() { return _updateCache; }
@@ -149,7 +149,7 @@ void TransformConstraint::applyAbsoluteWorld() {
 	float mixRotate = _mixRotate, mixX = _mixX, mixY = _mixY, mixScaleX = _mixScaleX, mixScaleY = _mixScaleY, mixShearY = _mixShearY;
 	bool translate = mixX != 0 || mixY != 0;
 	Bone &target = *_target;
-	float ta = target._a, tb = target._b, tc = target._c, td = target._d;
+	float ta = target._transform[Bone::A], tb = target._transform[Bone::B], tc = target._transform[Bone::C], td = target._transform[Bone::D];
 	float degRadReflect = ta * td - tb * tc > 0 ? MathUtil::Deg_Rad : -MathUtil::Deg_Rad;
 	float offsetRotation = _data._offsetRotation * degRadReflect, offsetShearY = _data._offsetShearY * degRadReflect;
 
@@ -158,7 +158,7 @@ void TransformConstraint::applyAbsoluteWorld() {
 		Bone &bone = *item;
 
 		if (mixRotate != 0) {
-			float a = bone._a, b = bone._b, c = bone._c, d = bone._d;
+			float a = bone._transform[Bone::A], b = bone._transform[Bone::B], c = bone._transform[Bone::C], d = bone._transform[Bone::D];
 			float r = MathUtil::atan2(tc, ta) - MathUtil::atan2(c, a) + offsetRotation;
 			if (r > MathUtil::Pi)
 				r -= MathUtil::Pi_2;
@@ -167,37 +167,37 @@ void TransformConstraint::applyAbsoluteWorld() {
 
 			r *= mixRotate;
 			float cos = MathUtil::cos(r), sin = MathUtil::sin(r);
-			bone._a = cos * a - sin * c;
-			bone._b = cos * b - sin * d;
-			bone._c = sin * a + cos * c;
-			bone._d = sin * b + cos * d;
+			bone._transform[Bone::A] = cos * a - sin * c;
+			bone._transform[Bone::B] = cos * b - sin * d;
+			bone._transform[Bone::C] = sin * a + cos * c;
+			bone._transform[Bone::D] = sin * b + cos * d;
 		}
 
 		if (translate) {
 			float tx, ty;
 			target.localToWorld(_data._offsetX, _data._offsetY, tx, ty);
-			bone._worldX += (tx - bone._worldX) * mixX;
-			bone._worldY += (ty - bone._worldY) * mixY;
+			bone._transform[Bone::WorldX] += (tx - bone._transform[Bone::WorldX]) * mixX;
+			bone._transform[Bone::WorldY] += (ty - bone._transform[Bone::WorldY]) * mixY;
 		}
 
 		if (mixScaleX > 0) {
-			float s = MathUtil::sqrt(bone._a * bone._a + bone._c * bone._c);
+			float s = MathUtil::sqrt(bone._transform[Bone::A] * bone._transform[Bone::A] + bone._transform[Bone::C] * bone._transform[Bone::C]);
 			if (s != 0) s = (s + (MathUtil::sqrt(ta * ta + tc * tc) - s + _data._offsetScaleX) * mixScaleX) / s;
-			bone._a *= s;
-			bone._c *= s;
+			bone._transform[Bone::A] *= s;
+			bone._transform[Bone::C] *= s;
 		}
 
 		if (mixScaleY > 0) {
-			float s = MathUtil::sqrt(bone._b * bone._b + bone._d * bone._d);
+			float s = MathUtil::sqrt(bone._transform[Bone::B] * bone._transform[Bone::B] + bone._transform[Bone::D] * bone._transform[Bone::D]);
 			if (s != 0) s = (s + (MathUtil::sqrt(tb * tb + td * td) - s + _data._offsetScaleY) * mixScaleY) / s;
-			bone._b *= s;
-			bone._d *= s;
+			bone._transform[Bone::B] *= s;
+			bone._transform[Bone::D] *= s;
 		}
 
 		if (mixShearY > 0) {
-			float b = bone._b, d = bone._d;
+			float b = bone._transform[Bone::B], d = bone._transform[Bone::D];
 			float by = MathUtil::atan2(d, b);
-			float r = MathUtil::atan2(td, tb) - MathUtil::atan2(tc, ta) - (by - MathUtil::atan2(bone._c, bone._a));
+			float r = MathUtil::atan2(td, tb) - MathUtil::atan2(tc, ta) - (by - MathUtil::atan2(bone._transform[Bone::C], bone._transform[Bone::A]));
 			if (r > MathUtil::Pi)
 				r -= MathUtil::Pi_2;
 			else if (r < -MathUtil::Pi)
@@ -205,8 +205,8 @@ void TransformConstraint::applyAbsoluteWorld() {
 
 			r = by + (r + offsetShearY) * mixShearY;
 			float s = MathUtil::sqrt(b * b + d * d);
-			bone._b = MathUtil::cos(r) * s;
-			bone._d = MathUtil::sin(r) * s;
+			bone._transform[Bone::B] = MathUtil::cos(r) * s;
+			bone._transform[Bone::D] = MathUtil::sin(r) * s;
 		}
 
 		bone.updateAppliedTransform();
@@ -217,7 +217,7 @@ void TransformConstraint::applyRelativeWorld() {
 	float mixRotate = _mixRotate, mixX = _mixX, mixY = _mixY, mixScaleX = _mixScaleX, mixScaleY = _mixScaleY, mixShearY = _mixShearY;
 	bool translate = mixX != 0 || mixY != 0;
 	Bone &target = *_target;
-	float ta = target._a, tb = target._b, tc = target._c, td = target._d;
+	float ta = target._transform[Bone::A], tb = target._transform[Bone::B], tc = target._transform[Bone::C], td = target._transform[Bone::D];
 	float degRadReflect = ta * td - tb * tc > 0 ? MathUtil::Deg_Rad : -MathUtil::Deg_Rad;
 	float offsetRotation = _data._offsetRotation * degRadReflect, offsetShearY = _data._offsetShearY * degRadReflect;
 	for (size_t i = 0; i < _bones.size(); ++i) {
@@ -225,7 +225,7 @@ void TransformConstraint::applyRelativeWorld() {
 		Bone &bone = *item;
 
 		if (mixRotate != 0) {
-			float a = bone._a, b = bone._b, c = bone._c, d = bone._d;
+			float a = bone._transform[Bone::A], b = bone._transform[Bone::B], c = bone._transform[Bone::C], d = bone._transform[Bone::D];
 			float r = MathUtil::atan2(tc, ta) + offsetRotation;
 			if (r > MathUtil::Pi)
 				r -= MathUtil::Pi_2;
@@ -234,28 +234,28 @@ void TransformConstraint::applyRelativeWorld() {
 
 			r *= mixRotate;
 			float cos = MathUtil::cos(r), sin = MathUtil::sin(r);
-			bone._a = cos * a - sin * c;
-			bone._b = cos * b - sin * d;
-			bone._c = sin * a + cos * c;
-			bone._d = sin * b + cos * d;
+			bone._transform[Bone::A] = cos * a - sin * c;
+			bone._transform[Bone::B] = cos * b - sin * d;
+			bone._transform[Bone::C] = sin * a + cos * c;
+			bone._transform[Bone::D] = sin * b + cos * d;
 		}
 
 		if (translate) {
 			float tx, ty;
 			target.localToWorld(_data._offsetX, _data._offsetY, tx, ty);
-			bone._worldX += tx * mixX;
-			bone._worldY += ty * mixY;
+			bone._transform[Bone::WorldX] += tx * mixX;
+			bone._transform[Bone::WorldY] += ty * mixY;
 		}
 
 		if (mixScaleX != 0) {
 			float s = (MathUtil::sqrt(ta * ta + tc * tc) - 1 + _data._offsetScaleX) * mixScaleX + 1;
-			bone._a *= s;
-			bone._c *= s;
+			bone._transform[Bone::A] *= s;
+			bone._transform[Bone::C] *= s;
 		}
 		if (mixScaleY != 0) {
 			float s = (MathUtil::sqrt(tb * tb + td * td) - 1 + _data._offsetScaleY) * mixScaleY + 1;
-			bone._b *= s;
-			bone._d *= s;
+			bone._transform[Bone::B] *= s;
+			bone._transform[Bone::D] *= s;
 		}
 
 		if (mixShearY > 0) {
@@ -265,11 +265,11 @@ void TransformConstraint::applyRelativeWorld() {
 			else if (r < -MathUtil::Pi)
 				r += MathUtil::Pi_2;
 
-			float b = bone._b, d = bone._d;
+			float b = bone._transform[Bone::B], d = bone._transform[Bone::D];
 			r = MathUtil::atan2(d, b) + (r - MathUtil::Pi / 2 + offsetShearY) * mixShearY;
 			float s = MathUtil::sqrt(b * b + d * d);
-			bone._b = MathUtil::cos(r) * s;
-			bone._d = MathUtil::sin(r) * s;
+			bone._transform[Bone::B] = MathUtil::cos(r) * s;
+			bone._transform[Bone::D] = MathUtil::sin(r) * s;
 		}
 
 		bone.updateAppliedTransform();
@@ -0,0 +1,113 @@
+#include "SpineAssetCache.h"
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include "spine-software.h"
+#if defined(SPINE_OPENGL)
+#include "spine-opengl.h"
+#endif
+
+using namespace spine;
+namespace fs = std::filesystem;
+
+namespace {
+    struct CacheKey {
+        void* shareGroup;
+        RenderBackend backend;
+        fs::path atlasPath;
+        fs::path skeletonPath;
+        auto operator<=>(const CacheKey&) const = default;
+    };
+
+    struct CacheEntry {
+        fs::file_time_type atlasTime;
+        fs::file_time_type skeletonTime;
+        std::weak_ptr<SpineAsset> asset;
+    };
+
+    std::mutex cacheMutex;
+    std::map<CacheKey, CacheEntry> cacheEntries;
+
+    fs::path utf8Path(const std::string& path) {
+        return fs::path(std::u8string(reinterpret_cast<const char8_t*>(path.data()), path.size()));
+    }
+}
+
+SpineAsset::~SpineAsset() {
+    if (skeletonData) delete skeletonData;
+    // The atlas unloads its textures through the loader, so the loader goes last
+    if (atlas) delete atlas;
+    if (textureLoader) delete textureLoader;
+}
+
+std::shared_ptr<SpineAsset> SpineAssetCache::acquire(const std::string& atlas_path, const std::string& skeleton_path, RenderBackend backend, void* share_group) {
+    std::shared_ptr<SpineAsset> asset = decode(atlas_path, skeleton_path, backend, share_group);
+    if (asset) upload(*asset);
+    return asset;
+}
+
+void SpineAssetCache::upload(SpineAsset& asset) {
+    std::call_once(asset.uploaded, [&asset] {
+        // Software textures are complete once decoded
+        if (auto* loader = dynamic_cast<DeferredTextureLoader*>(asset.textureLoader))
+            loader->upload(*asset.atlas);
+    });
+}
+
+std::shared_ptr<SpineAsset> SpineAssetCache::decode(const std::string& atlas_path, const std::string& skeleton_path, RenderBackend backend, void* share_group) {
+    if (!share_group) return load(atlas_path, skeleton_path, backend);
+
+    std::error_code ec;
+    CacheKey key = { share_group, backend, fs::weakly_canonical(utf8Path(atlas_path), ec), fs::weakly_canonical(utf8Path(skeleton_path), ec) };
+    fs::file_time_type atlasTime = fs::last_write_time(key.atlasPath, ec);
+    fs::file_time_type skeletonTime = fs::last_write_time(key.skeletonPath, ec);
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        for (auto it = cacheEntries.begin(); it != cacheEntries.end();) {
+            if (it->second.asset.expired()) it = cacheEntries.erase(it);
+            else it++;
+        }
+        auto it = cacheEntries.find(key);
+        if (it != cacheEntries.end() && it->second.atlasTime == atlasTime && it->second.skeletonTime == skeletonTime) {
+            if (auto asset = it->second.asset.lock()) return asset;
+        }
+    }
+
+    // Load without holding the lock, parsing and texture decoding take long
+    std::shared_ptr<SpineAsset> asset = load(atlas_path, skeleton_path, backend);
+    if (!asset) return nullptr;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    CacheEntry& entry = cacheEntries[key];
+    if (entry.atlasTime == atlasTime && entry.skeletonTime == skeletonTime) {
+        // Another runtime loaded the same files in the meantime
+        if (auto existing = entry.asset.lock()) return existing;
+    }
+    entry = { atlasTime, skeletonTime, asset };
+    return asset;
+}
+
+std::shared_ptr<SpineAsset> SpineAssetCache::load(const std::string& atlas_path, const std::string& skeleton_path, RenderBackend backend) {
+    auto asset = std::make_shared<SpineAsset>();
+    if (backend == RenderBackend::RB_Software) asset->textureLoader = new SoftwareTextureLoader();
+#if defined(SPINE_OPENGL)
+    else asset->textureLoader = new DeferredGlTextureLoader();
+#else
+    // Built without OpenGL, nothing could draw the asset
+    else return nullptr;
+#endif
+    asset->atlas = new Atlas(atlas_path.c_str(), asset->textureLoader);
+    if (skeleton_path.ends_with(".json")) {
+        SkeletonJson json(asset->atlas);
+        asset->skeletonData = json.readSkeletonDataFile(skeleton_path.c_str());
+    } else if (skeleton_path.ends_with(".skel")) {
+        SkeletonBinary binary(asset->atlas);
+        asset->skeletonData = binary.readSkeletonDataFile(skeleton_path.c_str());
+    }
+    if (asset->skeletonData == nullptr) return nullptr;
+    // The pages decoded on the pool while the skeleton was parsed, decode() must return with
+    // nothing but the upload left
+    if (auto* loader = dynamic_cast<DeferredTextureLoader*>(asset->textureLoader)) loader->wait();
+    return asset;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <spine/spine.h>
+#include "ISpineRuntime.h"
+
+/// Atlas and skeleton data loaded from one pair of asset files. Both stay unchanged once
+/// loaded, so every runtime showing the asset uses the same instance with its own Skeleton
+/// and AnimationState. The atlas textures are created separately by SpineAssetCache::upload.
+struct SpineAsset {
+    spine::TextureLoader* textureLoader = nullptr;
+    spine::Atlas* atlas = nullptr;
+    spine::SkeletonData* skeletonData = nullptr;
+    std::once_flag uploaded;
+    ~SpineAsset();
+};
+
+/// Process-wide cache of loaded assets, keyed by share group, render backend, canonical file
+/// paths and modification times. The cache only holds weak references, so an asset is freed
+/// as soon as the last runtime using it drops its shared_ptr.
+class SpineAssetCache {
+public:
+    /// Returns the asset for the given UTF-8 paths, loading it on first use or when one of the
+    /// files changed on disk, nullptr if the skeleton data could not be loaded. Assets are only
+    /// shared within the same non-null share group, a null group always loads a private copy.
+    static std::shared_ptr<SpineAsset> acquire(const std::string& atlas_path, const std::string& skeleton_path, RenderBackend backend, void* share_group);
+
+    /// Same as acquire, but only parses the files and decodes the atlas pages without making any
+    /// OpenGL call, so it may run on any thread. upload() must be called before drawing the asset.
+    static std::shared_ptr<SpineAsset> decode(const std::string& atlas_path, const std::string& skeleton_path, RenderBackend backend, void* share_group);
+
+    /// Creates the textures of a decoded asset once, on the calling thread, which needs a current
+    /// OpenGL context in the asset's share group for RB_OpenGL
+    static void upload(SpineAsset& asset);
+
+private:
+    static std::shared_ptr<SpineAsset> load(const std::string& atlas_path, const std::string& skeleton_path, RenderBackend backend);
+};
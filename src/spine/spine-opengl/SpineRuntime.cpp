@@ -1,26 +1,95 @@
 #include "ISpineRuntime.h"
+#include "SpineAssetCache.h"
+#include "spine-alloc.h"
+#include "spine-bounds.h"
+#include "spine-pose.h"
+#include "spine-software.h"
+#if defined(SPINE_OPENGL)
 #include "spine-opengl.h"
+#endif
 
 using namespace spine;
 
+#if defined(_WIN32)
+#define SPINE_RUNTIME_API __declspec(dllexport)
+#else
+#define SPINE_RUNTIME_API __attribute__((visibility("default")))
+#endif
+
+/// Phases of update() and draw() timed by a runtime
+enum Phase {
+    Phase_StateUpdate, 
+    Phase_StateApply, 
+    Phase_WorldTransform, 
+    Phase_Fingerprint, 
+    Phase_Render, 
+    Phase_Pack, 
+    Phase_Submit, 
+    Phase_Count
+};
+
+static const char* const phaseNames[Phase_Count] = {
+    "AnimationState::update", 
+    "AnimationState::apply", 
+    "Skeleton::updateWorldTransform", 
+    "pose fingerprint", 
+    "SkeletonRenderer::render", 
+    "vertex packing", 
+    "submit"
+};
+
+/// Seconds between the poses measured for bounds, a frame at 60 fps
+static const float boundsStep = 1.0f / 60.0f;
+
+/// Skins an overlay picks from: every skin but the default one, which often holds nothing when
+/// others exist, or the default skin if it is the only one
+static std::vector<std::string> getOverlaySkins(SkeletonData* skeletonData) {
+    std::vector<std::string> skinNames;
+    auto skins = skeletonData->getSkins();
+    auto default_skin = skeletonData->getDefaultSkin(); 
+    if (skins.size() <= 1) skinNames.push_back(default_skin->getName().buffer()); 
+    else 
+        for (size_t i = 0; i < skins.size(); ++i)
+            if (skins[i] != default_skin)
+                skinNames.push_back(skins[i]->getName().buffer());
+    return skinNames;
+}
+
 class SpineRuntime : public ISpineRuntime {
 public:
     SpineRuntime() {
         // Constructor implementation
+        dirty_tracker_reset(&dirtyTracker, 0, 0, 1.0f);
+    }
+
+    void setRenderBackend(RenderBackend backend) override {
+        // Select the texture type loaded by init and the renderer used by createRenderer and draw
+        renderBackend = backend;
+    }
+
+    void setShareGroup(void* group) override {
+        // Select which runtimes init may share the loaded asset with
+        shareGroup = group;
+    }
+
+    bool preload(const std::string& atlas_path, const std::string& skeleton_path) override {
+        // Load everything init needs except the textures, which need the GL context
+        asset = SpineAssetCache::decode(atlas_path, skeleton_path, renderBackend, shareGroup);
+        preloadedAtlasPath = atlas_path;
+        preloadedSkeletonPath = skeleton_path;
+        return asset != nullptr;
     }
 
     bool init(const std::string& atlas_path, const std::string& skeleton_path) override {
         // Initialize the spine runtime with the provided atlas and skeleton paths
-        atlas = new Atlas(atlas_path.c_str(), &textureLoader);
-        if (skeleton_path.ends_with(".json")) {
-            SkeletonJson json(atlas);
-            skeletonData = json.readSkeletonDataFile(skeleton_path.c_str());
-        } else if (skeleton_path.ends_with(".skel")) {
-            SkeletonBinary binary(atlas);
-            skeletonData = binary.readSkeletonDataFile(skeleton_path.c_str());
-        }
-        if (skeletonData == nullptr) return false;
-        skeleton = new Skeleton(skeletonData);
+        if (asset && atlas_path == preloadedAtlasPath && skeleton_path == preloadedSkeletonPath)
+            SpineAssetCache::upload(*asset);
+        else
+            asset = SpineAssetCache::acquire(atlas_path, skeleton_path, renderBackend, shareGroup);
+        if (!asset) return false;
+        skeletonData = asset->skeletonData;
+        // The bone transforms in one block that skinning, clipping and bounds read in order
+        skeleton = new Skeleton(skeletonData, true);
         stateData = new AnimationStateData(skeletonData);
         state = new AnimationState(stateData);
         return true; 
@@ -28,15 +97,7 @@ public:
 
     std::vector<std::string> getAllSkins() override {
         // Return all skin names from the skeleton data
-        std::vector<std::string> skinNames;
-        auto skins = skeletonData->getSkins();
-        auto default_skin = skeletonData->getDefaultSkin(); 
-        if (skins.size() <= 1) skinNames.push_back(default_skin->getName().buffer()); 
-        else 
-            for (size_t i = 0; i < skins.size(); ++i)
-                if (skins[i] != default_skin)
-                    skinNames.push_back(skins[i]->getName().buffer());
-        return skinNames;
+        return getOverlaySkins(skeletonData);
     }
 
     std::map<std::string, float> getAllAnimations() override {
@@ -48,25 +109,25 @@ public:
         return animationNames;
     }
 
-    Bounds getBounds() override {
-        float l = 0.0, r = 0.0, b = 0.0, t = 0.0; 
-        float x, y, w, h; 
-        Vector<float> vertices;
-        Vector<Animation*> animations = skeletonData->getAnimations();
-        for (size_t i = 0; i < animations.size(); i++) {
-            setAnimation(animations[i]->getName().buffer());
-            setPosition(0, 0);
-            setScale(1.0f);
-            while (!state->getCurrent(0)->isComplete()) {
-                update(0.04f); 
-                skeleton->getBounds(x, y, w, h, vertices);
-                l = std::min(l, x);
-                r = std::max(r, w + x);
-                b = std::min(b, y);
-                t = std::max(t, h + y);
-            }
-        }
-        return { l, b, r - l, t - b };
+    Bounds getAnimationBounds(const std::string& animation_name) override {
+        // Measure the animation on a skeleton of its own the first time it is asked for
+        auto it = animationBounds.find(animation_name);
+        if (it != animationBounds.end()) return it->second;
+        Bounds bounds = { 0.0f, 0.0f, 0.0f, 0.0f };
+        Animation* animation = skeletonData->findAnimation(String(animation_name.c_str()));
+        if (animation) bounds = skeleton_data_measure_animation(skeletonData, animation, getOverlaySkins(skeletonData), boundsStep);
+        animationBounds[animation_name] = bounds;
+        return bounds;
+    }
+
+    bool measureBounds(const std::string& atlas_path, const std::string& skeleton_path, std::map<std::string, Bounds>& animation_bounds) override {
+        // Measure a private copy of the skeleton, the pages are not needed for that
+        Atlas* atlas = nullptr;
+        SkeletonData* data = skeleton_data_load_unpaged(atlas_path.c_str(), skeleton_path.c_str(), &atlas);
+        if (!data) return false;
+        animation_bounds = skeleton_data_measure(data, getOverlaySkins(data), boundsStep);
+        skeleton_data_dispose_unpaged(data, atlas);
+        return true;
     }
 
     void setDefaultMix(float mix) override {
@@ -98,48 +159,154 @@ public:
 
     void createRenderer() override {
         // Create the renderer for rendering spine objects
-        renderer = renderer_create(); 
+        render_stats_t stats = { &phases[Phase_Render], &phases[Phase_Pack], &phases[Phase_Submit] };
+        if (renderBackend == RenderBackend::RB_Software) {
+            softwareRenderer = software_renderer_create();
+            softwareRenderer->stats = stats;
+        } else {
+#if defined(SPINE_OPENGL)
+            renderer = renderer_create(); 
+            if (renderer) renderer->stats = stats;
+#endif
+        }
     }
 
     void setViewportSize(int width, int height, float scale) override {
         // Set the viewport size for rendering
-        renderer_set_viewport_size(renderer, width, height, scale);
+        dirty_tracker_reset(&dirtyTracker, width, height, scale);
+        dirtyRect = { 0, 0, 0, 0 };
+        drawnPoseValid = false;
+        prepared = false;
+        if (softwareRenderer) software_renderer_set_viewport_size(softwareRenderer, width, height, scale);
+#if defined(SPINE_OPENGL)
+        else renderer_set_viewport_size(renderer, width, height, scale);
+#endif
     }
 
     void update(float delta_time) override {
         // Update the spine runtime with the elapsed time
-        state->update(delta_time);
-        state->apply(*skeleton);
+        prepared = false;
+        {
+            ScopedPhaseTimer timer(&phases[Phase_StateUpdate]);
+            state->update(delta_time);
+        }
+        {
+            ScopedPhaseTimer timer(&phases[Phase_StateApply]);
+            state->apply(*skeleton);
+        }
 #if defined(SPINE37) || defined(SPINE38) || defined(SPINE40) || defined(SPINE42)
         skeleton->update(delta_time); 
 #elif defined(SPINE41)
 #endif
+        {
+            ScopedPhaseTimer timer(&phases[Phase_WorldTransform]);
 #if defined(SPINE37) || defined(SPINE38) || defined(SPINE40) || defined(SPINE41)
-        skeleton->updateWorldTransform();
+            skeleton->updateWorldTransform();
 #elif defined(SPINE42)
-        skeleton->updateWorldTransform(Physics_Update);
+            skeleton->updateWorldTransform(Physics_Update);
 #endif
+        }
+        ScopedPhaseTimer timer(&phases[Phase_Fingerprint]);
+        pose = pose_fingerprint(skeleton);
     }
 
     void draw(bool pma) override {
         // Draw the spine objects with optional premultiplied alpha
-        renderer_draw(renderer, skeleton, pma);
+        if (!prepared || preparedPma != pma) prepare(pma);
+        prepared = false;
+        if (softwareRenderer) {
+            dirtyRect = dirty_tracker_update(&dirtyTracker, &softwareRenderer->bounds);
+        } else {
+#if defined(SPINE_OPENGL)
+            renderer_submit(renderer, pma);
+            dirtyRect = dirty_tracker_update(&dirtyTracker, &renderer->frame.bounds);
+#endif
+        }
+        drawnPose = pose;
+        drawnPoseValid = true;
+    }
+
+    void prepare(bool pma) override {
+        // Build the frame of the current pose without touching OpenGL
+        if (softwareRenderer) {
+            software_renderer_clear(softwareRenderer);
+            software_renderer_draw(softwareRenderer, skeleton, pma);
+        } else {
+#if defined(SPINE_OPENGL)
+            renderer_prepare(renderer, skeleton);
+#endif
+        }
+        prepared = true;
+        preparedPma = pma;
+    }
+
+    bool hasChanged() override {
+        // Compare the fingerprint of the updated pose with the drawn one
+        return !drawnPoseValid || pose != drawnPose;
+    }
+
+    PixelRect getDirtyRect() override {
+        // Return the pixels changed by the last draw
+        return { dirtyRect.x, dirtyRect.y, dirtyRect.width, dirtyRect.height };
+    }
+
+    float getMotion() override {
+        // Return how far the drawn content moved in the last draw
+        return dirtyTracker.motion;
+    }
+
+    const unsigned char* getPixels() override {
+        // Return the target buffer of the software renderer
+        return softwareRenderer ? softwareRenderer->pixels : nullptr;
+    }
+
+    void setPixelTarget(unsigned char* pixels, bool bgra) override {
+        // Point the software renderer at the caller's buffer
+        prepared = false;
+        if (softwareRenderer) software_renderer_set_target(softwareRenderer, pixels, bgra);
+    }
+
+    std::vector<PhaseStats> getStats() override {
+        // Summarize the phase histograms of this runtime
+        std::vector<PhaseStats> stats;
+        for (int i = 0; i < Phase_Count; i++)
+            stats.push_back(phases[i].getStats(phaseNames[i]));
+        return stats;
+    }
+
+    void resetStats() override {
+        // Drop all samples collected so far
+        for (int i = 0; i < Phase_Count; i++) phases[i].reset();
+    }
+
+    std::vector<AllocationSite> getAllocationSites(size_t count) override {
+        // Counted by the extension of this library, not per runtime
+        return spine_allocation_sites(count);
+    }
+
+    void resetAllocationSites() override {
+        spine_allocation_sites_reset();
     }
 
     void dispose() override {
         // Dispose of resources used by the spine runtime
+#if defined(SPINE_OPENGL)
         if (renderer) renderer_dispose(renderer);
+        renderer = nullptr;
+#endif
+        if (softwareRenderer) software_renderer_dispose(softwareRenderer);
         if (state) delete state;
         if (stateData) delete stateData;
         if (skeleton) delete skeleton;
-        if (skeletonData) delete skeletonData;
-        if (atlas) delete atlas;
-        renderer = nullptr;
+        asset.reset();
+        softwareRenderer = nullptr;
         state = nullptr;
         stateData = nullptr;
         skeleton = nullptr;
         skeletonData = nullptr;
-        atlas = nullptr;
+        animationBounds.clear();
+        drawnPoseValid = false;
+        prepared = false;
     }
 
     ~SpineRuntime() override {
@@ -148,33 +315,48 @@ public:
     }
 
 private:
-    GlTextureLoader textureLoader;
-    Atlas* atlas = nullptr;
+    RenderBackend renderBackend = RenderBackend::RB_OpenGL;
+    void* shareGroup = nullptr;
+    std::shared_ptr<SpineAsset> asset;
+    std::string preloadedAtlasPath;
+    std::string preloadedSkeletonPath;
     SkeletonData* skeletonData = nullptr;
+    std::map<std::string, Bounds> animationBounds; // measured so far by getAnimationBounds
     Skeleton* skeleton = nullptr;
     AnimationStateData* stateData = nullptr;
     AnimationState* state = nullptr;
+#if defined(SPINE_OPENGL)
     renderer_t* renderer = nullptr;
+#endif
+    software_renderer_t* softwareRenderer = nullptr;
+    dirty_tracker_t dirtyTracker;
+    pixel_rect_t dirtyRect = { 0, 0, 0, 0 };
+    uint64_t pose = 0;
+    uint64_t drawnPose = 0;
+    bool drawnPoseValid = false;
+    bool prepared = false;
+    bool preparedPma = false;
+    PhaseHistogram phases[Phase_Count];
 };
 
 #if defined(SPINE37)
-extern "C" __declspec(dllexport) ISpineRuntime* createSpineRuntime37() {
+extern "C" SPINE_RUNTIME_API ISpineRuntime* createSpineRuntime37() {
     return new SpineRuntime();
 }
 #elif defined(SPINE38)
-extern "C" __declspec(dllexport) ISpineRuntime* createSpineRuntime38() {
+extern "C" SPINE_RUNTIME_API ISpineRuntime* createSpineRuntime38() {
     return new SpineRuntime();
 }
 #elif defined(SPINE40)
-extern "C" __declspec(dllexport) ISpineRuntime* createSpineRuntime40() {
+extern "C" SPINE_RUNTIME_API ISpineRuntime* createSpineRuntime40() {
     return new SpineRuntime();
 }
 #elif defined(SPINE41)
-extern "C" __declspec(dllexport) ISpineRuntime* createSpineRuntime41() {
+extern "C" SPINE_RUNTIME_API ISpineRuntime* createSpineRuntime41() {
     return new SpineRuntime();
 }
 #elif defined(SPINE42)
-extern "C" __declspec(dllexport) ISpineRuntime* createSpineRuntime42() {
+extern "C" SPINE_RUNTIME_API ISpineRuntime* createSpineRuntime42() {
     return new SpineRuntime();
 }
 #endif
@@ -0,0 +1,389 @@
+#include "spine-alloc.h"
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+using namespace spine;
+
+/// Payload sizes of the size classes, a quarter apart above 64 bytes so a block wastes at most a fifth
+static const uint32_t classSizes[] = {
+    16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512,
+    640, 768, 896, 1024, 1280, 1536, 1792, 2048, 2560, 3072, 3584, 4096 };
+static const int classCount = sizeof(classSizes) / sizeof(classSizes[0]);
+static const size_t maxClassSize = 4096;
+/// Size class of blocks from the C heap
+static const uint32_t largeClass = 0xffffffff;
+/// Blocks of a class are carved from chunks of this size
+static const size_t chunkSize = 64 * 1024;
+/// Blocks a thread trades with the shared free list of a class at once
+static const int maxBatch = 64;
+/// Call sites counted separately, later ones are counted as one "other" site
+static const uint32_t maxSites = 4096;
+
+/// Precedes the payload of every block and keeps it 16-byte aligned
+typedef struct {
+    uint32_t size_class;
+    uint32_t site; // 0 if not counted
+    uint64_t size; // requested
+} block_header_t;
+static_assert(sizeof(block_header_t) == 16, "payloads must stay 16-byte aligned");
+
+/// A free block of a size class, linked through its header
+typedef struct free_block_t {
+    struct free_block_t* next;
+} free_block_t;
+
+/// Size class of a payload size up to maxClassSize, indexed by the size in 16-byte units rounded up
+typedef struct class_table_t {
+    uint8_t classes[maxClassSize / 16 + 1] = {};
+    int batches[classCount] = {};
+
+    constexpr class_table_t() {
+        int sizeClass = 0;
+        for (size_t units = 0; units <= maxClassSize / 16; units++) {
+            while (classSizes[sizeClass] < units * 16) sizeClass++;
+            classes[units] = (uint8_t) sizeClass;
+        }
+        // About 16 KiB per batch, so threads trade small blocks less often than big ones
+        for (int i = 0; i < classCount; i++)
+            batches[i] = std::clamp((int) (16 * 1024 / (sizeof(block_header_t) + classSizes[i])), 4, maxBatch);
+    }
+} class_table_t;
+static constexpr class_table_t classTable;
+
+static int size_class_of(size_t size) {
+    return classTable.classes[(size + 15) >> 4];
+}
+
+size_t spine_pool_block_size(size_t size) {
+    return size > maxClassSize ? size : classSizes[size_class_of(size)];
+}
+
+/// Free blocks of a class shared by all threads
+typedef struct {
+    std::mutex mutex;
+    free_block_t* head = nullptr;
+} central_list_t;
+
+/// Never destroyed, blocks may still be freed by threads exiting after static destructors ran
+static central_list_t* central_lists() {
+    static central_list_t* lists = new central_list_t[classCount];
+    return lists;
+}
+
+/// Takes up to batch free blocks of the class from its shared list, carving a new chunk if it is empty
+static free_block_t* central_take(int sizeClass, int batch, int* count) {
+    central_list_t& list = central_lists()[sizeClass];
+    size_t stride = sizeof(block_header_t) + classSizes[sizeClass];
+    std::lock_guard<std::mutex> lock(list.mutex);
+    if (!list.head) {
+        size_t blocks = std::max(chunkSize / stride, (size_t) classTable.batches[sizeClass]);
+        char* chunk = (char*) malloc(blocks * stride);
+        if (!chunk) return nullptr;
+        for (size_t i = 0; i < blocks; i++)
+            ((free_block_t*) (chunk + i * stride))->next = i + 1 < blocks ? (free_block_t*) (chunk + (i + 1) * stride) : nullptr;
+        list.head = (free_block_t*) chunk;
+    }
+    free_block_t* first = list.head;
+    free_block_t* last = first;
+    *count = 1;
+    while (*count < batch && last->next) {
+        last = last->next;
+        (*count)++;
+    }
+    list.head = last->next;
+    last->next = nullptr;
+    return first;
+}
+
+/// Gives the linked blocks from first to last back to the shared list of their class
+static void central_give(int sizeClass, free_block_t* first, free_block_t* last) {
+    central_list_t& list = central_lists()[sizeClass];
+    std::lock_guard<std::mutex> lock(list.mutex);
+    last->next = list.head;
+    list.head = first;
+}
+
+/// Free blocks a thread keeps per class. Trivially destructible, so frees of an exiting thread
+/// still find it after thread_cache_flusher_t gave its blocks back.
+typedef struct {
+    free_block_t* heads[classCount];
+    int counts[classCount];
+    bool registered; // with the flusher of the thread
+    bool exited; // the flusher ran, blocks go straight to the shared lists
+} thread_cache_t;
+static thread_local thread_cache_t threadCache;
+
+/// Gives the blocks the thread cached back to the shared lists when the thread exits
+typedef struct thread_cache_flusher_t {
+    ~thread_cache_flusher_t() {
+        for (int i = 0; i < classCount; i++) {
+            free_block_t* first = threadCache.heads[i];
+            if (!first) continue;
+            free_block_t* last = first;
+            while (last->next) last = last->next;
+            central_give(i, first, last);
+            threadCache.heads[i] = nullptr;
+            threadCache.counts[i] = 0;
+        }
+        threadCache.exited = true;
+    }
+} thread_cache_flusher_t;
+static thread_local thread_cache_flusher_t threadCacheFlusher;
+
+static thread_cache_t& thread_cache() {
+    thread_cache_t& cache = threadCache;
+    if (!cache.registered) {
+        // Touching the flusher constructs it, so it runs when this thread exits
+        cache.registered = true;
+        (void) &threadCacheFlusher;
+    }
+    return cache;
+}
+
+static block_header_t* block_alloc(size_t size) {
+    if (size > maxClassSize) {
+        block_header_t* header = (block_header_t*) malloc(sizeof(block_header_t) + size);
+        if (header) header->size_class = largeClass;
+        return header;
+    }
+    int sizeClass = size_class_of(size);
+    thread_cache_t& cache = thread_cache();
+    free_block_t* block;
+    if (cache.exited) {
+        // Nothing would give a cached batch back any more, take a single block
+        int count;
+        block = central_take(sizeClass, 1, &count);
+        if (!block) return nullptr;
+    } else {
+        if (!cache.heads[sizeClass]) {
+            cache.heads[sizeClass] = central_take(sizeClass, classTable.batches[sizeClass], &cache.counts[sizeClass]);
+            if (!cache.heads[sizeClass]) return nullptr;
+        }
+        block = cache.heads[sizeClass];
+        cache.heads[sizeClass] = block->next;
+        cache.counts[sizeClass]--;
+    }
+    block_header_t* header = (block_header_t*) block;
+    header->size_class = (uint32_t) sizeClass;
+    return header;
+}
+
+static void block_free(block_header_t* header) {
+    if (header->size_class == largeClass) {
+        free(header);
+        return;
+    }
+    int sizeClass = (int) header->size_class;
+    free_block_t* block = (free_block_t*) header;
+    thread_cache_t& cache = thread_cache();
+    if (cache.exited) {
+        block->next = nullptr;
+        central_give(sizeClass, block, block);
+        return;
+    }
+    block->next = cache.heads[sizeClass];
+    cache.heads[sizeClass] = block;
+    // A thread freeing what others allocated gives a batch back once it caches two
+    int batch = classTable.batches[sizeClass];
+    if (++cache.counts[sizeClass] > 2 * batch) {
+        free_block_t* last = block;
+        for (int i = 1; i < batch; i++) last = last->next;
+        cache.heads[sizeClass] = last->next;
+        cache.counts[sizeClass] -= batch;
+        central_give(sizeClass, block, last);
+    }
+}
+
+/// Counts of one call site, updated by every thread
+typedef struct {
+    const char* file;
+    int line;
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> reallocations;
+    std::atomic<uint64_t> frees;
+    std::atomic<uint64_t> bytes;
+    std::atomic<int64_t> live_bytes;
+} site_counters_t;
+
+/// Call sites by the file pointer and line the runtime passes, site 1 counts the ones past maxSites
+typedef struct {
+    std::mutex mutex;
+    std::map<std::pair<const char*, int>, uint32_t> indices;
+    std::atomic<uint32_t> count{2};
+    site_counters_t sites[maxSites];
+} site_registry_t;
+
+static site_registry_t& site_registry() {
+    static site_registry_t* registry = [] {
+        site_registry_t* registry = new site_registry_t();
+        registry->sites[1].file = "other";
+        return registry;
+    }();
+    return *registry;
+}
+
+/// Sites a thread looked up lately, so the registry is only locked for new ones
+typedef struct {
+    const char* file;
+    int line;
+    uint32_t site;
+} site_cache_entry_t;
+static thread_local site_cache_entry_t siteCache[256];
+
+static uint32_t site_of(const char* file, int line) {
+    site_cache_entry_t& entry = siteCache[(((uintptr_t) file >> 4) ^ ((uint32_t) line * 2654435761u)) & 255];
+    if (entry.site && entry.file == file && entry.line == line) return entry.site;
+    site_registry_t& registry = site_registry();
+    uint32_t site;
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        auto it = registry.indices.find(std::make_pair(file, line));
+        if (it != registry.indices.end()) {
+            site = it->second;
+        } else if (registry.count < maxSites) {
+            site = registry.count;
+            registry.sites[site].file = file ? file : "unknown";
+            registry.sites[site].line = line;
+            registry.indices[std::make_pair(file, line)] = site;
+            registry.count++;
+        } else {
+            site = 1;
+        }
+    }
+    entry.file = file;
+    entry.line = line;
+    entry.site = site;
+    return site;
+}
+
+static void count_allocation(block_header_t* header, size_t size, const char* file, int line, bool reallocation) {
+    header->site = site_of(file, line);
+    site_counters_t& site = site_registry().sites[header->site];
+    (reallocation ? site.reallocations : site.allocations).fetch_add(1, std::memory_order_relaxed);
+    site.bytes.fetch_add(size, std::memory_order_relaxed);
+    site.live_bytes.fetch_add((int64_t) size, std::memory_order_relaxed);
+}
+
+static void count_free(block_header_t* header, bool reallocation) {
+    if (!header->site) return;
+    site_counters_t& site = site_registry().sites[header->site];
+    // A reallocated block moves to the reallocating site, it is not freed
+    if (!reallocation) site.frees.fetch_add(1, std::memory_order_relaxed);
+    site.live_bytes.fetch_sub((int64_t) header->size, std::memory_order_relaxed);
+}
+
+void *PooledSpineExtension::_alloc(size_t size, const char *file, int line) {
+    block_header_t* header = block_alloc(size);
+    if (!header) return nullptr;
+    header->size = size;
+    header->site = 0;
+    if (countSites) count_allocation(header, size, file, line, false);
+    return header + 1;
+}
+
+void *PooledSpineExtension::_calloc(size_t size, const char *file, int line) {
+    void* mem = _alloc(size, file, line);
+    if (mem) memset(mem, 0, size);
+    return mem;
+}
+
+void *PooledSpineExtension::_realloc(void *ptr, size_t size, const char *file, int line) {
+    if (!ptr) return _alloc(size, file, line);
+    block_header_t* header = (block_header_t*) ptr - 1;
+    if (header->size_class == largeClass && size > maxClassSize) {
+        header = (block_header_t*) ::realloc(header, sizeof(block_header_t) + size);
+        if (!header) return nullptr;
+    } else if (header->size_class == largeClass || size > maxClassSize || (int) header->size_class != size_class_of(size)) {
+        block_header_t* moved = block_alloc(size);
+        if (!moved) return nullptr;
+        memcpy(moved + 1, header + 1, std::min((size_t) header->size, size));
+        moved->size = header->size;
+        moved->site = header->site;
+        block_free(header);
+        header = moved;
+    }
+    count_free(header, true);
+    header->size = size;
+    header->site = 0;
+    if (countSites) count_allocation(header, size, file, line, true);
+    return header + 1;
+}
+
+void PooledSpineExtension::_free(void *mem, const char *file, int line) {
+    (void) file;
+    (void) line;
+    if (!mem || releaseMapping(mem)) return;
+    block_header_t* header = (block_header_t*) mem - 1;
+    count_free(header, false);
+    block_free(header);
+}
+
+/// Set once the extension of this library counts call sites
+static std::atomic<bool> sitesCounted = false;
+
+/// Set the default extension used for memory allocations and file I/O, the allocator is chosen by
+/// SPINE_ALLOCATOR_VARIABLE
+SpineExtension *spine::getDefaultExtension() {
+    return spine_extension_create();
+}
+
+SpineExtension* spine_extension_create() {
+    const char* allocator = getenv(SPINE_ALLOCATOR_VARIABLE);
+    if (allocator && !strcmp(allocator, "pool")) return new PooledSpineExtension(false);
+    if (allocator && !strcmp(allocator, "pool-stats")) {
+        sitesCounted = true;
+        return new PooledSpineExtension(true);
+    }
+    return new Utf8SpineExtension();
+}
+
+std::vector<AllocationSite> spine_allocation_sites(size_t count) {
+    site_registry_t& registry = site_registry();
+    // The runtime passes __FILE__, which may be a different pointer in every translation unit
+    std::map<std::pair<std::string, int>, AllocationSite> merged;
+    uint32_t sites = registry.count;
+    for (uint32_t i = 1; i < sites; i++) {
+        const site_counters_t& counters = registry.sites[i];
+        if (!counters.file) continue;
+        std::string file = counters.file;
+        size_t slash = file.find_last_of("/\\");
+        if (slash != std::string::npos) file = file.substr(slash + 1);
+        AllocationSite& site = merged.try_emplace(std::make_pair(file, counters.line), AllocationSite{ file, counters.line, 0, 0, 0, 0, 0 }).first->second;
+        site.allocations += counters.allocations.load(std::memory_order_relaxed);
+        site.reallocations += counters.reallocations.load(std::memory_order_relaxed);
+        site.frees += counters.frees.load(std::memory_order_relaxed);
+        site.bytes += counters.bytes.load(std::memory_order_relaxed);
+        site.liveBytes += counters.live_bytes.load(std::memory_order_relaxed);
+    }
+    std::vector<AllocationSite> result;
+    for (auto& entry : merged)
+        if (entry.second.allocations + entry.second.reallocations > 0) result.push_back(entry.second);
+    std::sort(result.begin(), result.end(), [](const AllocationSite& a, const AllocationSite& b) {
+        return a.allocations + a.reallocations > b.allocations + b.reallocations;
+    });
+    if (result.size() > count) result.resize(count);
+    return result;
+}
+
+bool spine_allocation_sites_counted() {
+    return sitesCounted;
+}
+
+void spine_allocation_sites_reset() {
+    site_registry_t& registry = site_registry();
+    uint32_t sites = registry.count;
+    for (uint32_t i = 1; i < sites; i++) {
+        site_counters_t& counters = registry.sites[i];
+        counters.allocations.store(0, std::memory_order_relaxed);
+        counters.reallocations.store(0, std::memory_order_relaxed);
+        counters.frees.store(0, std::memory_order_relaxed);
+        counters.bytes.store(0, std::memory_order_relaxed);
+    }
+}
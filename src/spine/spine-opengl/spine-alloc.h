@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+#include <spine/spine.h>
+#include "ISpineRuntime.h"
+#include "spine-file.h"
+
+/// Environment variable choosing the allocator of a spine runtime library when it first needs one:
+/// "system" (the default) for the C heap, "pool" for PooledSpineExtension, "pool-stats" for the pool
+/// counting every allocation per call site
+#define SPINE_ALLOCATOR_VARIABLE "WMASKEX_SPINE_ALLOCATOR"
+
+/// Utf8SpineExtension allocating blocks of up to 4 KiB from size classes. Each thread caches free
+/// blocks per class and only locks a class to trade a batch of them with the shared free list, so
+/// the workers of the update pool rarely contend. Bigger blocks come from the C heap. Memory of the
+/// size classes is kept for reuse and never returned to the system.
+class PooledSpineExtension : public Utf8SpineExtension {
+public:
+    /// With countSites, allocations are counted per file and line passed by the runtime
+    explicit PooledSpineExtension(bool countSites) : Utf8SpineExtension(), countSites(countSites) {}
+
+    virtual ~PooledSpineExtension() {}
+
+protected:
+    virtual void *_alloc(size_t size, const char *file, int line) override;
+
+    virtual void *_calloc(size_t size, const char *file, int line) override;
+
+    virtual void *_realloc(void *ptr, size_t size, const char *file, int line) override;
+
+    virtual void _free(void *mem, const char *file, int line) override;
+
+private:
+    bool countSites;
+};
+
+/// Bytes of the block PooledSpineExtension hands out for size bytes: those of its size class up to
+/// 4 KiB, size itself above, from the C heap. Reallocating a block of a class within them keeps it.
+size_t spine_pool_block_size(size_t size);
+
+/// Creates the extension SPINE_ALLOCATOR_VARIABLE asks for, for spine::getDefaultExtension
+spine::SpineExtension* spine_extension_create();
+
+/// The count call sites with the most allocations and reallocations since the last reset, empty
+/// unless the extension is "pool-stats". Sites are merged by file name and line.
+std::vector<AllocationSite> spine_allocation_sites(size_t count);
+
+/// Zeroes the counts of every call site, live bytes stay as they are
+void spine_allocation_sites_reset();
+
+/// Whether the extension counts call sites, so an empty spine_allocation_sites means none allocated
+bool spine_allocation_sites_counted();
@@ -0,0 +1,107 @@
+#include "spine-bounds.h"
+#include <algorithm>
+#include <cfloat>
+#include <string_view>
+
+using namespace spine;
+
+/// A TextureLoader that loads nothing, pages get a dummy non-null texture like real ones
+class UnpagedTextureLoader : public TextureLoader {
+public:
+    void load(AtlasPage &page, const String &path) override {
+#if defined(SPINE37) || defined(SPINE38) || defined(SPINE40)
+        page.setRendererObject(&page);
+#elif defined(SPINE41) || defined(SPINE42)
+        page.texture = &page;
+#endif
+    }
+
+    void unload(void *texture) override {}
+};
+
+static UnpagedTextureLoader unpaged_texture_loader;
+
+/// Advances the skeleton by delta seconds like SpineRuntime::update
+static void skeleton_advance(Skeleton* skeleton, AnimationState* state, float delta) {
+    state->update(delta);
+    state->apply(*skeleton);
+#if defined(SPINE37) || defined(SPINE38) || defined(SPINE40) || defined(SPINE42)
+    skeleton->update(delta);
+#endif
+#if defined(SPINE37) || defined(SPINE38) || defined(SPINE40) || defined(SPINE41)
+    skeleton->updateWorldTransform();
+#elif defined(SPINE42)
+    skeleton->updateWorldTransform(Physics_Update);
+#endif
+}
+
+/// Unites the current box of the skeleton into [min_x, min_y, max_x, max_y]
+static void skeleton_extend(Skeleton* skeleton, Vector<float>& vertices, float box[4]) {
+    float x, y, width, height;
+    skeleton->getBounds(x, y, width, height, vertices);
+    // Without any attachment getBounds reports an inverted box
+    if (!(width >= 0 && height >= 0)) return;
+    box[0] = std::min(box[0], x);
+    box[1] = std::min(box[1], y);
+    box[2] = std::max(box[2], x + width);
+    box[3] = std::max(box[3], y + height);
+}
+
+Bounds skeleton_data_measure_animation(SkeletonData* skeleton_data, Animation* animation, const std::vector<std::string>& skins, float step) {
+    Vector<float> vertices;
+    std::vector<std::string> skin_names = skins.empty() ? std::vector<std::string>{ "" } : skins;
+    float box[4] = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const std::string& skin : skin_names) {
+        Skeleton skeleton(skeleton_data, true);
+        AnimationStateData state_data(skeleton_data);
+        AnimationState state(&state_data);
+        if (!skin.empty()) {
+            skeleton.setSkin(String(skin.c_str()));
+            skeleton.setSlotsToSetupPose();
+        }
+        state.setAnimation(0, animation, false);
+        float duration = animation->getDuration();
+        float time = 0.0f;
+        skeleton_advance(&skeleton, &state, 0.0f);
+        skeleton_extend(&skeleton, vertices, box);
+        while (time < duration) {
+            float delta = std::min(step, duration - time);
+            time += delta;
+            skeleton_advance(&skeleton, &state, delta);
+            skeleton_extend(&skeleton, vertices, box);
+        }
+    }
+    if (box[0] > box[2]) return { 0.0f, 0.0f, 0.0f, 0.0f };
+    return { box[0], box[1], box[2] - box[0], box[3] - box[1] };
+}
+
+std::map<std::string, Bounds> skeleton_data_measure(SkeletonData* skeleton_data, const std::vector<std::string>& skins, float step) {
+    std::map<std::string, Bounds> bounds;
+    Vector<Animation*>& animations = skeleton_data->getAnimations();
+    for (size_t i = 0; i < animations.size(); i++)
+        bounds[animations[i]->getName().buffer()] = skeleton_data_measure_animation(skeleton_data, animations[i], skins, step);
+    return bounds;
+}
+
+SkeletonData* skeleton_data_load_unpaged(const char* atlas_path, const char* skeleton_path, Atlas** atlas) {
+    *atlas = new Atlas(atlas_path, &unpaged_texture_loader);
+    SkeletonData* skeleton_data = nullptr;
+    std::string_view path(skeleton_path);
+    if (path.ends_with(".json")) {
+        SkeletonJson json(*atlas);
+        skeleton_data = json.readSkeletonDataFile(skeleton_path);
+    } else if (path.ends_with(".skel")) {
+        SkeletonBinary binary(*atlas);
+        skeleton_data = binary.readSkeletonDataFile(skeleton_path);
+    }
+    if (!skeleton_data) {
+        delete *atlas;
+        *atlas = nullptr;
+    }
+    return skeleton_data;
+}
+
+void skeleton_data_dispose_unpaged(SkeletonData* skeleton_data, Atlas* atlas) {
+    if (skeleton_data) delete skeleton_data;
+    if (atlas) delete atlas;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <spine/spine.h>
+#include "ISpineRuntime.h"
+
+/// Measures the box of one animation like skeleton_data_measure, an empty box if it shows nothing
+Bounds skeleton_data_measure_animation(spine::SkeletonData* skeleton_data, spine::Animation* animation, const std::vector<std::string>& skins, float step);
+
+/// Measures the box of every animation of the skeleton data, played once from the setup pose with
+/// each of the named skins and sampled every step seconds and at its end. Boxes cover the world
+/// vertices of all attachments, in skeleton coordinates at position 0 and scale 1, and are united
+/// over the skins. Animations showing no attachment get an empty box. Only reads the skeleton
+/// data, so it may run on any thread no other skeleton of the data renders sequences on.
+std::map<std::string, Bounds> skeleton_data_measure(spine::SkeletonData* skeleton_data, const std::vector<std::string>& skins, float step);
+
+/// Loads the skeleton data of an asset without decoding its atlas pages, for measuring. Free it
+/// with skeleton_data_dispose_unpaged, nullptr if the skeleton could not be read.
+spine::SkeletonData* skeleton_data_load_unpaged(const char* atlas_path, const char* skeleton_path, spine::Atlas** atlas);
+
+/// Frees skeleton data loaded by skeleton_data_load_unpaged together with its atlas
+void skeleton_data_dispose_unpaged(spine::SkeletonData* skeleton_data, spine::Atlas* atlas);
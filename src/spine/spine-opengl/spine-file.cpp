@@ -0,0 +1,107 @@
+#include "spine-file.h"
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#ifdef _WIN32
+#include <vector>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace spine;
+
+mapped_file_t* mapped_file_open(const char* file_path) {
+    size_t length = 0;
+    char* data = nullptr;
+#ifdef _WIN32
+    int wideSize = MultiByteToWideChar(CP_UTF8, 0, file_path, -1, nullptr, 0);
+    if (wideSize == 0) return nullptr;
+    std::vector<wchar_t> widePath(wideSize);
+    MultiByteToWideChar(CP_UTF8, 0, file_path, -1, widePath.data(), wideSize);
+    HANDLE file = CreateFileW(widePath.data(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        length = (size_t) size.QuadPart;
+        HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+        if (mapping) {
+            data = (char*) MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+            // The view keeps the mapping and the file open
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    int file = open(file_path, O_RDONLY);
+    if (file < 0) return nullptr;
+    struct stat info;
+    if (fstat(file, &info) == 0 && info.st_size > 0) {
+        length = (size_t) info.st_size;
+        void* view = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+        if (view != MAP_FAILED) data = (char*) view;
+    }
+    // The mapping keeps the file open
+    close(file);
+#endif
+    if (!data) return nullptr;
+    auto* mapped = (mapped_file_t*) malloc(sizeof(mapped_file_t));
+    mapped->data = data;
+    mapped->length = length;
+    return mapped;
+}
+
+void mapped_file_close(mapped_file_t* file) {
+    if (!file) return;
+#ifdef _WIN32
+    UnmapViewOfFile(file->data);
+#else
+    munmap(file->data, file->length);
+#endif
+    free(file);
+}
+
+char *Utf8SpineExtension::_readFile(const String &path, int *length) {
+    mapped_file_t* file = mapped_file_open(path.buffer());
+    if (!file) return 0;
+    if (file->length > INT_MAX) {
+        mapped_file_close(file);
+        return 0;
+    }
+    *length = (int) file->length;
+
+    std::string filePath = path.buffer();
+    if (filePath.ends_with(".skel") || filePath.ends_with(".atlas")) {
+        // Both parsers free the data right after parsing, which releases the mapping again
+        std::lock_guard<std::mutex> lock(mappingsMutex);
+        mappings[file->data] = file;
+        numMappings++;
+        return file->data;
+    }
+
+    char *data = SpineExtension::alloc<char>(*length, __FILE__, __LINE__);
+    memcpy(data, file->data, file->length);
+    mapped_file_close(file);
+    return data;
+}
+
+void Utf8SpineExtension::_free(void *mem, const char *file, int line) {
+    if (releaseMapping(mem)) return;
+    DefaultSpineExtension::_free(mem, file, line);
+}
+
+bool Utf8SpineExtension::releaseMapping(void *mem) {
+    // Every spine object is freed through here, only look the pointer up while a file is mapped
+    if (numMappings == 0) return false;
+    std::lock_guard<std::mutex> lock(mappingsMutex);
+    auto it = mappings.find(mem);
+    if (it == mappings.end()) return false;
+    mapped_file_close(it->second);
+    mappings.erase(it);
+    numMappings--;
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <spine/spine.h>
+
+/// A whole file mapped into memory copy-on-write, so parsers may read and even modify the data
+/// in place without touching the file or copying it to the heap first
+typedef struct {
+    char* data;
+    size_t length;
+} mapped_file_t;
+
+/// Maps the file at the given UTF-8 path, nullptr if it can't be opened or is empty
+mapped_file_t* mapped_file_open(const char* file_path);
+
+/// Unmaps the file
+void mapped_file_close(mapped_file_t* file);
+
+/// Spine extension reading files through mapped_file_open, so UTF-8 paths work on Windows too.
+/// .skel and .atlas files are handed to the parser as their mapping, which is released when the
+/// parser frees the data. Other files are copied to the heap as usual.
+class Utf8SpineExtension : public spine::DefaultSpineExtension {
+public:
+    Utf8SpineExtension() : DefaultSpineExtension() {}
+
+    virtual ~Utf8SpineExtension() {}
+
+protected:
+    virtual char *_readFile(const spine::String &path, int *length) override;
+
+    virtual void _free(void *mem, const char *file, int line) override;
+
+    /// Unmaps mem if _readFile handed it out as a mapping, returns whether it did
+    bool releaseMapping(void *mem);
+
+private:
+    std::mutex mappingsMutex;
+    std::atomic<int> numMappings = 0;
+    std::map<void*, mapped_file_t*> mappings;
+};
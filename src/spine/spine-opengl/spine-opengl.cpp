@@ -1,8 +1,7 @@
 #include "spine-opengl.h"
+#include "spine-file.h"
 #include <cstdio>
 #include <glbinding/gl/gl.h>
-#define STB_IMAGE_IMPLEMENTATION
-#define STBI_WINDOWS_UTF8
 #include "stb_image.h"
 #include <string>
 #include <vector>
@@ -11,42 +10,6 @@
 using namespace gl;
 using namespace spine;
 
-/// UTF-8 aware Spine extension for Windows
-class Utf8SpineExtension : public DefaultSpineExtension {
-public:
-    Utf8SpineExtension() : DefaultSpineExtension() {}
-
-    virtual ~Utf8SpineExtension() {}
-
-protected:
-    virtual char *_readFile(const String &path, int *length) override {
-        std::string utf8Path = path.buffer();
-        int wideSize = MultiByteToWideChar(CP_UTF8, 0, utf8Path.c_str(), -1, nullptr, 0);
-        if (wideSize == 0) return 0; 
-        std::vector<wchar_t> widePath(wideSize);
-        MultiByteToWideChar(CP_UTF8, 0, utf8Path.c_str(), -1, widePath.data(), wideSize);
-        
-        FILE *file = nullptr;
-        errno_t err = _wfopen_s(&file, widePath.data(), L"rb");
-        if (err != 0 || !file) return 0; 
-
-        fseek(file, 0, SEEK_END);
-        *length = (int) ftell(file);
-        fseek(file, 0, SEEK_SET);
-
-        char *data = SpineExtension::alloc<char>(*length, __FILE__, __LINE__);
-        fread(data, 1, *length, file);
-        fclose(file);
-
-        return data;
-    }
-};
-
-/// Set the default extension used for memory allocations and file I/O
-SpineExtension *spine::getDefaultExtension() {
-    return new Utf8SpineExtension();
-}
-
 /// A blend mode, see https://en.esotericsoftware.com/spine-slots#Blending
 /// Encodes the OpenGL source and destination blend function for both premultiplied and
 /// non-premultiplied alpha blending.
@@ -94,28 +57,42 @@ mesh_t* mesh_create() {
     auto* mesh = (mesh_t*) malloc(sizeof(mesh_t)); 
     mesh->vao = vao;
     mesh->vbo = vbo;
-    mesh->num_vertices = 0;
+    mesh->vertices = {0, 0};
     mesh->ibo = ibo;
-    mesh->num_indices = 0;
+    mesh->indices = {0, 0};
     return mesh;
 }
 
-void mesh_update(mesh_t* mesh, vertex_t* vertices, int num_vertices, uint16_t* indices, int num_indices) {
+/// Reserves count elements of a streamed buffer and maps them for writing. Writes never
+/// synchronize with the GPU: either the range has not been used since the last orphaning, or
+/// the storage is orphaned first.
+static void* stream_buffer_map(GLenum target, stream_ring_t* ring, int count, size_t element_size, int* offset) {
+    bool orphan;
+    *offset = stream_ring_reserve(ring, count, &orphan);
+    if (orphan) glBufferData(target, (GLsizeiptr) (ring->capacity * element_size), nullptr, GL_STREAM_DRAW);
+    return glMapBufferRange(target, (GLintptr) (*offset * element_size), (GLsizeiptr) (count * element_size),
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+bool mesh_update(mesh_t* mesh, const frame_t* frame, RenderCommand* command, int* base_vertex, int* first_index) {
     glBindVertexArray(mesh->vao); 
 
     glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo); 
-    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) (num_vertices * sizeof(vertex_t)), vertices, GL_STATIC_DRAW); 
-    mesh->num_vertices = num_vertices;
+    auto* vertices = (vertex_t*) stream_buffer_map(GL_ARRAY_BUFFER, &mesh->vertices, frame->num_vertices, sizeof(vertex_t), base_vertex);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr) (num_indices * sizeof(uint16_t)), indices, GL_STATIC_DRAW);
-    mesh->num_indices = num_indices;
+    auto* indices = (uint16_t*) stream_buffer_map(GL_ELEMENT_ARRAY_BUFFER, &mesh->indices, frame->num_indices, sizeof(uint16_t), first_index);
+    if (vertices && indices) frame_pack(frame, command, vertices, indices);
+    bool success = vertices && indices;
+    if (vertices) success = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE && success;
+    if (indices) success = glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER) == GL_TRUE && success;
 
     glBindVertexArray(0);
+    return success;
 }
 
-void mesh_draw(mesh_t* mesh) {
+void mesh_draw(mesh_t* mesh, int first_index, int num_indices, int base_vertex) {
     glBindVertexArray(mesh->vao);
-    glDrawElements(GL_TRIANGLES, mesh->num_indices, GL_UNSIGNED_SHORT, nullptr);
+    glDrawElementsBaseVertex(GL_TRIANGLES, num_indices, GL_UNSIGNED_SHORT, (void*) (first_index * sizeof(uint16_t)), base_vertex);
     glBindVertexArray(0);
 }
 
@@ -232,6 +209,20 @@ texture_t texture_load(const char* file_path) {
     return texture;
 }
 
+texture_t texture_create(const image_t* image) {
+    texture_t texture; 
+    glGenTextures(1, &texture); 
+    glBindTexture(GL_TEXTURE_2D, texture); 
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image->width, image->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image->pixels);
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); 
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE); 
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); 
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return texture;
+}
+
 void texture_use(texture_t texture) {
     glActiveTexture(GL_TEXTURE0); // Set active texture unit to 0
     glBindTexture(GL_TEXTURE_2D, texture); 
@@ -272,6 +263,14 @@ void GlTextureLoader::unload(void *texture) {
     texture_dispose((texture_t) (uintptr_t) texture);
 }
 
+void* DeferredGlTextureLoader::createTexture(const image_t* image) {
+    return (void*) (uintptr_t) texture_create(image);
+}
+
+void DeferredGlTextureLoader::disposeTexture(void* texture) {
+    texture_dispose((texture_t) (uintptr_t) texture);
+}
+
 renderer_t* renderer_create() {
     shader_t shader = shader_create(R"(
         #version 330 core
@@ -312,9 +311,11 @@ renderer_t* renderer_create() {
     auto* renderer = (renderer_t*) malloc(sizeof(renderer_t)); 
     renderer->shader = shader;
     renderer->mesh = mesh;
-    renderer->vertex_buffer_size = 0;
-    renderer->vertex_buffer = nullptr;
+    frame_init(&renderer->frame);
     renderer->renderer = new SkeletonRenderer(); 
+    renderer->command = nullptr;
+    renderer->plan_time = 0;
+    renderer->stats = { nullptr, nullptr, nullptr };
     return renderer; 
 }
 
@@ -326,38 +327,43 @@ void renderer_set_viewport_size(renderer_t* renderer, int width, int height, flo
 }
 
 void renderer_draw(renderer_t* renderer, Skeleton* skeleton, bool premultipliedAlpha) {
+    renderer_prepare(renderer, skeleton);
+    renderer_submit(renderer, premultipliedAlpha);
+}
+
+void renderer_prepare(renderer_t* renderer, Skeleton* skeleton) {
+    {
+        ScopedPhaseTimer timer(renderer->stats.render);
+        renderer->command = renderer->renderer->render(*skeleton); 
+    }
+    uint64_t start = phaseClockNow();
+    frame_plan(&renderer->frame, renderer->command);
+    renderer->plan_time = phaseClockNow() - start;
+}
+
+void renderer_submit(renderer_t* renderer, bool premultipliedAlpha) {
+    RenderCommand* command = renderer->command;
+    renderer->command = nullptr;
+    frame_t* frame = &renderer->frame;
+    if (!command || frame->num_draws == 0) return;
+
     shader_use(renderer->shader); 
     shader_set_int(renderer->shader, "uTexture", 0); 
     glEnable(GL_BLEND);
 
-    RenderCommand* command = renderer->renderer->render(*skeleton); 
-    while (command) {
-        int num_command_vertices = command->numVertices;
-        if (renderer->vertex_buffer_size < num_command_vertices) {
-            renderer->vertex_buffer_size = num_command_vertices;
-            free(renderer->vertex_buffer);
-            renderer->vertex_buffer = (vertex_t*) malloc(sizeof(vertex_t) * renderer->vertex_buffer_size);
-        }
-        float* positions = command->positions;
-        float* uvs = command->uvs;
-        uint32_t* colors = command->colors;
-        uint32_t* darkColors = command->darkColors;
-        for (int i = 0, j = 0; i < num_command_vertices; i++, j += 2) {
-            vertex_t* vertex = &renderer->vertex_buffer[i];
-            vertex->x = positions[j];
-            vertex->y = positions[j + 1];
-            vertex->u = uvs[j];
-            vertex->v = uvs[j + 1];
-            uint32_t color = colors[i];
-            vertex->color = (color & 0xFF00FF00) | ((color & 0x00FF0000) >> 16) | ((color & 0x000000FF) << 16); 
-            uint32_t darkColor = darkColors[i];
-            vertex->darkColor = (darkColor & 0xFF00FF00) | ((darkColor & 0x00FF0000) >> 16) | ((darkColor & 0x000000FF) << 16);
-        }
-        int num_command_indices = command->numIndices;
-        uint16_t* indices = command->indices;
-        mesh_update(renderer->mesh, renderer->vertex_buffer, num_command_vertices, indices, num_command_indices);
+    int base_vertex, first_index;
+    uint64_t start = phaseClockNow();
+    bool uploaded = mesh_update(renderer->mesh, frame, command, &base_vertex, &first_index);
+    if (renderer->stats.pack) renderer->stats.pack->add(renderer->plan_time + phaseClockNow() - start);
+    if (!uploaded) {
+        printf("Failed to upload frame\n");
+        return;
+    }
 
-        blend_mode_t blend_mode = blend_modes[command->blendMode];
+    ScopedPhaseTimer timer(renderer->stats.submit);
+    for (int i = 0; i < frame->num_draws; i++) {
+        frame_draw_t* draw = &frame->draws[i];
+        blend_mode_t blend_mode = blend_modes[draw->blend_mode];
         glBlendFuncSeparate(
             premultipliedAlpha ? (GLenum) blend_mode.source_color_pma : (GLenum) blend_mode.source_color,
             (GLenum) blend_mode.dest_color,
@@ -365,18 +371,17 @@ void renderer_draw(renderer_t* renderer, Skeleton* skeleton, bool premultipliedA
             (GLenum) blend_mode.dest_color
         );
 
-        auto texture = (texture_t) (uintptr_t) command->texture;
+        auto texture = (texture_t) (uintptr_t) draw->texture;
         texture_use(texture);
 
-        mesh_draw(renderer->mesh);
-        command = command->next;
+        mesh_draw(renderer->mesh, first_index + draw->first_index, draw->num_indices, base_vertex + draw->base_vertex);
     }
 }
 
 void renderer_dispose(renderer_t* renderer) {
     shader_dispose(renderer->shader);
     mesh_dispose(renderer->mesh);
-    free(renderer->vertex_buffer);
+    frame_dispose(&renderer->frame);
     delete renderer->renderer;
     free(renderer);
 }
\ No newline at end of file
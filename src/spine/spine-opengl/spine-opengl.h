@@ -1,29 +1,28 @@
 #pragma once
 
 #include <stdint.h>
+#include <utility>
+#include <vector>
 #include <spine/spine.h>
+#include "spine-software.h"
+#include "spine-vertex.h"
 
-/// A vertex of a mesh generated from a Spine skeleton
-struct vertex_t {
-    float x, y; 
-    uint32_t color; 
-    float u, v;
-    uint32_t darkColor; 
-}; 
-
-/// A GPU-side mesh using OpenGL vertex arrays, vertex buffer, and
-/// indices buffer.
+/// A GPU-side mesh using OpenGL vertex arrays, and a vertex buffer and an indices buffer
+/// streamed as rings, holding the whole frame of a renderer
 typedef struct {
     unsigned int vao; 
     unsigned int vbo; 
-    int num_vertices; 
+    stream_ring_t vertices; 
     unsigned int ibo; 
-    int num_indices; 
+    stream_ring_t indices; 
 } mesh_t; 
 
 mesh_t* mesh_create(); 
-void mesh_update(mesh_t* mesh, vertex_t* vertices, int num_vertices, uint16_t* indices, int num_indices); 
-void mesh_draw(mesh_t* mesh); 
+/// Uploads the commands planned in frame with a single mapping of each buffer, returning where
+/// the frame starts in the buffers. Returns false if the buffers could not be written.
+bool mesh_update(mesh_t* mesh, const frame_t* frame, spine::RenderCommand* command, int* base_vertex, int* first_index); 
+/// Draws num_indices indices starting at first_index, relative to base_vertex
+void mesh_draw(mesh_t* mesh, int first_index, int num_indices, int base_vertex); 
 void mesh_dispose(mesh_t* mesh);
 
 /// A shader (the OpenGL shader program id)
@@ -53,6 +52,9 @@ typedef unsigned int texture_t;
 /// Loads the given image and creates an OpenGL texture with default settings and auto-generated mipmap levels
 texture_t texture_load(const char* filename);
 
+/// Creates an OpenGL texture with the same settings as texture_load from a decoded RGBA8 image
+texture_t texture_create(const image_t* image);
+
 /// Binds the texture to texture unit 0
 void texture_bind(texture_t texture);
 
@@ -66,14 +68,25 @@ public:
     void unload(void *texture);
 }; 
 
-/// Renderer capable of rendering a spine_skeleton_drawable, using a shader, a mesh, and a
-/// temporary CPU-side vertex buffer used to update the GPU-side mesh
+/// A DeferredTextureLoader creating OpenGL textures, upload() needs a current OpenGL context
+class DeferredGlTextureLoader : public DeferredTextureLoader {
+protected:
+    void* createTexture(const image_t* image) override;
+    void disposeTexture(void* texture) override;
+};
+
+/// Renderer capable of rendering a spine_skeleton_drawable, using a shader, a mesh, and the
+/// CPU-side frame layout used to upload all render commands to the GPU-side mesh at once
 typedef struct {
     shader_t shader; 
     mesh_t* mesh; 
-    int vertex_buffer_size; 
-    vertex_t* vertex_buffer;
+    frame_t frame;
     spine::SkeletonRenderer* renderer;
+    /// Render commands of the prepared frame, nullptr once it was submitted
+    spine::RenderCommand* command;
+    /// ns renderer_prepare spent planning, counted with the upload as one pack sample
+    uint64_t plan_time;
+    render_stats_t stats;
 } renderer_t; 
 
 /// Creates a new renderer
@@ -86,5 +99,13 @@ void renderer_set_viewport_size(renderer_t* renderer, int width, int height, flo
 /// was constructed.
 void renderer_draw(renderer_t* renderer, spine::Skeleton* skeleton, bool premultipliedAlpha);
 
+/// Builds the render commands of the skeleton and plans the frame, the CPU half of renderer_draw.
+/// Makes no OpenGL call, so it may run on any thread while the renderer is not used otherwise.
+void renderer_prepare(renderer_t* renderer, spine::Skeleton* skeleton);
+
+/// Uploads and draws the frame planned by renderer_prepare on the thread of the OpenGL context,
+/// draws nothing if no frame was prepared since the last submit
+void renderer_submit(renderer_t* renderer, bool premultipliedAlpha);
+
 /// Disposes the renderer
 void renderer_dispose(renderer_t* renderer);
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stdint.h>
+#include <spine/spine.h>
+
+/// Hash of everything in a posed skeleton that SkeletonRenderer::render reads: the skeleton color,
+/// the world transform of every bone, and in draw order the color, attachment, sequence index and
+/// deform of every slot. Call it after updateWorldTransform. Equal fingerprints of two poses mean
+/// they render the same image, unless the hash collides.
+uint64_t pose_fingerprint(spine::Skeleton* skeleton);
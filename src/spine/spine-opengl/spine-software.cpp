@@ -0,0 +1,473 @@
+#include "spine-software.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_WINDOWS_UTF8
+#include "stb_image.h"
+
+using namespace spine;
+
+/// A blend factor of the software renderer, named after the OpenGL blend factor it replaces
+typedef enum {
+    FACTOR_ONE,
+    FACTOR_SRC_ALPHA,
+    FACTOR_ONE_MINUS_SRC_ALPHA,
+    FACTOR_DST_COLOR,
+    FACTOR_ONE_MINUS_SRC_COLOR
+} blend_factor_t;
+
+/// Same layout as blend_mode_t in spine-opengl.cpp
+typedef struct {
+    blend_factor_t source_color;
+    blend_factor_t source_color_pma;
+    blend_factor_t dest_color;
+    blend_factor_t source_alpha;
+} software_blend_mode_t;
+
+/// The 4 supported blend modes, entry by entry equal to blend_modes in spine-opengl.cpp.
+static const software_blend_mode_t software_blend_modes[] = {
+    {FACTOR_SRC_ALPHA, FACTOR_ONE, FACTOR_ONE_MINUS_SRC_ALPHA, FACTOR_ONE},
+    {FACTOR_SRC_ALPHA, FACTOR_ONE, FACTOR_ONE, FACTOR_ONE},
+    {FACTOR_DST_COLOR, FACTOR_DST_COLOR, FACTOR_ONE_MINUS_SRC_ALPHA, FACTOR_ONE_MINUS_SRC_ALPHA},
+    {FACTOR_ONE, FACTOR_ONE, FACTOR_ONE_MINUS_SRC_COLOR, FACTOR_ONE_MINUS_SRC_COLOR}
+};
+
+image_t* image_load(const char* file_path) {
+    int width, height, nrChannels;
+    unsigned char* data = stbi_load(file_path, &width, &height, &nrChannels, 0);
+    if (!data) {
+        printf("file path: %s\n", file_path);
+        printf("Failed to load texture\n");
+        return nullptr;
+    }
+
+    auto* image = (image_t*) malloc(sizeof(image_t));
+    image->width = width;
+    image->height = height;
+    image->pixels = (uint8_t*) malloc((size_t) width * height * 4);
+    for (size_t i = 0, n = (size_t) width * height; i < n; i++) {
+        const unsigned char* src = data + i * nrChannels;
+        uint8_t* dst = image->pixels + i * 4;
+        // Same expansion as glTexImage2D with GL_RED, GL_RGB and GL_RGBA
+        dst[0] = src[0];
+        dst[1] = nrChannels >= 3 ? src[1] : 0;
+        dst[2] = nrChannels >= 3 ? src[2] : 0;
+        dst[3] = nrChannels == 4 ? src[3] : 255;
+    }
+
+    stbi_image_free(data);
+    return image;
+}
+
+void image_dispose(image_t* image) {
+    if (!image) return;
+    free(image->pixels);
+    free(image);
+}
+
+/// Worker threads decoding the images of every batch
+class ImageDecodePool {
+public:
+    explicit ImageDecodePool(unsigned int num_threads) {
+        for (unsigned int i = 0; i < num_threads; i++)
+            workers.emplace_back([this] { run(); });
+    }
+
+    /// Runs the tasks still queued, then joins the workers
+    ~ImageDecodePool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        condition.notify_one();
+    }
+
+private:
+    void run() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::function<void()>> tasks;
+    bool stopping = false;
+};
+
+// The pool runs while any batch exists. The last batch to be disposed joins the workers, so they
+// never outlive the assets and nothing is left to join from static destructors while a DLL unloads.
+static std::mutex image_decode_mutex;
+static ImageDecodePool* image_decode_pool = nullptr;
+static int image_decode_batches = 0;
+static unsigned int image_decode_threads = 0;
+
+void image_batch_threads(int count) {
+    std::lock_guard<std::mutex> lock(image_decode_mutex);
+    image_decode_threads = count > 0 ? (unsigned int) count : 0;
+}
+
+struct image_batch_t {
+    std::vector<std::shared_future<image_t*>> images;
+    std::vector<bool> taken;
+};
+
+image_batch_t* image_batch_create() {
+    std::lock_guard<std::mutex> lock(image_decode_mutex);
+    if (image_decode_batches++ == 0) {
+        // Atlases rarely have more than 8 pages, more threads would mostly sit idle
+        unsigned int num_threads = image_decode_threads
+            ? image_decode_threads : std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+        image_decode_pool = new ImageDecodePool(num_threads);
+    }
+    return new image_batch_t();
+}
+
+int image_batch_add(image_batch_t* batch, const char* file_path) {
+    auto task = std::make_shared<std::packaged_task<image_t*()>>([path = std::string(file_path)] {
+        return image_load(path.c_str());
+    });
+    batch->images.push_back(task->get_future().share());
+    batch->taken.push_back(false);
+    image_decode_pool->submit([task] { (*task)(); });
+    return (int) batch->images.size() - 1;
+}
+
+void image_batch_wait(image_batch_t* batch) {
+    for (auto& image : batch->images) image.wait();
+}
+
+image_t* image_batch_take(image_batch_t* batch, int index) {
+    if (index < 0 || index >= (int) batch->images.size() || batch->taken[index]) return nullptr;
+    batch->taken[index] = true;
+    return batch->images[index].get();
+}
+
+void image_batch_dispose(image_batch_t* batch) {
+    if (!batch) return;
+    for (size_t i = 0; i < batch->images.size(); i++)
+        if (!batch->taken[i]) image_dispose(batch->images[i].get());
+    delete batch;
+
+    ImageDecodePool* pool = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(image_decode_mutex);
+        if (--image_decode_batches == 0) std::swap(pool, image_decode_pool);
+    }
+    delete pool;
+}
+
+DeferredTextureLoader::DeferredTextureLoader() : batch(image_batch_create()) {}
+
+DeferredTextureLoader::~DeferredTextureLoader() {
+    image_batch_dispose(batch);
+}
+
+void DeferredTextureLoader::load(spine::AtlasPage &page, const spine::String &path) {
+    // Only queue the decode here, the page keeps a null texture until upload()
+    pages.push_back({ &page, image_batch_add(batch, path.buffer()) });
+}
+
+void DeferredTextureLoader::unload(void *texture) {
+    // Pages that were never uploaded have no texture
+    if (texture) disposeTexture(texture);
+}
+
+void DeferredTextureLoader::wait() {
+    image_batch_wait(batch);
+}
+
+void DeferredTextureLoader::upload(spine::Atlas &atlas) {
+    for (auto& [page, index] : pages) {
+        image_t* image = image_batch_take(batch, index);
+        if (!image) continue;
+        void* texture = createTexture(image);
+        image_dispose(image);
+#if defined(SPINE37) || defined(SPINE38) || defined(SPINE40)
+        page->setRendererObject(texture);
+#elif defined(SPINE41) || defined(SPINE42)
+        // Regions copied the page's texture while the atlas was parsed
+        page->texture = texture;
+        Vector<AtlasRegion*>& regions = atlas.getRegions();
+        for (size_t i = 0; i < regions.size(); i++)
+            if (regions[i]->page == page) regions[i]->rendererObject = texture;
+#endif
+    }
+    pages.clear();
+}
+
+void SoftwareTextureLoader::load(spine::AtlasPage &page, const spine::String &path) {
+#if defined(SPINE37) || defined(SPINE38) || defined(SPINE40)
+    page.setRendererObject(image_load(path.buffer()));
+#elif defined(SPINE41) || defined(SPINE42)
+    page.texture = image_load(path.buffer());
+#endif
+}
+
+void SoftwareTextureLoader::unload(void *texture) {
+    image_dispose((image_t*) texture);
+}
+
+static inline float clamp01(float value) {
+    return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+}
+
+/// Unpacks an ARGB color of a RenderCommand into normalized RGBA
+static inline void unpack_color(uint32_t color, float* out) {
+    out[0] = ((color >> 16) & 0xFF) / 255.0f;
+    out[1] = ((color >> 8) & 0xFF) / 255.0f;
+    out[2] = (color & 0xFF) / 255.0f;
+    out[3] = ((color >> 24) & 0xFF) / 255.0f;
+}
+
+/// Bilinear lookup with GL_CLAMP_TO_EDGE wrapping, matching GL_LINEAR magnification
+static void image_sample(const image_t* image, float u, float v, float* out) {
+    float x = u * image->width - 0.5f;
+    float y = v * image->height - 0.5f;
+    float fx = floorf(x);
+    float fy = floorf(y);
+    float tx = x - fx;
+    float ty = y - fy;
+    int x0 = (int) fx, y0 = (int) fy;
+    int x1 = x0 + 1, y1 = y0 + 1;
+    int maxX = image->width - 1, maxY = image->height - 1;
+    x0 = x0 < 0 ? 0 : (x0 > maxX ? maxX : x0);
+    x1 = x1 < 0 ? 0 : (x1 > maxX ? maxX : x1);
+    y0 = y0 < 0 ? 0 : (y0 > maxY ? maxY : y0);
+    y1 = y1 < 0 ? 0 : (y1 > maxY ? maxY : y1);
+    const uint8_t* p00 = image->pixels + ((size_t) y0 * image->width + x0) * 4;
+    const uint8_t* p10 = image->pixels + ((size_t) y0 * image->width + x1) * 4;
+    const uint8_t* p01 = image->pixels + ((size_t) y1 * image->width + x0) * 4;
+    const uint8_t* p11 = image->pixels + ((size_t) y1 * image->width + x1) * 4;
+    for (int c = 0; c < 4; c++) {
+        float top = p00[c] + (p10[c] - p00[c]) * tx;
+        float bottom = p01[c] + (p11[c] - p01[c]) * tx;
+        out[c] = (top + (bottom - top) * ty) / 255.0f;
+    }
+}
+
+/// Evaluates a blend factor for channel c, alpha being channel 3
+static inline float blend_factor(blend_factor_t factor, const float* src, const float* dst, int c) {
+    switch (factor) {
+    case FACTOR_ONE: return 1.0f;
+    case FACTOR_SRC_ALPHA: return src[3];
+    case FACTOR_ONE_MINUS_SRC_ALPHA: return 1.0f - src[3];
+    case FACTOR_DST_COLOR: return dst[c];
+    case FACTOR_ONE_MINUS_SRC_COLOR: return 1.0f - src[c];
+    }
+    return 0.0f;
+}
+
+/// Edge function, positive if p lies on the inner side of the edge a->b
+static inline float edge_function(const raster_vertex_t* a, const raster_vertex_t* b, float px, float py) {
+    return (b->x - a->x) * (py - a->y) - (b->y - a->y) * (px - a->x);
+}
+
+/// Top-left fill rule for pixel space with y pointing down, so shared edges are only drawn once
+static inline bool is_top_left(const raster_vertex_t* a, const raster_vertex_t* b) {
+    float dx = b->x - a->x, dy = b->y - a->y;
+    return (dy == 0.0f && dx > 0.0f) || dy < 0.0f;
+}
+
+static void rasterize_triangle(software_renderer_t* renderer, const image_t* texture, const software_blend_mode_t* mode,
+    bool premultipliedAlpha, const raster_vertex_t* v0, const raster_vertex_t* v1, const raster_vertex_t* v2) {
+    float area = edge_function(v0, v1, v2->x, v2->y);
+    if (area == 0.0f) return;
+    if (area < 0.0f) {
+        const raster_vertex_t* tmp = v1;
+        v1 = v2;
+        v2 = tmp;
+        area = -area;
+    }
+
+    int minX = (int) floorf(fminf(v0->x, fminf(v1->x, v2->x)));
+    int maxX = (int) ceilf(fmaxf(v0->x, fmaxf(v1->x, v2->x)));
+    int minY = (int) floorf(fminf(v0->y, fminf(v1->y, v2->y)));
+    int maxY = (int) ceilf(fmaxf(v0->y, fmaxf(v1->y, v2->y)));
+    if (minX < 0) minX = 0;
+    if (minY < 0) minY = 0;
+    if (maxX > renderer->width - 1) maxX = renderer->width - 1;
+    if (maxY > renderer->height - 1) maxY = renderer->height - 1;
+    if (minX > maxX || minY > maxY) return;
+    pixel_rect_t extent = { minX, minY, maxX - minX + 1, maxY - minY + 1 };
+    renderer->drawn = pixel_rect_union(&renderer->drawn, &extent);
+
+    bool topLeft0 = is_top_left(v1, v2);
+    bool topLeft1 = is_top_left(v2, v0);
+    bool topLeft2 = is_top_left(v0, v1);
+    blend_factor_t sourceColor = premultipliedAlpha ? mode->source_color_pma : mode->source_color;
+    float invArea = 1.0f / area;
+    // Byte of the target pixel holding each RGBA channel
+    static const int rgba_order[4] = { 0, 1, 2, 3 };
+    static const int bgra_order[4] = { 2, 1, 0, 3 };
+    const int* order = renderer->bgra ? bgra_order : rgba_order;
+
+    for (int y = minY; y <= maxY; y++) {
+        float py = y + 0.5f;
+        uint8_t* row = renderer->pixels + (size_t) y * renderer->width * 4;
+        for (int x = minX; x <= maxX; x++) {
+            float px = x + 0.5f;
+            float w0 = edge_function(v1, v2, px, py);
+            float w1 = edge_function(v2, v0, px, py);
+            float w2 = edge_function(v0, v1, px, py);
+            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+            if ((w0 == 0.0f && !topLeft0) || (w1 == 0.0f && !topLeft1) || (w2 == 0.0f && !topLeft2)) continue;
+            w0 *= invArea;
+            w1 *= invArea;
+            w2 *= invArea;
+
+            float light[4], dark[4], tex[4], src[4], dst[4];
+            for (int c = 0; c < 4; c++) {
+                light[c] = v0->color[c] * w0 + v1->color[c] * w1 + v2->color[c] * w2;
+                dark[c] = v0->darkColor[c] * w0 + v1->darkColor[c] * w1 + v2->darkColor[c] * w2;
+            }
+            image_sample(texture, v0->u * w0 + v1->u * w1 + v2->u * w2, v0->v * w0 + v1->v * w1 + v2->v * w2, tex);
+
+            // Same as the fragment shader of the OpenGL renderer
+            src[3] = clamp01(tex[3] * light[3]);
+            for (int c = 0; c < 3; c++)
+                src[c] = clamp01(((tex[3] - 1.0f) * dark[3] + 1.0f - tex[c]) * dark[c] + tex[c] * light[c]);
+
+            uint8_t* pixel = row + x * 4;
+            for (int c = 0; c < 4; c++) dst[c] = pixel[order[c]] / 255.0f;
+            for (int c = 0; c < 3; c++) {
+                float value = src[c] * blend_factor(sourceColor, src, dst, c) + dst[c] * blend_factor(mode->dest_color, src, dst, c);
+                pixel[order[c]] = (uint8_t) (clamp01(value) * 255.0f + 0.5f);
+            }
+            // glBlendFuncSeparate(..., source_alpha, dest_color) as in renderer_draw
+            float alpha = src[3] * blend_factor(mode->source_alpha, src, dst, 3) + dst[3] * blend_factor(mode->dest_color, src, dst, 3);
+            pixel[3] = (uint8_t) (clamp01(alpha) * 255.0f + 0.5f);
+        }
+    }
+}
+
+software_renderer_t* software_renderer_create() {
+    auto* renderer = (software_renderer_t*) malloc(sizeof(software_renderer_t));
+    renderer->width = 0;
+    renderer->height = 0;
+    renderer->scale = 1.0f;
+    renderer->pixels = nullptr;
+    renderer->owns_pixels = true;
+    renderer->bgra = false;
+    renderer->drawn = { 0, 0, 0, 0 };
+    renderer->vertex_buffer_size = 0;
+    renderer->vertex_buffer = nullptr;
+    aabb_reset(&renderer->bounds);
+    renderer->renderer = new SkeletonRenderer();
+    renderer->stats = { nullptr, nullptr, nullptr };
+    return renderer;
+}
+
+void software_renderer_set_viewport_size(software_renderer_t* renderer, int width, int height, float scale) {
+    if (renderer->width != width || renderer->height != height) {
+        if (renderer->owns_pixels) free(renderer->pixels);
+        renderer->pixels = (uint8_t*) calloc((size_t) width * height, 4);
+        renderer->owns_pixels = true;
+        renderer->drawn = { 0, 0, 0, 0 };
+    }
+    renderer->width = width;
+    renderer->height = height;
+    renderer->scale = scale;
+}
+
+void software_renderer_set_target(software_renderer_t* renderer, uint8_t* pixels, bool bgra) {
+    if (renderer->owns_pixels) free(renderer->pixels);
+    renderer->owns_pixels = pixels == nullptr;
+    renderer->pixels = pixels ? pixels : (uint8_t*) calloc((size_t) renderer->width * renderer->height, 4);
+    renderer->bgra = bgra;
+    renderer->drawn = { 0, 0, 0, 0 };
+}
+
+void software_renderer_clear(software_renderer_t* renderer) {
+    // Everything outside the drawn pixels is still transparent
+    if (renderer->pixels && !pixel_rect_is_empty(&renderer->drawn)) {
+        const pixel_rect_t* drawn = &renderer->drawn;
+        for (int y = drawn->y; y < drawn->y + drawn->height; y++)
+            memset(renderer->pixels + ((size_t) y * renderer->width + drawn->x) * 4, 0, (size_t) drawn->width * 4);
+    }
+    renderer->drawn = { 0, 0, 0, 0 };
+    aabb_reset(&renderer->bounds);
+}
+
+void software_renderer_draw_commands(software_renderer_t* renderer, RenderCommand* command, bool premultipliedAlpha) {
+    if (!renderer->pixels) return;
+    while (command) {
+        auto* texture = (const image_t*) command->texture;
+        if (!texture) {
+            command = command->next;
+            continue;
+        }
+        int num_command_vertices = command->numVertices;
+        aabb_add_positions(&renderer->bounds, command->positions, num_command_vertices);
+        if (renderer->vertex_buffer_size < num_command_vertices) {
+            // Doubled like the draws of a frame, so poses a little bigger than any before rarely reallocate
+            renderer->vertex_buffer_size = std::max(num_command_vertices, renderer->vertex_buffer_size * 2);
+            SpineExtension::free(renderer->vertex_buffer, __FILE__, __LINE__);
+            renderer->vertex_buffer = SpineExtension::alloc<raster_vertex_t>(renderer->vertex_buffer_size, __FILE__, __LINE__);
+        }
+        raster_vertex_t* vertices = renderer->vertex_buffer;
+        for (int i = 0, j = 0; i < num_command_vertices; i++, j += 2) {
+            raster_vertex_t* vertex = &vertices[i];
+            // Same projection as matrix_ortho_projection, flipped to glReadPixels row order
+            vertex->x = command->positions[j] * renderer->scale;
+            vertex->y = renderer->height - command->positions[j + 1] * renderer->scale;
+            vertex->u = command->uvs[j];
+            vertex->v = command->uvs[j + 1];
+            unpack_color(command->colors[i], vertex->color);
+            unpack_color(command->darkColors[i], vertex->darkColor);
+        }
+        const software_blend_mode_t* mode = &software_blend_modes[command->blendMode];
+        for (int i = 0; i + 2 < command->numIndices; i += 3) {
+            rasterize_triangle(renderer, texture, mode, premultipliedAlpha,
+                &vertices[command->indices[i]], &vertices[command->indices[i + 1]], &vertices[command->indices[i + 2]]);
+        }
+        command = command->next;
+    }
+}
+
+void software_renderer_draw(software_renderer_t* renderer, Skeleton* skeleton, bool premultipliedAlpha) {
+    RenderCommand* command;
+    {
+        ScopedPhaseTimer timer(renderer->stats.render);
+        command = renderer->renderer->render(*skeleton);
+    }
+    ScopedPhaseTimer timer(renderer->stats.submit);
+    software_renderer_draw_commands(renderer, command, premultipliedAlpha);
+}
+
+void software_renderer_dispose(software_renderer_t* renderer) {
+    if (renderer->owns_pixels) free(renderer->pixels);
+    SpineExtension::free(renderer->vertex_buffer, __FILE__, __LINE__);
+    delete renderer->renderer;
+    free(renderer);
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+#include <spine/spine.h>
+#include "spine-vertex.h"
+
+/// A CPU-side RGBA8 image, the texture type of the software renderer
+typedef struct {
+    int width;
+    int height;
+    uint8_t* pixels;
+} image_t;
+
+/// Loads the given image and expands it to RGBA8 the same way OpenGL expands RED/RGB textures
+image_t* image_load(const char* file_path);
+
+/// Disposes the image
+void image_dispose(image_t* image);
+
+/// A set of images decoded in parallel by a shared pool of worker threads. The pool starts with the
+/// first batch and its threads are joined when the last batch is disposed.
+typedef struct image_batch_t image_batch_t;
+
+/// Sets the number of decoding threads the pool starts with, 0 for one per core up to 8. Applies the
+/// next time the pool starts, so only once every batch has been disposed.
+void image_batch_threads(int count);
+
+/// Creates an empty batch
+image_batch_t* image_batch_create();
+
+/// Queues decoding the given image with image_load and returns its index in the batch
+int image_batch_add(image_batch_t* batch, const char* file_path);
+
+/// Waits until every queued image has been decoded
+void image_batch_wait(image_batch_t* batch);
+
+/// Waits for the image at the given index and takes it, nullptr if it failed to load or was
+/// already taken. The caller disposes the returned image.
+image_t* image_batch_take(image_batch_t* batch, int index);
+
+/// Waits for queued images and disposes the batch together with the images not taken
+void image_batch_dispose(image_batch_t* batch);
+
+/// A TextureLoader that only queues decoding the pages on an image_batch_t while the atlas is
+/// loaded, so the pages decode in parallel and the atlas can be loaded on any thread. upload() then
+/// creates the textures on the thread they belong to, with createTexture. Each atlas needs its own
+/// loader, which must outlive the atlas.
+class DeferredTextureLoader : public spine::TextureLoader {
+public:
+    DeferredTextureLoader();
+    ~DeferredTextureLoader();
+    void load(spine::AtlasPage &page, const spine::String &path);
+    void unload(void *texture);
+    /// Waits until all pages have been decoded
+    void wait();
+    /// Creates the textures of all pages queued so far, in page order, and points the atlas
+    /// pages and regions at them. Each page is uploaded as soon as it is decoded.
+    void upload(spine::Atlas &atlas);
+
+protected:
+    /// Creates the texture of a decoded page, nullptr leaves the page without one. The image is
+    /// disposed afterwards.
+    virtual void* createTexture(const image_t* image) = 0;
+    /// Disposes a texture createTexture returned
+    virtual void disposeTexture(void* texture) = 0;
+
+private:
+    image_batch_t* batch;
+    std::vector<std::pair<spine::AtlasPage*, int>> pages;
+};
+
+/// A TextureLoader implementation for the software renderer. Use this with spine::Atlas.
+class SoftwareTextureLoader : public spine::TextureLoader {
+public:
+    void load(spine::AtlasPage &page, const spine::String &path);
+    void unload(void *texture);
+};
+
+/// A vertex of a mesh generated from a Spine skeleton, projected to target pixel space
+typedef struct {
+    float x, y;
+    float u, v;
+    float color[4];
+    float darkColor[4];
+} raster_vertex_t;
+
+/// Renderer rasterizing the render commands of a skeleton on the CPU. The target is a
+/// width * height RGBA8 buffer laid out like the result of glReadPixels on the OpenGL
+/// renderer's framebuffer, and blending follows the OpenGL blend_modes table, so both
+/// renderers produce the same premultiplied image. With bgra set the target holds BGRA8
+/// instead, the layout of a top-down 32-bit DIB section.
+typedef struct {
+    int width;
+    int height;
+    float scale;
+    uint8_t* pixels;
+    bool owns_pixels;
+    bool bgra;
+    pixel_rect_t drawn; // pixels written since the last clear
+    int vertex_buffer_size;
+    raster_vertex_t* vertex_buffer;
+    aabb_t bounds; // of the vertices drawn since the last clear
+    spine::SkeletonRenderer* renderer;
+    render_stats_t stats;
+} software_renderer_t;
+
+/// Creates a new software renderer
+software_renderer_t* software_renderer_create();
+
+/// Sets the viewport size for the 2D orthographic projection. A size change replaces the target
+/// with a new transparent buffer owned by the renderer.
+void software_renderer_set_viewport_size(software_renderer_t* renderer, int width, int height, float scale);
+
+/// Renders into the given buffer of viewport size instead of an own one, in BGRA order if bgra
+/// is set. The buffer must be transparent or hold the last image drawn, since clearing only
+/// touches the drawn pixels. nullptr goes back to a transparent buffer owned by the renderer.
+void software_renderer_set_target(software_renderer_t* renderer, uint8_t* pixels, bool bgra);
+
+/// Clears the pixels drawn since the last clear to transparent black and resets the drawn bounds
+void software_renderer_clear(software_renderer_t* renderer);
+
+/// Rasterizes the given list of render commands into the target buffer
+void software_renderer_draw_commands(software_renderer_t* renderer, spine::RenderCommand* command, bool premultipliedAlpha);
+
+/// Draws the given skeleton. The skeleton's atlas must have been loaded with a SoftwareTextureLoader.
+void software_renderer_draw(software_renderer_t* renderer, spine::Skeleton* skeleton, bool premultipliedAlpha);
+
+/// Disposes the software renderer
+void software_renderer_dispose(software_renderer_t* renderer);
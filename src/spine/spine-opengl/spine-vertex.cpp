@@ -0,0 +1,389 @@
+#include "spine-vertex.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define VERTEX_PACK_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define VERTEX_PACK_TARGET_AVX2
+#else
+#define VERTEX_PACK_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(_M_ARM64) || defined(__aarch64__) || defined(__ARM_NEON)
+#define VERTEX_PACK_ARM
+#include <arm_neon.h>
+#endif
+
+using namespace spine;
+
+/// Swaps the red and blue bytes, ARGB -> ABGR, which is RGBA in memory on little endian
+static inline uint32_t swizzle_color(uint32_t color) {
+    return (color & 0xFF00FF00) | ((color & 0x00FF0000) >> 16) | ((color & 0x000000FF) << 16);
+}
+
+static void vertex_pack_range(vertex_t* vertices, const RenderCommand* command, int start) {
+    const float* positions = command->positions;
+    const float* uvs = command->uvs;
+    const uint32_t* colors = command->colors;
+    const uint32_t* darkColors = command->darkColors;
+    for (int i = start, j = start * 2; i < command->numVertices; i++, j += 2) {
+        vertex_t* vertex = &vertices[i];
+        vertex->x = positions[j];
+        vertex->y = positions[j + 1];
+        vertex->u = uvs[j];
+        vertex->v = uvs[j + 1];
+        vertex->color = swizzle_color(colors[i]);
+        vertex->darkColor = swizzle_color(darkColors[i]);
+    }
+}
+
+void vertex_pack_scalar(vertex_t* vertices, const RenderCommand* command) {
+    vertex_pack_range(vertices, command, 0);
+}
+
+// The vector kernels work on groups of 4 vertices. With P01 = [x0 y0 x1 y1], T01 = [u0 v0 u1 v1]
+// and CD01 = [c0 d0 c1 d1] the 6 output registers of a group are
+//   [x0 y0 c0 u0] [v0 d0 x1 y1] [c1 u1 v1 d1] and the same for vertices 2 and 3.
+
+#if defined(VERTEX_PACK_X86)
+
+static inline __m128i swizzle_colors_sse2(__m128i colors) {
+    __m128i ga = _mm_and_si128(colors, _mm_set1_epi32((int) 0xFF00FF00));
+    __m128i r = _mm_and_si128(_mm_srli_epi32(colors, 16), _mm_set1_epi32(0x000000FF));
+    __m128i b = _mm_slli_epi32(_mm_and_si128(colors, _mm_set1_epi32(0x000000FF)), 16);
+    return _mm_or_si128(ga, _mm_or_si128(r, b));
+}
+
+static inline void vertex_pack_pair_sse2(__m128i* out, __m128i p, __m128i t, __m128i cd) {
+    __m128i cu = _mm_unpacklo_epi32(cd, t);
+    __m128i uc = _mm_unpacklo_epi32(t, cd);
+    __m128i cudv = _mm_unpackhi_epi32(cd, t);
+    _mm_storeu_si128(out, _mm_unpacklo_epi64(p, cu));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi64(uc, p));
+    _mm_storeu_si128(out + 2, _mm_shuffle_epi32(cudv, _MM_SHUFFLE(2, 3, 1, 0)));
+}
+
+static void vertex_pack_sse2(vertex_t* vertices, const RenderCommand* command) {
+    const float* positions = command->positions;
+    const float* uvs = command->uvs;
+    const uint32_t* colors = command->colors;
+    const uint32_t* darkColors = command->darkColors;
+    int n = command->numVertices & ~3;
+    for (int i = 0; i < n; i += 4) {
+        __m128i p01 = _mm_loadu_si128((const __m128i*) (positions + i * 2));
+        __m128i p23 = _mm_loadu_si128((const __m128i*) (positions + i * 2 + 4));
+        __m128i t01 = _mm_loadu_si128((const __m128i*) (uvs + i * 2));
+        __m128i t23 = _mm_loadu_si128((const __m128i*) (uvs + i * 2 + 4));
+        __m128i c = swizzle_colors_sse2(_mm_loadu_si128((const __m128i*) (colors + i)));
+        __m128i d = swizzle_colors_sse2(_mm_loadu_si128((const __m128i*) (darkColors + i)));
+        __m128i* out = (__m128i*) &vertices[i];
+        vertex_pack_pair_sse2(out, p01, t01, _mm_unpacklo_epi32(c, d));
+        vertex_pack_pair_sse2(out + 3, p23, t23, _mm_unpackhi_epi32(c, d));
+    }
+    vertex_pack_range(vertices, command, n);
+}
+
+VERTEX_PACK_TARGET_AVX2
+static inline __m256i swizzle_colors_avx2(__m256i colors) {
+    __m256i ga = _mm256_and_si256(colors, _mm256_set1_epi32((int) 0xFF00FF00));
+    __m256i r = _mm256_and_si256(_mm256_srli_epi32(colors, 16), _mm256_set1_epi32(0x000000FF));
+    __m256i b = _mm256_slli_epi32(_mm256_and_si256(colors, _mm256_set1_epi32(0x000000FF)), 16);
+    return _mm256_or_si256(ga, _mm256_or_si256(r, b));
+}
+
+VERTEX_PACK_TARGET_AVX2
+static inline __m256i load_lanes_avx2(const float* low, const float* high) {
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*) low)),
+        _mm_loadu_si128((const __m128i*) high), 1);
+}
+
+/// Runs the SSE2 group layout on both 128-bit lanes at once, lane 0 holding vertices i..i+3 and
+/// lane 1 holding vertices i+4..i+7, then regroups the lanes into contiguous 256-bit stores.
+VERTEX_PACK_TARGET_AVX2
+static void vertex_pack_avx2(vertex_t* vertices, const RenderCommand* command) {
+    const float* positions = command->positions;
+    const float* uvs = command->uvs;
+    const uint32_t* colors = command->colors;
+    const uint32_t* darkColors = command->darkColors;
+    int n = command->numVertices & ~7;
+    for (int i = 0; i < n; i += 8) {
+        const float* p = positions + i * 2;
+        const float* t = uvs + i * 2;
+        __m256i p01 = load_lanes_avx2(p, p + 8);
+        __m256i p23 = load_lanes_avx2(p + 4, p + 12);
+        __m256i t01 = load_lanes_avx2(t, t + 8);
+        __m256i t23 = load_lanes_avx2(t + 4, t + 12);
+        __m256i c = swizzle_colors_avx2(_mm256_loadu_si256((const __m256i*) (colors + i)));
+        __m256i d = swizzle_colors_avx2(_mm256_loadu_si256((const __m256i*) (darkColors + i)));
+        __m256i cd01 = _mm256_unpacklo_epi32(c, d);
+        __m256i cd23 = _mm256_unpackhi_epi32(c, d);
+
+        __m256i o0 = _mm256_unpacklo_epi64(p01, _mm256_unpacklo_epi32(cd01, t01));
+        __m256i o1 = _mm256_unpackhi_epi64(_mm256_unpacklo_epi32(t01, cd01), p01);
+        __m256i o2 = _mm256_shuffle_epi32(_mm256_unpackhi_epi32(cd01, t01), _MM_SHUFFLE(2, 3, 1, 0));
+        __m256i o3 = _mm256_unpacklo_epi64(p23, _mm256_unpacklo_epi32(cd23, t23));
+        __m256i o4 = _mm256_unpackhi_epi64(_mm256_unpacklo_epi32(t23, cd23), p23);
+        __m256i o5 = _mm256_shuffle_epi32(_mm256_unpackhi_epi32(cd23, t23), _MM_SHUFFLE(2, 3, 1, 0));
+
+        __m256i* out = (__m256i*) &vertices[i];
+        _mm256_storeu_si256(out, _mm256_permute2x128_si256(o0, o1, 0x20));
+        _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(o2, o3, 0x20));
+        _mm256_storeu_si256(out + 2, _mm256_permute2x128_si256(o4, o5, 0x20));
+        _mm256_storeu_si256(out + 3, _mm256_permute2x128_si256(o0, o1, 0x31));
+        _mm256_storeu_si256(out + 4, _mm256_permute2x128_si256(o2, o3, 0x31));
+        _mm256_storeu_si256(out + 5, _mm256_permute2x128_si256(o4, o5, 0x31));
+    }
+    vertex_pack_range(vertices, command, n);
+}
+
+static bool cpu_supports_avx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#elif defined(VERTEX_PACK_ARM)
+
+static inline uint32x4_t swizzle_colors_neon(uint32x4_t colors) {
+    uint32x4_t ga = vandq_u32(colors, vdupq_n_u32(0xFF00FF00));
+    uint32x4_t r = vandq_u32(vshrq_n_u32(colors, 16), vdupq_n_u32(0x000000FF));
+    uint32x4_t b = vshlq_n_u32(vandq_u32(colors, vdupq_n_u32(0x000000FF)), 16);
+    return vorrq_u32(ga, vorrq_u32(r, b));
+}
+
+static inline void vertex_pack_pair_neon(uint32_t* out, uint32x4_t p, uint32x4_t t, uint32x4_t cd) {
+    uint32x4_t cu = vzipq_u32(cd, t).val[0];
+    uint32x4_t uc = vzipq_u32(t, cd).val[0];
+    uint32x4_t cudv = vzipq_u32(cd, t).val[1];
+    vst1q_u32(out, vcombine_u32(vget_low_u32(p), vget_low_u32(cu)));
+    vst1q_u32(out + 4, vcombine_u32(vget_high_u32(uc), vget_high_u32(p)));
+    vst1q_u32(out + 8, vcombine_u32(vget_low_u32(cudv), vrev64_u32(vget_high_u32(cudv))));
+}
+
+static void vertex_pack_neon(vertex_t* vertices, const RenderCommand* command) {
+    const uint32_t* positions = (const uint32_t*) command->positions;
+    const uint32_t* uvs = (const uint32_t*) command->uvs;
+    const uint32_t* colors = command->colors;
+    const uint32_t* darkColors = command->darkColors;
+    int n = command->numVertices & ~3;
+    for (int i = 0; i < n; i += 4) {
+        uint32x4_t c = swizzle_colors_neon(vld1q_u32(colors + i));
+        uint32x4_t d = swizzle_colors_neon(vld1q_u32(darkColors + i));
+        uint32x4x2_t cd = vzipq_u32(c, d);
+        uint32_t* out = (uint32_t*) &vertices[i];
+        vertex_pack_pair_neon(out, vld1q_u32(positions + i * 2), vld1q_u32(uvs + i * 2), cd.val[0]);
+        vertex_pack_pair_neon(out + 12, vld1q_u32(positions + i * 2 + 4), vld1q_u32(uvs + i * 2 + 4), cd.val[1]);
+    }
+    vertex_pack_range(vertices, command, n);
+}
+
+#endif
+
+typedef void (*vertex_pack_func_t)(vertex_t* vertices, const RenderCommand* command);
+
+static vertex_pack_isa_t select_vertex_pack_isa() {
+#if defined(VERTEX_PACK_X86)
+    return cpu_supports_avx2() ? VERTEX_PACK_AVX2 : VERTEX_PACK_SSE2;
+#elif defined(VERTEX_PACK_ARM)
+    return VERTEX_PACK_NEON;
+#else
+    return VERTEX_PACK_SCALAR;
+#endif
+}
+
+static vertex_pack_func_t select_vertex_pack_func(vertex_pack_isa_t isa) {
+    switch (isa) {
+#if defined(VERTEX_PACK_X86)
+    case VERTEX_PACK_AVX2: return vertex_pack_avx2;
+    case VERTEX_PACK_SSE2: return vertex_pack_sse2;
+#elif defined(VERTEX_PACK_ARM)
+    case VERTEX_PACK_NEON: return vertex_pack_neon;
+#endif
+    default: return vertex_pack_scalar;
+    }
+}
+
+static const vertex_pack_isa_t packIsa = select_vertex_pack_isa();
+static const vertex_pack_func_t packFunc = select_vertex_pack_func(packIsa);
+
+vertex_pack_isa_t vertex_pack_isa() {
+    return packIsa;
+}
+
+bool vertex_pack_isa_supported(vertex_pack_isa_t isa) {
+    switch (isa) {
+    case VERTEX_PACK_SCALAR: return true;
+#if defined(VERTEX_PACK_X86)
+    case VERTEX_PACK_SSE2: return true;
+    case VERTEX_PACK_AVX2: return cpu_supports_avx2();
+#elif defined(VERTEX_PACK_ARM)
+    case VERTEX_PACK_NEON: return true;
+#endif
+    default: return false;
+    }
+}
+
+void vertex_pack_with(vertex_pack_isa_t isa, vertex_t* vertices, const RenderCommand* command) {
+    select_vertex_pack_func(isa)(vertices, command);
+}
+
+void vertex_pack(vertex_t* vertices, const RenderCommand* command) {
+    packFunc(vertices, command);
+}
+
+void aabb_reset(aabb_t* box) {
+    box->min_x = box->min_y = INFINITY;
+    box->max_x = box->max_y = -INFINITY;
+}
+
+bool aabb_is_empty(const aabb_t* box) {
+    return box->min_x > box->max_x || box->min_y > box->max_y;
+}
+
+void aabb_add_positions(aabb_t* box, const float* positions, int num_vertices) {
+    float min_x = box->min_x, min_y = box->min_y, max_x = box->max_x, max_y = box->max_y;
+    for (int i = 0; i < num_vertices * 2; i += 2) {
+        min_x = std::min(min_x, positions[i]);
+        max_x = std::max(max_x, positions[i]);
+        min_y = std::min(min_y, positions[i + 1]);
+        max_y = std::max(max_y, positions[i + 1]);
+    }
+    box->min_x = min_x;
+    box->min_y = min_y;
+    box->max_x = max_x;
+    box->max_y = max_y;
+}
+
+bool pixel_rect_is_empty(const pixel_rect_t* rect) {
+    return rect->width <= 0 || rect->height <= 0;
+}
+
+pixel_rect_t pixel_rect_union(const pixel_rect_t* a, const pixel_rect_t* b) {
+    if (pixel_rect_is_empty(a)) return pixel_rect_is_empty(b) ? pixel_rect_t { 0, 0, 0, 0 } : *b;
+    if (pixel_rect_is_empty(b)) return *a;
+    int x = std::min(a->x, b->x);
+    int y = std::min(a->y, b->y);
+    int right = std::max(a->x + a->width, b->x + b->width);
+    int top = std::max(a->y + a->height, b->y + b->height);
+    return { x, y, right - x, top - y };
+}
+
+void dirty_tracker_reset(dirty_tracker_t* tracker, int width, int height, float scale) {
+    tracker->width = width;
+    tracker->height = height;
+    tracker->scale = scale;
+    tracker->previous = { 0, 0, 0, 0 };
+    aabb_reset(&tracker->previous_bounds);
+    tracker->motion = 0.0f;
+}
+
+/// Largest distance between corresponding edges of two boxes, or the larger side of the only
+/// non-empty box since appearing or vanishing content moves at least that much
+static float aabb_displacement(const aabb_t* a, const aabb_t* b) {
+    bool a_empty = aabb_is_empty(a), b_empty = aabb_is_empty(b);
+    if (a_empty && b_empty) return 0.0f;
+    if (a_empty || b_empty) {
+        const aabb_t* box = a_empty ? b : a;
+        return std::max(box->max_x - box->min_x, box->max_y - box->min_y);
+    }
+    return std::max(std::max(std::fabs(a->min_x - b->min_x), std::fabs(a->max_x - b->max_x)),
+        std::max(std::fabs(a->min_y - b->min_y), std::fabs(a->max_y - b->max_y)));
+}
+
+pixel_rect_t dirty_tracker_update(dirty_tracker_t* tracker, const aabb_t* bounds) {
+    pixel_rect_t current = { 0, 0, 0, 0 };
+    if (!aabb_is_empty(bounds)) {
+        // Same projection as matrix_ortho_projection, the y axis points up in both spaces.
+        // Rounding outwards keeps every pixel whose center a triangle may cover.
+        float s = tracker->scale;
+        float left = std::max(std::floor(bounds->min_x * s), 0.0f);
+        float right = std::min(std::ceil(bounds->max_x * s), (float) tracker->width);
+        float bottom = std::max(std::floor(tracker->height - bounds->max_y * s), 0.0f);
+        float top = std::min(std::ceil(tracker->height - bounds->min_y * s), (float) tracker->height);
+        if (left < right && bottom < top)
+            current = { (int) left, (int) bottom, (int) (right - left), (int) (top - bottom) };
+    }
+    pixel_rect_t dirty = pixel_rect_union(&current, &tracker->previous);
+    tracker->previous = current;
+    tracker->motion = aabb_displacement(bounds, &tracker->previous_bounds) * tracker->scale;
+    tracker->previous_bounds = *bounds;
+    return dirty;
+}
+
+void frame_init(frame_t* frame) {
+    frame->num_vertices = 0;
+    frame->num_indices = 0;
+    frame->num_draws = 0;
+    frame->draw_capacity = 0;
+    frame->draws = nullptr;
+    aabb_reset(&frame->bounds);
+}
+
+void frame_plan(frame_t* frame, RenderCommand* command) {
+    frame->num_vertices = 0;
+    frame->num_indices = 0;
+    frame->num_draws = 0;
+    aabb_reset(&frame->bounds);
+    for (; command; command = command->next) {
+        if (command->numIndices == 0) continue;
+        if (frame->num_draws == frame->draw_capacity) {
+            frame->draw_capacity = frame->draw_capacity ? frame->draw_capacity * 2 : 16;
+            // Through the runtime's allocator, so the allocation checks of the frames see it
+            frame->draws = SpineExtension::realloc(frame->draws, frame->draw_capacity, __FILE__, __LINE__);
+        }
+        frame_draw_t* draw = &frame->draws[frame->num_draws++];
+        draw->first_index = frame->num_indices;
+        draw->num_indices = command->numIndices;
+        draw->base_vertex = frame->num_vertices;
+        draw->blend_mode = command->blendMode;
+        draw->texture = command->texture;
+        aabb_add_positions(&frame->bounds, command->positions, command->numVertices);
+        frame->num_vertices += command->numVertices;
+        frame->num_indices += command->numIndices;
+    }
+}
+
+void frame_pack(const frame_t* frame, RenderCommand* command, vertex_t* vertices, uint16_t* indices) {
+    for (int i = 0; command; command = command->next) {
+        if (command->numIndices == 0) continue;
+        const frame_draw_t* draw = &frame->draws[i++];
+        vertex_pack(vertices + draw->base_vertex, command);
+        memcpy(indices + draw->first_index, command->indices, sizeof(uint16_t) * command->numIndices);
+    }
+}
+
+void frame_dispose(frame_t* frame) {
+    SpineExtension::free(frame->draws, __FILE__, __LINE__);
+    frame_init(frame);
+}
+
+int stream_ring_reserve(stream_ring_t* ring, int count, bool* orphan) {
+    *orphan = false;
+    if (count > ring->capacity) {
+        int capacity = ring->capacity ? ring->capacity : 1024;
+        while (capacity < count) capacity *= 2;
+        ring->capacity = capacity;
+        ring->offset = 0;
+        *orphan = true;
+    } else if (ring->offset + count > ring->capacity) {
+        ring->offset = 0;
+        *orphan = true;
+    }
+    int offset = ring->offset;
+    ring->offset += count;
+    return offset;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <stdint.h>
+#include <spine/spine.h>
+#include "PhaseStats.h"
+
+/// A vertex of a mesh generated from a Spine skeleton
+struct vertex_t {
+    float x, y;
+    uint32_t color;
+    float u, v;
+    uint32_t darkColor;
+};
+
+/// Instruction set used by vertex_pack, picked once at runtime from what the CPU supports
+typedef enum {
+    VERTEX_PACK_SCALAR,
+    VERTEX_PACK_SSE2,
+    VERTEX_PACK_AVX2,
+    VERTEX_PACK_NEON
+} vertex_pack_isa_t;
+
+/// Returns the instruction set vertex_pack dispatches to
+vertex_pack_isa_t vertex_pack_isa();
+
+/// Packs the positions, uvs and colors of a render command into interleaved vertex_t records,
+/// swizzling the ARGB colors of the command to the RGBA byte order of the vertex attributes.
+/// vertices must hold at least command->numVertices records.
+void vertex_pack(vertex_t* vertices, const spine::RenderCommand* command);
+
+/// Same as vertex_pack, always using the scalar code path
+void vertex_pack_scalar(vertex_t* vertices, const spine::RenderCommand* command);
+
+/// Returns whether this CPU can run the given instruction set's code path of vertex_pack
+bool vertex_pack_isa_supported(vertex_pack_isa_t isa);
+
+/// Same as vertex_pack, using the code path of the given supported instruction set
+void vertex_pack_with(vertex_pack_isa_t isa, vertex_t* vertices, const spine::RenderCommand* command);
+
+/// Axis-aligned bounding box of skeleton-space positions, empty while min_x > max_x
+typedef struct {
+    float min_x, min_y;
+    float max_x, max_y;
+} aabb_t;
+
+/// Empties the box
+void aabb_reset(aabb_t* box);
+
+/// Returns whether the box contains no point
+bool aabb_is_empty(const aabb_t* box);
+
+/// Grows the box to contain the given interleaved x, y positions
+void aabb_add_positions(aabb_t* box, const float* positions, int num_vertices);
+
+/// A rectangle of viewport pixels, row y being the y-th row returned by glReadPixels
+typedef struct {
+    int x, y;
+    int width, height;
+} pixel_rect_t;
+
+/// Returns whether the rectangle contains no pixel
+bool pixel_rect_is_empty(const pixel_rect_t* rect);
+
+/// Returns the smallest rectangle containing both rectangles, ignoring empty ones
+pixel_rect_t pixel_rect_union(const pixel_rect_t* a, const pixel_rect_t* b);
+
+/// Tracks which pixels of a viewport a frame changed. A frame without a background only
+/// touches the pixels its vertices cover and the pixels the previous frame covered, which it
+/// clears, so everything outside the union of both boxes stays transparent.
+typedef struct {
+    int width;
+    int height;
+    float scale;
+    pixel_rect_t previous;
+    aabb_t previous_bounds;
+    float motion; // pixels the farthest edge of the last frame's box moved from the previous box
+} dirty_tracker_t;
+
+/// Sets the viewport projected to, with the projection of matrix_ortho_projection, and forgets
+/// the previous frame. The caller must clear everything it kept of the old viewport.
+void dirty_tracker_reset(dirty_tracker_t* tracker, int width, int height, float scale);
+
+/// Returns the pixels changed by a frame whose vertices have the given bounds and remembers
+/// the frame's own pixels for the next call
+pixel_rect_t dirty_tracker_update(dirty_tracker_t* tracker, const aabb_t* bounds);
+
+/// A draw of a packed frame: a range of the frame's index buffer whose indices are relative
+/// to base_vertex, rendered with the blend mode and texture of one RenderCommand
+typedef struct {
+    int first_index;
+    int num_indices;
+    int base_vertex;
+    spine::BlendMode blend_mode;
+    void* texture;
+} frame_draw_t;
+
+/// Layout of all render commands of a frame in one vertex buffer and one index buffer
+typedef struct {
+    int num_vertices;
+    int num_indices;
+    int num_draws;
+    int draw_capacity;
+    frame_draw_t* draws;
+    aabb_t bounds; // of the vertices of all draws
+} frame_t;
+
+/// Initializes an empty frame
+void frame_init(frame_t* frame);
+
+/// Plans the offsets of every command in the frame's buffers and computes the frame's bounds.
+/// Indices of a command are kept as they are and addressed through the draw's base_vertex.
+void frame_plan(frame_t* frame, spine::RenderCommand* command);
+
+/// Writes the commands planned by frame_plan into the given buffers, which must hold at least
+/// frame->num_vertices vertices and frame->num_indices indices
+void frame_pack(const frame_t* frame, spine::RenderCommand* command, vertex_t* vertices, uint16_t* indices);
+
+/// Frees the draws of the frame
+void frame_dispose(frame_t* frame);
+
+/// Histograms a renderer records the phases of its draws in, each may be null
+typedef struct {
+    PhaseHistogram* render; // SkeletonRenderer::render
+    PhaseHistogram* pack; // frame planning, vertex packing and buffer upload
+    PhaseHistogram* submit; // draw calls, or rasterization for the software renderer
+} render_stats_t;
+
+/// Write cursor of a streamed GPU buffer. Frames are appended one after another until the
+/// buffer is full, then the storage is orphaned and writing restarts at offset 0, so the
+/// driver never has to wait for draws still reading older frames.
+typedef struct {
+    int capacity;
+    int offset;
+} stream_ring_t;
+
+/// Reserves count elements and returns their offset. Sets orphan when the storage must be
+/// reallocated with the (possibly grown) ring capacity before writing.
+int stream_ring_reserve(stream_ring_t* ring, int count, bool* orphan);
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+/// Checks of the unit tests, which are plain executables run by ctest. A failed check prints
+/// where it failed and the test goes on, check_exit_code() then reports the failure.
+inline int checkFailures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            checkFailures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        auto checkActual = (actual); \
+        auto checkExpected = (expected); \
+        if (!(checkActual == checkExpected)) { \
+            std::printf("%s:%d: CHECK_EQ(%s, %s) failed: %g != %g\n", __FILE__, __LINE__, #actual, #expected, \
+                (double) checkActual, (double) checkExpected); \
+            checkFailures++; \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        double checkActual = (actual); \
+        double checkExpected = (expected); \
+        if (!(std::fabs(checkActual - checkExpected) <= (tolerance))) { \
+            std::printf("%s:%d: CHECK_NEAR(%s, %s) failed: %g != %g\n", __FILE__, __LINE__, #actual, #expected, \
+                checkActual, checkExpected); \
+            checkFailures++; \
+        } \
+    } while (0)
+
+/// The exit code of a test: 0 if every check passed
+inline int check_exit_code() {
+    if (checkFailures) std::printf("%d checks failed\n", checkFailures);
+    return checkFailures ? 1 : 0;
+}
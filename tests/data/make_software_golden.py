@@ -0,0 +1,119 @@
+# Writes the texture and the expected image of test_spine_software.cpp. The expected image comes
+# from this reference of the OpenGL pipeline the software renderer follows: pixel-center sampling
+# with the top-left fill rule, GL_LINEAR with GL_CLAMP_TO_EDGE, the fragment shader of
+# renderer_create and the blend functions of blend_modes. Run it from this directory.
+import struct
+import zlib
+
+WIDTH, HEIGHT = 32, 24
+
+def texture_pixel(x, y):
+    return (40 + 60 * x, 40 + 60 * y, 200 - 40 * x, 255 if (x + y) % 3 else 140)
+
+TEXTURE = [[texture_pixel(x, y) for x in range(4)] for y in range(4)]
+
+NORMAL, ADDITIVE, MULTIPLY, SCREEN = range(4)
+QUAD_UVS = [0, 1, 1, 1, 1, 0, 0, 0]
+# blend mode, positions, uvs, ARGB colors, ARGB dark colors, indices, same as the test's commands
+COMMANDS = [
+    (NORMAL, [3, 3, 29, 3, 29, 21, 3, 21], QUAD_UVS, [0xFFFFFFFF] * 4, [0] * 4, [0, 1, 2, 2, 3, 0]),
+    (ADDITIVE, [5.3, 2.7, 26.6, 12.1, 9.2, 22.4], [0.1, 0.1, 0.9, 0.2, 0.4, 0.8],
+        [0x80FF0000, 0xC000FF00, 0xFF0000FF], [0] * 3, [0, 1, 2]),
+    (MULTIPLY, [12.25, 6.5, 20.5, 6.5, 20.5, 14.75, 12.25, 14.75], QUAD_UVS,
+        [0xFFFF8040] * 4, [0xFF203040] * 4, [0, 1, 2, 2, 3, 0]),
+    (SCREEN, [1.6, 20.1, 14.2, 23.3, 22.9, 15.4], [0, 0, 1, 0, 0.5, 1], [0xB0FFFFFF] * 3, [0] * 3, [0, 2, 1]),
+]
+
+ONE, SRC_ALPHA, ONE_MINUS_SRC_ALPHA, DST_COLOR, ONE_MINUS_SRC_COLOR = range(5)
+# source color, source color with premultiplied alpha, destination, source alpha
+BLEND_MODES = [
+    (SRC_ALPHA, ONE, ONE_MINUS_SRC_ALPHA, ONE),
+    (SRC_ALPHA, ONE, ONE, ONE),
+    (DST_COLOR, DST_COLOR, ONE_MINUS_SRC_ALPHA, ONE_MINUS_SRC_ALPHA),
+    (ONE, ONE, ONE_MINUS_SRC_COLOR, ONE_MINUS_SRC_COLOR),
+]
+
+def clamp01(value):
+    return min(max(value, 0.0), 1.0)
+
+def unpack(color):
+    return [((color >> 16) & 255) / 255, ((color >> 8) & 255) / 255, (color & 255) / 255, ((color >> 24) & 255) / 255]
+
+def sample(u, v):
+    x, y = u * 4 - 0.5, v * 4 - 0.5
+    x0, y0 = int(x // 1), int(y // 1)
+    tx, ty = x - x0, y - y0
+    def texel(px, py):
+        return TEXTURE[min(max(py, 0), 3)][min(max(px, 0), 3)]
+    out = []
+    for c in range(4):
+        top = texel(x0, y0)[c] + (texel(x0 + 1, y0)[c] - texel(x0, y0)[c]) * tx
+        bottom = texel(x0, y0 + 1)[c] + (texel(x0 + 1, y0 + 1)[c] - texel(x0, y0 + 1)[c]) * tx
+        out.append((top + (bottom - top) * ty) / 255)
+    return out
+
+def factor(kind, src, dst, c):
+    return {ONE: 1.0, SRC_ALPHA: src[3], ONE_MINUS_SRC_ALPHA: 1 - src[3], DST_COLOR: dst[c], ONE_MINUS_SRC_COLOR: 1 - src[c]}[kind]
+
+def edge(a, b, px, py):
+    return (b[0] - a[0]) * (py - a[1]) - (b[1] - a[1]) * (px - a[0])
+
+def top_left(a, b):
+    dx, dy = b[0] - a[0], b[1] - a[1]
+    return (dy == 0 and dx > 0) or dy < 0
+
+def draw(image, mode, vertices, margins):
+    v0, v1, v2 = vertices
+    area = edge(v0, v1, v2[0], v2[1])
+    if area == 0:
+        return
+    if area < 0:
+        v1, v2, area = v2, v1, -area
+    rules = (top_left(v1, v2), top_left(v2, v0), top_left(v0, v1))
+    # Quarter pixel coordinates are exact in single precision, so pixel centers on an edge are too
+    exact = all(float(v[i] * 4).is_integer() for v in vertices for i in range(2))
+    for y in range(HEIGHT):
+        for x in range(WIDTH):
+            px, py = x + 0.5, y + 0.5
+            w = [edge(v1, v2, px, py), edge(v2, v0, px, py), edge(v0, v1, px, py)]
+            if not exact:
+                margins.append(min(abs(value) for value in w) / area)
+            if any(value < 0 or (value == 0 and not rule) for value, rule in zip(w, rules)):
+                continue
+            w = [value / area for value in w]
+            def lerp(i):
+                return sum(v[i] * weight for v, weight in zip((v0, v1, v2), w))
+            light = [lerp(4 + c) for c in range(4)]
+            dark = [lerp(8 + c) for c in range(4)]
+            tex = sample(lerp(2), lerp(3))
+            src = [clamp01(((tex[3] - 1) * dark[3] + 1 - tex[c]) * dark[c] + tex[c] * light[c]) for c in range(3)]
+            src.append(clamp01(tex[3] * light[3]))
+            pixel = image[y][x]
+            dst = [value / 255 for value in pixel]
+            source_color, _, dest_color, source_alpha = BLEND_MODES[mode]
+            for c in range(3):
+                value = src[c] * factor(source_color, src, dst, c) + dst[c] * factor(dest_color, src, dst, c)
+                pixel[c] = int(clamp01(value) * 255 + 0.5)
+            alpha = src[3] * factor(source_alpha, src, dst, 3) + dst[3] * factor(dest_color, src, dst, 3)
+            pixel[3] = int(clamp01(alpha) * 255 + 0.5)
+
+def write_png(path, rows):
+    raw = b"".join(b"\0" + bytes(value for pixel in row for value in pixel) for row in rows)
+    def chunk(kind, data):
+        return struct.pack(">I", len(data)) + kind + data + struct.pack(">I", zlib.crc32(kind + data))
+    header = struct.pack(">IIBBBBB", len(rows[0]), len(rows), 8, 6, 0, 0, 0)
+    with open(path, "wb") as file:
+        file.write(b"\x89PNG\r\n\x1a\n" + chunk(b"IHDR", header) + chunk(b"IDAT", zlib.compress(raw)) + chunk(b"IEND", b""))
+
+image = [[[0, 0, 0, 0] for _ in range(WIDTH)] for _ in range(HEIGHT)]
+margins = []
+for mode, positions, uvs, colors, darks, indices in COMMANDS:
+    # Projected like software_renderer_draw_commands with scale 1, rows in glReadPixels order
+    vertices = [[positions[2 * i], HEIGHT - positions[2 * i + 1], uvs[2 * i], uvs[2 * i + 1]] + unpack(colors[i]) + unpack(darks[i])
+        for i in range(len(colors))]
+    for i in range(0, len(indices), 3):
+        draw(image, mode, [vertices[j] for j in indices[i:i + 3]], margins)
+# Pixel centers close to an edge could be covered differently in single precision
+assert min(margins) > 1e-5, min(margins)
+write_png("software_texture.png", TEXTURE)
+write_png("software_golden.png", image)
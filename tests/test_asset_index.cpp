@@ -0,0 +1,135 @@
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include "check.h"
+#include "WmaskEXAssetIndex.h"
+
+namespace fs = std::filesystem;
+
+static void writeFile(const fs::path& path, const std::string& content) {
+    fs::create_directories(path.parent_path());
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+/// Start of a 4.x binary skeleton: hash, version and bounds with floats big endian, then zeros
+/// standing in for the rest of the file
+static std::string skelHeader(const std::string& version, float x, float y, float width, float height) {
+    std::string header(8, '\x01');
+    header += (char) (version.size() + 1);
+    header += version;
+    for (float value : { x, y, width, height }) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int shift = 24; shift >= 0; shift -= 8) header += (char) ((bits >> shift) & 0xFF);
+    }
+    return header + std::string(64, '\0');
+}
+
+static std::string jsonSkeleton(const std::string& version) {
+    return "{\"skeleton\":{\"hash\":\"h\",\"spine\":\"" + version + "\",\"x\":-5.5,\"y\":-10,\"width\":11,\"height\":20},\"bones\":[]}";
+}
+
+/// Moves the directory's modification time forward, as a change of its entries would
+static void touchDirectory(const fs::path& dir) {
+    fs::last_write_time(dir, fs::last_write_time(dir) + std::chrono::seconds(5));
+}
+
+static const WmaskEXIndexedAsset* findAsset(const WmaskEXAssetIndex& index, const fs::path& path) {
+    for (const auto& asset : index.getAssets())
+        if (asset.path == path) return &asset;
+    return nullptr;
+}
+
+static void testAssetIndex(const fs::path& root) {
+    fs::path assets = root / "assets";
+    writeFile(assets / "cover.png", "");
+    writeFile(assets / "notes.txt", "");
+    writeFile(assets / "a" / "a.atlas", "a.png\nsize: 64,64\npma: true\n");
+    writeFile(assets / "a" / "a.json", jsonSkeleton("3.8.99"));
+    // The binary skeleton wins over the json one of the same name
+    writeFile(assets / "a" / "b.atlas", "b.png\nsize: 64,64\n");
+    writeFile(assets / "a" / "b.json", jsonSkeleton("3.8.99"));
+    writeFile(assets / "a" / "b.skel", skelHeader("4.2.11", 1, 2, 3, 4));
+    // Images below the top level and atlases without skeleton are no assets
+    writeFile(assets / "a" / "deep" / "inner.png", "");
+    writeFile(assets / "a" / "deep" / "lonely.atlas", "");
+    fs::path indexPath = root / "index" / "assets.json";
+    const std::set<std::wstring> imageExtensions = { L".png", L".gif" };
+
+    WmaskEXAssetIndex index(assets, indexPath, imageExtensions);
+    CHECK(!index.load());
+    CHECK(index.refresh());
+    CHECK_EQ(index.getAssets().size(), (size_t) 3);
+    const WmaskEXIndexedAsset* image = findAsset(index, assets / "cover.png");
+    CHECK(image && !image->isSpine);
+    const WmaskEXIndexedAsset* a = findAsset(index, assets / "a" / "a.atlas");
+    CHECK(a && a->isSpine && a->version == "3.8.99" && a->pma == true);
+    if (a) {
+        CHECK_EQ(a->bounds.x, -5.5f);
+        CHECK_EQ(a->bounds.y, -10.0f);
+        CHECK_EQ(a->bounds.width, 11.0f);
+        CHECK_EQ(a->bounds.height, 20.0f);
+    }
+    const WmaskEXIndexedAsset* b = findAsset(index, assets / "a" / "b.atlas");
+    CHECK(b && b->version == "4.2.11" && !b->pma.has_value());
+    if (b) CHECK(b->bounds.x == 1 && b->bounds.y == 2 && b->bounds.width == 3 && b->bounds.height == 4);
+    CHECK(!index.refresh());
+
+    // A saved index loads with the same assets and needs no rescan
+    CHECK(index.save());
+    WmaskEXAssetIndex loaded(assets, indexPath, imageExtensions);
+    CHECK(loaded.load());
+    CHECK_EQ(loaded.getAssets().size(), (size_t) 3);
+    const WmaskEXIndexedAsset* loadedB = findAsset(loaded, assets / "a" / "b.atlas");
+    CHECK(loadedB && loadedB->version == "4.2.11" && loadedB->bounds.height == 4);
+    CHECK(!loaded.refresh());
+    WmaskEXAssetIndex other(root / "other", indexPath, imageExtensions);
+    CHECK(!other.load());
+
+    // Rewriting a skeleton or atlas in place leaves its directory's modification time alone but
+    // is still seen by the file's own
+    auto time = fs::last_write_time(assets / "a");
+    auto fileTime = fs::last_write_time(assets / "a" / "a.json");
+    writeFile(assets / "a" / "a.json", jsonSkeleton("4.0.64"));
+    fs::last_write_time(assets / "a" / "a.json", fileTime + std::chrono::seconds(5));
+    fs::last_write_time(assets / "a", time);
+    CHECK(loaded.refresh());
+    a = findAsset(loaded, assets / "a" / "a.atlas");
+    CHECK(a && a->version == "4.0.64");
+    writeFile(assets / "a" / "a.atlas", "a.png\nsize: 64,64\npma: false\n");
+    fs::last_write_time(assets / "a", time);
+    CHECK(loaded.refresh());
+    a = findAsset(loaded, assets / "a" / "a.atlas");
+    CHECK(a && a->pma == false);
+    CHECK(!loaded.refresh());
+    // The file times are saved with the index
+    CHECK(loaded.save());
+    WmaskEXAssetIndex reloaded(assets, indexPath, imageExtensions);
+    CHECK(reloaded.load());
+    CHECK(!reloaded.refresh());
+    touchDirectory(assets / "a");
+    CHECK(loaded.refresh());
+
+    // New and removed directories
+    writeFile(assets / "c" / "c.atlas", "c.png\n");
+    writeFile(assets / "c" / "c.skel", skelHeader("4.1.24", 0, 0, 8, 8));
+    touchDirectory(assets);
+    CHECK(loaded.refresh());
+    CHECK(findAsset(loaded, assets / "c" / "c.atlas") != nullptr);
+    fs::remove_all(assets / "a");
+    touchDirectory(assets);
+    CHECK(loaded.refresh());
+    CHECK_EQ(loaded.getAssets().size(), (size_t) 2);
+    CHECK(findAsset(loaded, assets / "a" / "a.atlas") == nullptr);
+}
+
+int main() {
+    fs::path root = fs::temp_directory_path() / ("wmaskex_test_asset_index_" + std::to_string(std::random_device()()));
+    fs::remove_all(root);
+    testAssetIndex(root);
+    fs::remove_all(root);
+    return check_exit_code();
+}
@@ -0,0 +1,174 @@
+#include <functional>
+#include <vector>
+#include "check.h"
+#include "WmaskEXBackendSelector.h"
+
+static const RenderBackend GL = RenderBackend::RB_OpenGL;
+static const RenderBackend SW = RenderBackend::RB_Software;
+
+/// Cost in ms of a frame drawn with the backend, the given number of frames after switching to it
+typedef std::function<float(RenderBackend backend, int sinceSwitch)> FrameCost;
+
+/// A view small enough to always try the software backend
+static const int smallView = 100 * 100;
+
+/// Draws count frames of the given size, each with the backend the selector picked after the
+/// previous one, and returns the backend each frame picked for the next. readbackShare of the cost
+/// of OpenGL frames is spent reading them back.
+static std::vector<RenderBackend> run(WmaskEXBackendSelector& selector, int count, const FrameCost& cost,
+    int pixels = smallView, float readbackShare = 0.0f) {
+    std::vector<RenderBackend> picked;
+    RenderBackend backend = selector.getBackend();
+    int sinceSwitch = 0;
+    for (int i = 0; i < count; i++) {
+        float frameCost = cost(backend, sinceSwitch);
+        float readbackCost = backend == GL ? frameCost * readbackShare : 0.0f;
+        RenderBackend next = selector.onFrame(frameCost, readbackCost, pixels);
+        sinceSwitch = next == backend ? sinceSwitch + 1 : 0;
+        backend = next;
+        picked.push_back(next);
+    }
+    return picked;
+}
+
+static FrameCost fixed(float gl, float sw) {
+    return [gl, sw](RenderBackend backend, int) { return backend == GL ? gl : sw; };
+}
+
+/// Index of the first frame that picked a backend other than the one before it, -1 if none did
+static int firstSwitch(const std::vector<RenderBackend>& picked, RenderBackend initial, int from = 0) {
+    RenderBackend previous = from == 0 ? initial : picked[from - 1];
+    for (int i = from; i < (int) picked.size(); i++) {
+        if (picked[i] != previous) return i;
+        previous = picked[i];
+    }
+    return -1;
+}
+
+static void testSwitchesToCheaper() {
+    WmaskEXBackendSelector selector(GL);
+    std::vector<RenderBackend> picked = run(selector, 1500, fixed(10, 5));
+    // 5 warm-up and 20 measured frames of each backend
+    CHECK_EQ(firstSwitch(picked, GL), 24);
+    CHECK_EQ(firstSwitch(picked, GL, 25), -1);
+    CHECK(selector.getBackend() == SW);
+
+    // Measured again after settleFrames, the software backend is still cheaper and is kept
+    picked = run(selector, 3000, fixed(10, 5));
+    int trial = firstSwitch(picked, SW);
+    CHECK(trial > 0);
+    CHECK(picked[trial] == GL);
+    CHECK_EQ(firstSwitch(picked, SW, trial + 1), trial + 25);
+    CHECK(selector.getBackend() == SW);
+}
+
+static void testSwitchMargin() {
+    // The other backend has to cost less than 0.8 of the current one
+    for (float sw : { 9.0f, 8.0f, 7.9f }) {
+        WmaskEXBackendSelector selector(GL);
+        std::vector<RenderBackend> picked = run(selector, 100, fixed(10, sw));
+        CHECK(picked[24] == SW);
+        CHECK(picked[49] == (sw < 8.0f ? SW : GL));
+        CHECK(picked.back() == picked[49]);
+    }
+}
+
+static void testHysteresis() {
+    WmaskEXBackendSelector selector(GL);
+    run(selector, 50, fixed(10, 7));
+    CHECK(selector.getBackend() == SW);
+
+    // OpenGL got somewhat cheaper than software, but not by the margin: software stays
+    std::vector<RenderBackend> picked = run(selector, 1600, fixed(6, 7));
+    CHECK(selector.getBackend() == SW);
+    int trial = firstSwitch(picked, SW);
+    CHECK(trial > 0);
+    CHECK(picked[trial + 25] == SW);
+
+    // Clearly cheaper, it wins the next measurement
+    run(selector, 1600, fixed(5, 7));
+    CHECK(selector.getBackend() == GL);
+}
+
+static void testWarmupAndSpikes() {
+    // Slow first frames after each switch are not measured
+    auto slowStart = [](RenderBackend backend, int sinceSwitch) -> float {
+        if (sinceSwitch < 5) return 100;
+        return backend == GL ? 10 : 7;
+    };
+    WmaskEXBackendSelector selector(GL);
+    run(selector, 50, slowStart);
+    CHECK(selector.getBackend() == SW);
+
+    // The median ignores spikes in up to half of the measured frames
+    auto spiky = [](RenderBackend backend, int sinceSwitch) -> float {
+        if (backend == SW && sinceSwitch >= 5 && sinceSwitch % 3 == 0) return 100;
+        return backend == GL ? 10 : 7;
+    };
+    WmaskEXBackendSelector spiked(GL);
+    run(spiked, 50, spiky);
+    CHECK(spiked.getBackend() == SW);
+}
+
+static void testCancel() {
+    WmaskEXBackendSelector selector(GL);
+    std::vector<RenderBackend> picked = run(selector, 25, fixed(10, 5));
+    CHECK(picked.back() == SW);
+    // Creating the software renderer failed, stay with OpenGL until the next measurement
+    selector.cancel();
+    CHECK(selector.getBackend() == GL);
+    picked = run(selector, 1499, fixed(10, 5));
+    CHECK_EQ(firstSwitch(picked, GL), -1);
+    picked = run(selector, 26, fixed(10, 5));
+    CHECK_EQ(firstSwitch(picked, GL), 25);
+}
+
+static void testReset() {
+    WmaskEXBackendSelector selector(SW);
+    run(selector, 30, fixed(5, 10));
+    CHECK(selector.getBackend() == GL);
+    // Reset during the trial measures the backend in use from the start
+    selector.reset();
+    std::vector<RenderBackend> picked = run(selector, 50, fixed(5, 10));
+    CHECK_EQ(firstSwitch(picked, GL), 24);
+    CHECK_EQ(firstSwitch(picked, GL, 25), 49);
+    CHECK(selector.getBackend() == GL);
+}
+
+static void testLargeViews() {
+    const int largeView = 512 * 512;
+    // Mostly rasterizing on the GPU, software is never tried, also not after settleFrames
+    WmaskEXBackendSelector selector(GL);
+    std::vector<RenderBackend> picked = run(selector, 3200, fixed(10, 5), largeView, 0.2f);
+    CHECK_EQ(firstSwitch(picked, GL), -1);
+
+    // Mostly reading back, it is tried and kept like for small views
+    WmaskEXBackendSelector readingBack(GL);
+    picked = run(readingBack, 50, fixed(10, 5), largeView, 0.6f);
+    CHECK_EQ(firstSwitch(picked, GL), 24);
+    CHECK(readingBack.getBackend() == SW);
+
+    // The view grew while rasterizing on the CPU, OpenGL is still tried and wins
+    picked = run(readingBack, 50, fixed(5, 10), largeView, 0.2f);
+    CHECK(readingBack.getBackend() == SW);
+    readingBack.reset();
+    picked = run(readingBack, 50, fixed(5, 10), largeView, 0.2f);
+    CHECK_EQ(firstSwitch(picked, SW), 24);
+    CHECK(readingBack.getBackend() == GL);
+
+    // At the limit the view still counts as small
+    WmaskEXBackendSelector limit(GL);
+    run(limit, 50, fixed(10, 5), WmaskEXBackendSelection().trialPixels, 0.0f);
+    CHECK(limit.getBackend() == SW);
+}
+
+int main() {
+    testSwitchesToCheaper();
+    testSwitchMargin();
+    testHysteresis();
+    testWarmupAndSpikes();
+    testCancel();
+    testReset();
+    testLargeViews();
+    return check_exit_code();
+}
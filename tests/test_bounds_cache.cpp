@@ -0,0 +1,171 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <string>
+#include "check.h"
+#include "WmaskEXBoundsCache.h"
+#include "spine-bounds.h"
+
+namespace fs = std::filesystem;
+
+/// Sampling step of SpineRuntime
+static const float boundsStep = 1.0f / 60.0f;
+
+static void writeFile(const fs::path& path, const std::string& content) {
+    fs::create_directories(path.parent_path());
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << content;
+}
+
+static bool sameBounds(const Bounds& bounds, float x, float y, float width, float height) {
+    const float tolerance = 1e-3f;
+    return std::fabs(bounds.x - x) <= tolerance && std::fabs(bounds.y - y) <= tolerance
+        && std::fabs(bounds.width - width) <= tolerance && std::fabs(bounds.height - height) <= tolerance;
+}
+
+/// Measures the asset like ISpineRuntime::measureBounds with the given skins
+static std::optional<std::map<std::string, Bounds>> measureAsset(const fs::path& atlas, const fs::path& skeleton, const std::vector<std::string>& skins) {
+    spine::Atlas* unpaged = nullptr;
+    spine::SkeletonData* data = skeleton_data_load_unpaged(atlas.string().c_str(), skeleton.string().c_str(), &unpaged);
+    if (!data) return std::nullopt;
+    std::map<std::string, Bounds> bounds = skeleton_data_measure(data, skins, boundsStep);
+    skeleton_data_dispose_unpaged(data, unpaged);
+    return bounds;
+}
+
+/// A 20x10 region, 40x10 in the skin "wide", shown still, moved 100 to the right or hidden
+static void testMeasuredBounds(const fs::path& data) {
+    fs::path atlas = data / "bounds.atlas", skeleton = data / "bounds.json";
+    auto bounds = measureAsset(atlas, skeleton, {});
+    CHECK(bounds.has_value());
+    if (!bounds) return;
+    CHECK_EQ(bounds->size(), 3);
+    CHECK(sameBounds((*bounds)["idle"], -10, -5, 20, 10));
+    CHECK(sameBounds((*bounds)["move"], -10, -5, 120, 10));
+    CHECK(sameBounds((*bounds)["hide"], 0, 0, 0, 0));
+
+    auto wide = measureAsset(atlas, skeleton, { "wide" });
+    CHECK(wide && sameBounds((*wide)["idle"], -20, -5, 40, 10));
+    auto united = measureAsset(atlas, skeleton, { "default", "wide" });
+    CHECK(united && sameBounds((*united)["move"], -20, -5, 140, 10));
+
+    spine::Atlas* unpaged = nullptr;
+    spine::SkeletonData* skeletonData = skeleton_data_load_unpaged(atlas.string().c_str(), skeleton.string().c_str(), &unpaged);
+    CHECK(skeletonData != nullptr);
+    if (skeletonData) {
+        Bounds move = skeleton_data_measure_animation(skeletonData, skeletonData->findAnimation("move"), {}, boundsStep);
+        CHECK(sameBounds(move, -10, -5, 120, 10));
+        skeleton_data_dispose_unpaged(skeletonData, unpaged);
+    }
+    CHECK(!measureAsset(atlas, data / "missing.json", {}));
+}
+
+static void testKeys(const fs::path& root) {
+    WmaskEXBoundsCache cache(root / "keys.json");
+    fs::path a = root / "asset" / "a.atlas", b = root / "asset" / "a.json";
+    writeFile(a, "atlas");
+    writeFile(b, "skeleton");
+
+    std::string key = cache.getKey({ a, b });
+    CHECK_EQ(key.size(), 16);
+    CHECK(key == cache.getKey({ a, b }));
+    CHECK(key != cache.getKey({ b, a }));
+    CHECK(cache.getKey({ a, root / "asset" / "missing.json" }).empty());
+
+    // Copies share the key, it only depends on the contents
+    writeFile(root / "copy" / "a.atlas", "atlas");
+    writeFile(root / "copy" / "a.json", "skeleton");
+    CHECK(key == cache.getKey({ root / "copy" / "a.atlas", root / "copy" / "a.json" }));
+
+    // A change of the same size is found through the modification time
+    auto time = fs::last_write_time(b);
+    writeFile(b, "SKELETON");
+    fs::last_write_time(b, time + std::chrono::seconds(5));
+    std::string changed = cache.getKey({ a, b });
+    CHECK(!changed.empty() && changed != key);
+    writeFile(b, "skeleton");
+    fs::last_write_time(b, time + std::chrono::seconds(10));
+    CHECK(key == cache.getKey({ a, b }));
+}
+
+static void testRequests(const fs::path& root, const fs::path& data) {
+    fs::path cachePath = root / "cache" / "bounds.json";
+    fs::path atlas = data / "bounds.atlas", skeleton = data / "bounds.json";
+    std::string key, missingKey = "0123456789abcdef";
+    {
+        WmaskEXBoundsCache cache(cachePath);
+        CHECK(!cache.load());
+        key = cache.getKey({ atlas, skeleton });
+        CHECK(!cache.find(key));
+
+        std::atomic<int> measured = 0, failed = 0;
+        auto measure = [&] {
+            measured++;
+            return measureAsset(atlas, skeleton, {});
+        };
+        auto fail = [&]() -> std::optional<std::map<std::string, Bounds>> {
+            failed++;
+            return std::nullopt;
+        };
+        cache.request(key, measure);
+        cache.request(key, measure);
+        cache.request(missingKey, fail);
+        cache.request("", measure);
+        cache.wait();
+        CHECK_EQ(measured.load(), 1);
+        CHECK_EQ(failed.load(), 1);
+
+        // The union of the animations leaves out the ones showing nothing
+        auto found = cache.find(key);
+        CHECK(found.has_value());
+        if (found) {
+            CHECK(sameBounds(found->bounds, -10, -5, 120, 10));
+            CHECK_EQ(found->animations.size(), 3);
+            CHECK(sameBounds(found->animations["move"], -10, -5, 120, 10));
+        }
+        CHECK(!cache.find(missingKey));
+
+        // Cached and failed keys are not measured again
+        cache.request(key, measure);
+        cache.request(missingKey, fail);
+        cache.wait();
+        CHECK_EQ(measured.load(), 1);
+        CHECK_EQ(failed.load(), 1);
+    }
+
+    // Saved after the measurement, and read back by the next run
+    CHECK(fs::exists(cachePath));
+    {
+        WmaskEXBoundsCache cache(cachePath);
+        CHECK(cache.load());
+        auto found = cache.find(key);
+        CHECK(found && sameBounds(found->bounds, -10, -5, 120, 10));
+        CHECK(found && sameBounds(found->animations["idle"], -10, -5, 20, 10));
+        CHECK(!cache.find(missingKey));
+    }
+
+    // A cache file of another version or a broken one is ignored
+    writeFile(cachePath, "{\"version\":0,\"assets\":{}}");
+    {
+        WmaskEXBoundsCache cache(cachePath);
+        CHECK(!cache.load());
+        CHECK(!cache.find(key));
+    }
+    writeFile(cachePath, "{\"version\":");
+    {
+        WmaskEXBoundsCache cache(cachePath);
+        CHECK(!cache.load());
+    }
+}
+
+int main(int argc, char** argv) {
+    fs::path data = argc > 1 ? argv[1] : "tests/data";
+    fs::path root = fs::temp_directory_path() / ("wmaskex_test_bounds_cache_" + std::to_string(std::random_device()()));
+    fs::remove_all(root);
+    testMeasuredBounds(data);
+    testKeys(root);
+    testRequests(root, data);
+    fs::remove_all(root);
+    return check_exit_code();
+}
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <vector>
+#include "check.h"
+#include "ISpineRuntime.h"
+#include "spine-alloc.h"
+
+namespace fs = std::filesystem;
+
+extern "C" ISpineRuntime* createSpineRuntime42();
+
+/// operator new calls while countNew is set, the runtime is linked in so this replacement serves it
+static std::atomic<bool> countNew = false;
+static std::atomic<uint64_t> newCalls = 0;
+
+void* operator new(size_t size) {
+    if (countNew.load(std::memory_order_relaxed)) newCalls.fetch_add(1, std::memory_order_relaxed);
+    if (void* mem = malloc(size ? size : 1)) return mem;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* mem) noexcept {
+    free(mem);
+}
+
+void operator delete(void* mem, size_t) noexcept {
+    free(mem);
+}
+
+static const int viewport = 256;
+static const float deltaTime = 1.0f / 60.0f;
+/// Frames after the first loop of an animation before counting, and frames counted after them
+static const int warmupFrames = 30;
+static const int countedFrames = 120;
+
+/// One frame of an overlay showing the animation, the same spine_bench --allocations draws
+static void drawOverlayFrame(ISpineRuntime& runtime, const std::string& animation) {
+    runtime.update(deltaTime);
+    if (runtime.hasChanged()) {
+        runtime.prepare(false);
+        runtime.draw(false);
+    }
+    runtime.getDirtyRect();
+    runtime.getAnimationBounds(animation);
+}
+
+/// Once an animation looped and warmed up, its frames on the software backend neither allocate from
+/// the spine allocator nor call operator new, drawing into the runtime's pixels or a target of the
+/// overlay's
+static void testNoFrameAllocations(const fs::path& atlas, const fs::path& skeleton) {
+    for (bool pixelTarget : { false, true }) {
+        std::unique_ptr<ISpineRuntime> runtime(createSpineRuntime42());
+        runtime->setRenderBackend(RenderBackend::RB_Software);
+        CHECK(runtime->init(atlas.string(), skeleton.string()));
+        std::vector<std::string> skins = runtime->getAllSkins();
+        if (!skins.empty()) runtime->setSkin(skins[0]);
+        runtime->createRenderer();
+        runtime->setViewportSize(viewport, viewport, 1.0f);
+        std::vector<unsigned char> target((size_t) viewport * viewport * 4, 0);
+        if (pixelTarget) runtime->setPixelTarget(target.data(), true);
+        for (const auto& [animation, duration] : runtime->getAllAnimations()) {
+            Bounds bounds = runtime->getAnimationBounds(animation);
+            float scale = bounds.width > 0 && bounds.height > 0 ? viewport / std::max(bounds.width, bounds.height) : 1.0f;
+            runtime->setScale(scale);
+            runtime->setPosition(-bounds.x * scale, -bounds.y * scale);
+            runtime->setAnimation(animation);
+            int loopFrames = (int) std::ceil(duration / deltaTime);
+            for (int frame = 0; frame < loopFrames + warmupFrames; frame++) drawOverlayFrame(*runtime, animation);
+
+            runtime->resetAllocationSites();
+            newCalls = 0;
+            countNew = true;
+            for (int frame = 0; frame < countedFrames; frame++) drawOverlayFrame(*runtime, animation);
+            countNew = false;
+            std::vector<AllocationSite> sites = runtime->getAllocationSites(5);
+            CHECK(sites.empty());
+            CHECK_EQ(newCalls.load(), 0);
+            for (const AllocationSite& site : sites)
+                fprintf(stderr, "%s %s: %s:%d allocated %llu times\n", skeleton.filename().string().c_str(), animation.c_str(),
+                    site.file.c_str(), site.line, (unsigned long long) (site.allocations + site.reallocations));
+        }
+        runtime->dispose();
+    }
+}
+
+int main(int argc, char** argv) {
+    // The runtime picks its allocator on first use, the counting pool reports every call site
+#if defined(_WIN32)
+    _putenv_s(SPINE_ALLOCATOR_VARIABLE, "pool-stats");
+#else
+    setenv(SPINE_ALLOCATOR_VARIABLE, "pool-stats", 1);
+#endif
+    fs::path data = argc > 1 ? argv[1] : "tests/data";
+    testNoFrameAllocations(data / "bounds.atlas", data / "bounds.json");
+    testNoFrameAllocations(data / "skinning.atlas", data / "skinning.json");
+    CHECK(spine_allocation_sites_counted());
+    return check_exit_code();
+}
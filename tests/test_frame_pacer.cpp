@@ -0,0 +1,141 @@
+#include <functional>
+#include <vector>
+#include "check.h"
+#include "WmaskEXFramePacer.h"
+
+/// An overlay driven by the pacer on a simulated clock: each frame is drawn at the deadline the
+/// previous one set, and the scene tells how far the content moved, how long the frame took and
+/// whether the overlay could be seen at that time
+struct SimulatedOverlay {
+    WmaskEXFramePacer pacer;
+    double now = 0; // ms
+    int interval = 0;
+    std::vector<int> intervals; // returned after each frame
+
+    explicit SimulatedOverlay(const WmaskEXFramePacing& pacing = WmaskEXFramePacing()) : pacer(pacing), interval(pacer.getInterval()) {}
+
+    /// Draws frames until the clock reaches end, speed in viewport pixels per second
+    void run(double end, const std::function<float(double)>& speed, const std::function<float(double)>& cost,
+        const std::function<bool(double)>& visible) {
+        while (now + interval <= end) {
+            now += interval;
+            float elapsed = (float) interval;
+            interval = pacer.onFrame(elapsed, cost(now), speed(now) * elapsed / 1000.0f, visible(now));
+            intervals.push_back(interval);
+        }
+    }
+};
+
+static float still(double) { return 0.0f; }
+static float moving(double) { return 300.0f; }
+static float cheap(double) { return 2.0f; }
+static bool shown(double) { return true; }
+
+static void testMovingRunsAtMinInterval() {
+    SimulatedOverlay overlay;
+    CHECK_EQ(overlay.interval, 40);
+    overlay.run(2000, moving, cheap, shown);
+    CHECK_EQ(overlay.intervals.size(), 50);
+    for (int interval : overlay.intervals) CHECK_EQ(interval, 40);
+}
+
+static void testIdleBacksOff() {
+    SimulatedOverlay overlay;
+    overlay.run(10000, still, cheap, shown);
+    // 5 idle frames at full rate, then 1.5 times longer each frame up to idleInterval
+    const int expected[] = { 40, 40, 40, 40, 40, 60, 90, 135, 200, 200, 200 };
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) CHECK_EQ(overlay.intervals[i], expected[i]);
+    CHECK_EQ(overlay.intervals.back(), 200);
+    CHECK(overlay.now > 10000 - 200);
+
+    // Content moving again gets the full rate back with its next frame
+    overlay.run(10600, moving, cheap, shown);
+    CHECK_EQ(overlay.intervals[overlay.intervals.size() - 3], 40);
+    CHECK_EQ(overlay.intervals.back(), 40);
+}
+
+static void testIdleSpeedThreshold() {
+    WmaskEXFramePacer pacer;
+    // 0.15 px in 40 ms is 3.75 px/s, below idleSpeed; 0.2 px is 5 px/s
+    for (int i = 0; i < 6; i++) pacer.onFrame(40, 1, 0.15f, true);
+    CHECK_EQ(pacer.getInterval(), 60);
+    CHECK_EQ(pacer.onFrame(40, 1, 0.2f, true), 40);
+    // A frame with no measurable time counts as idle
+    for (int i = 0; i < 6; i++) pacer.onFrame(0, 1, 50, true);
+    CHECK_EQ(pacer.getInterval(), 60);
+}
+
+static void testHiddenSkipsFrames() {
+    SimulatedOverlay overlay;
+    auto hiddenBetween = [](double now) { return now < 1000 || now >= 5000; };
+    overlay.run(1000, moving, cheap, hiddenBetween);
+    size_t shownFrames = overlay.intervals.size();
+    overlay.run(5000, moving, cheap, hiddenBetween);
+    // One frame notices the overlay is hidden, then one frame per hiddenInterval
+    CHECK_EQ(overlay.intervals[shownFrames - 1], 1000);
+    CHECK_EQ(overlay.intervals.size() - shownFrames, 4);
+    for (size_t i = shownFrames; i < overlay.intervals.size() - 1; i++) CHECK_EQ(overlay.intervals[i], 1000);
+
+    // Shown again, moving content runs at the full rate from the next frame
+    CHECK_EQ(overlay.intervals.back(), 40);
+    overlay.run(6000, moving, cheap, hiddenBetween);
+    CHECK_EQ(overlay.intervals.back(), 40);
+}
+
+static void testIdleAfterHidden() {
+    WmaskEXFramePacer pacer;
+    CHECK_EQ(pacer.onFrame(40, 1, 0, false), 1000);
+    // The idle count starts over once shown
+    for (int i = 0; i < 5; i++) CHECK_EQ(pacer.onFrame(1000, 1, 0, true), 40);
+    CHECK_EQ(pacer.onFrame(40, 1, 0, true), 60);
+
+    // Idle from the first frame, an interval already past idleInterval drops to it
+    WmaskEXFramePacing pacing;
+    pacing.idleFrames = 0;
+    WmaskEXFramePacer eager(pacing);
+    CHECK_EQ(eager.onFrame(40, 1, 0, true), 60);
+    CHECK_EQ(eager.onFrame(60, 1, 0, false), 1000);
+    CHECK_EQ(eager.onFrame(1000, 1, 0, true), 200);
+    CHECK_EQ(eager.onFrame(200, 1, 0, true), 200);
+}
+
+static void testCostStretchesInterval() {
+    WmaskEXFramePacer pacer;
+    // Frames may spend at most half of the interval working
+    CHECK_EQ(pacer.onFrame(40, 20, 10, true), 40);
+    CHECK_EQ(pacer.onFrame(40, 30, 10, true), 60);
+    CHECK_EQ(pacer.onFrame(60, 150, 10, true), 300);
+    // Never beyond the hidden interval
+    CHECK_EQ(pacer.onFrame(300, 800, 10, true), 1000);
+    CHECK_EQ(pacer.onFrame(1000, 5000, 10, false), 1000);
+    CHECK_EQ(pacer.onFrame(1000, 1, 10, true), 40);
+
+    SimulatedOverlay overlay;
+    overlay.run(3000, moving, [](double) { return 35.0f; }, shown);
+    for (int interval : overlay.intervals) CHECK_EQ(interval, 70);
+
+    WmaskEXFramePacing pacing;
+    pacing.maxCostShare = 0;
+    WmaskEXFramePacer unbounded(pacing);
+    CHECK_EQ(unbounded.onFrame(40, 500, 10, true), 40);
+}
+
+static void testReset() {
+    WmaskEXFramePacer pacer;
+    for (int i = 0; i < 8; i++) pacer.onFrame(40, 1, 0, true);
+    CHECK(pacer.getInterval() > 40);
+    pacer.reset();
+    CHECK_EQ(pacer.getInterval(), 40);
+    for (int i = 0; i < 5; i++) CHECK_EQ(pacer.onFrame(40, 1, 0, true), 40);
+}
+
+int main() {
+    testMovingRunsAtMinInterval();
+    testIdleBacksOff();
+    testIdleSpeedThreshold();
+    testHiddenSkipsFrames();
+    testIdleAfterHidden();
+    testCostStretchesInterval();
+    testReset();
+    return check_exit_code();
+}
@@ -0,0 +1,103 @@
+#include <cstdint>
+#include "check.h"
+#include "PhaseStats.h"
+
+/// Value percentile() reports for durations in the last bucket, 15 * 2^33 + 2^32 ns
+static const uint64_t lastBucketValue = 133143986176ull;
+
+/// The duration a histogram holding only the given one reports
+static uint64_t single(uint64_t ns) {
+    PhaseHistogram histogram;
+    histogram.add(ns);
+    return histogram.percentile(0.5);
+}
+
+static void testEmpty() {
+    PhaseHistogram histogram;
+    CHECK_EQ(histogram.getSamples(), 0);
+    CHECK_EQ(histogram.percentile(0.5), 0);
+    CHECK_EQ(histogram.percentile(0.99), 0);
+    PhaseStats stats = histogram.getStats("empty");
+    CHECK(stats.phase == "empty");
+    CHECK_EQ(stats.samples, 0);
+    CHECK_EQ(stats.p50, 0);
+    CHECK_EQ(stats.p99, 0);
+
+    histogram.add(1000);
+    histogram.reset();
+    CHECK_EQ(histogram.getSamples(), 0);
+    CHECK_EQ(histogram.percentile(0.5), 0);
+}
+
+static void testBucketEdges() {
+    // Exact below 16 ns: the exact buckets below 8 ns and the first power of two, 1 ns wide
+    for (uint64_t ns = 0; ns < 16; ns++) CHECK_EQ(single(ns), ns);
+    // Then 2 ns wide up to 32, reported by their midpoint
+    CHECK_EQ(single(16), 17);
+    CHECK_EQ(single(17), 17);
+    CHECK_EQ(single(18), 19);
+    CHECK_EQ(single(31), 31);
+    CHECK_EQ(single(32), 34);
+    CHECK_EQ(single(35), 34);
+    CHECK_EQ(single(36), 38);
+
+    // 8 buckets per power of two, each within 1/16 of the durations it holds
+    for (uint64_t ns = 16; ns < 100000; ns += 7)
+        CHECK_NEAR((double) single(ns), (double) ns, ns / 16.0);
+    for (uint64_t ns = 100000; ns < (1ull << 36); ns = ns * 3 / 2 + 1)
+        CHECK_NEAR((double) single(ns), (double) ns, ns / 16.0);
+}
+
+static void testOverflow() {
+    // 2^37 - 1 ns, about 137 s, is the last duration of the last bucket, longer ones clamp to it
+    CHECK_EQ(single((1ull << 37) - 1), lastBucketValue);
+    CHECK_EQ(single(1ull << 37), lastBucketValue);
+    CHECK_EQ(single(1ull << 50), lastBucketValue);
+    CHECK_EQ(single(UINT64_MAX), lastBucketValue);
+    CHECK(single((1ull << 37) - (1ull << 33) - 1) < lastBucketValue);
+
+    PhaseHistogram histogram;
+    histogram.add(100);
+    histogram.add(UINT64_MAX);
+    CHECK_EQ(histogram.getSamples(), 2);
+    CHECK_EQ(histogram.percentile(0.5), 100);
+    CHECK_EQ(histogram.percentile(1.0), lastBucketValue);
+}
+
+static void testPercentiles() {
+    // 1 to 1000 us, the nth percentile is n * 10 us
+    PhaseHistogram uniform;
+    for (uint64_t us = 1000; us >= 1; us--) uniform.add(us * 1000);
+    CHECK_EQ(uniform.getSamples(), 1000);
+    CHECK_NEAR((double) uniform.percentile(0.5), 500000, 500000 / 16.0);
+    CHECK_NEAR((double) uniform.percentile(0.99), 990000, 990000 / 16.0);
+    CHECK_NEAR((double) uniform.percentile(0.0), 1000, 1000 / 16.0);
+    CHECK_NEAR((double) uniform.percentile(1.0), 1000000, 1000000 / 16.0);
+    PhaseStats stats = uniform.getStats("uniform");
+    CHECK_EQ(stats.samples, 1000);
+    CHECK_NEAR(stats.p50, 0.5, 0.5 / 16);
+    CHECK_NEAR(stats.p99, 0.99, 0.99 / 16);
+
+    // A frame time of 100 ns with 2 % spikes of 2 ms: p99 is the 99th sample, so a spike
+    PhaseHistogram spikes;
+    for (int i = 0; i < 98; i++) spikes.add(100);
+    spikes.add(2000000);
+    spikes.add(2000000);
+    CHECK_EQ(spikes.percentile(0.5), 100);
+    CHECK_EQ(spikes.percentile(0.98), 100);
+    CHECK_NEAR((double) spikes.percentile(0.99), 2000000, 2000000 / 16.0);
+    // With only 1 % spikes p99 is the last regular sample
+    spikes.reset();
+    for (int i = 0; i < 99; i++) spikes.add(100);
+    spikes.add(2000000);
+    CHECK_EQ(spikes.percentile(0.99), 100);
+    CHECK_NEAR((double) spikes.percentile(1.0), 2000000, 2000000 / 16.0);
+}
+
+int main() {
+    testEmpty();
+    testBucketEdges();
+    testOverflow();
+    testPercentiles();
+    return check_exit_code();
+}
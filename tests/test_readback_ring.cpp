@@ -0,0 +1,190 @@
+#include <map>
+#include <string>
+#include <vector>
+#include "check.h"
+#include "WmaskEXReadbackRing.h"
+
+/// Slots in memory, read from a framebuffer whose pixels all hold the number of the frame drawn
+class FakeReadbackBackend : public WmaskEXReadbackBackend {
+public:
+    unsigned char frame = 0; // drawn into the framebuffer
+    bool failMap = false;
+    std::vector<std::string> calls;
+    std::map<int, size_t> sizes; // of the allocated slots
+
+    void allocate(int slot, size_t size) override {
+        calls.push_back("allocate " + std::to_string(slot));
+        buffers[slot].assign(size, 0);
+        sizes[slot] = size;
+    }
+
+    void read(int slot, const PixelRect& rect, int width) override {
+        calls.push_back("read " + std::to_string(slot));
+        for (int y = rect.y; y < rect.y + rect.height; y++)
+            for (int x = rect.x; x < rect.x + rect.width; x++)
+                for (int c = 0; c < 4; c++) buffers[slot][((size_t) y * width + x) * 4 + c] = frame;
+    }
+
+    const unsigned char* map(int slot) override {
+        calls.push_back("map " + std::to_string(slot));
+        return failMap ? nullptr : buffers[slot].data();
+    }
+
+    void unmap(int slot) override {
+        calls.push_back("unmap " + std::to_string(slot));
+    }
+
+    void release(int slot) override {
+        calls.push_back("release " + std::to_string(slot));
+        sizes.erase(slot);
+    }
+
+private:
+    std::map<int, std::vector<unsigned char>> buffers;
+};
+
+/// A frame the sink received, frame 0 if its pixels were nullptr
+struct Finished {
+    int frame;
+    PixelRect rect;
+};
+
+static const int width = 8, height = 4;
+
+struct Fixture {
+    FakeReadbackBackend backend;
+    std::vector<Finished> finished;
+    WmaskEXReadbackRing ring;
+
+    explicit Fixture(int slots = 2)
+        : ring(backend, [this](const unsigned char* pixels, const PixelRect& rect) {
+              // The frame number from the first pixel of the rect
+              int frame = pixels ? pixels[((size_t) rect.y * width + rect.x) * 4] : 0;
+              finished.push_back({ frame, rect });
+          }, slots) {}
+
+    void draw(unsigned char frame, const PixelRect& rect = { 1, 1, 3, 2 }) {
+        backend.frame = frame;
+        ring.submit(rect);
+    }
+};
+
+/// With 2 slots each frame reaches the sink one tick late, in order and only within its rect
+static void testOneFrameLatency() {
+    Fixture f;
+    f.ring.resize(width, height);
+    CHECK_EQ(f.backend.sizes.size(), 2);
+    CHECK_EQ(f.backend.sizes[0], (size_t) width * height * 4);
+
+    f.draw(1);
+    CHECK(!f.ring.complete());
+    CHECK(f.finished.empty());
+    for (int frame = 2; frame <= 5; frame++) {
+        f.draw(frame, { frame, 0, 2, 3 });
+        CHECK(f.ring.complete());
+        CHECK_EQ(f.finished.size(), frame - 1);
+        CHECK_EQ(f.finished.back().frame, frame - 1);
+        CHECK_EQ(f.ring.getInFlight(), 1);
+    }
+    CHECK_EQ(f.finished[2].rect.x, 3);
+    CHECK_EQ(f.finished[2].rect.height, 3);
+    // The slots alternate and each is unmapped after the sink ran
+    std::vector<std::string> expected = { "allocate 0", "allocate 1", "read 0", "read 1", "map 0", "unmap 0",
+        "read 0", "map 1", "unmap 1", "read 1", "map 0", "unmap 0", "read 0", "map 1", "unmap 1" };
+    CHECK(f.backend.calls == expected);
+}
+
+/// A full ring finishes its oldest frame before reading into that slot again
+static void testSubmitWhenFull() {
+    Fixture f(3);
+    f.ring.resize(width, height);
+    for (int frame = 1; frame <= 3; frame++) f.draw(frame);
+    CHECK(f.finished.empty());
+    f.draw(4);
+    CHECK_EQ(f.finished.size(), 1);
+    CHECK_EQ(f.finished[0].frame, 1);
+    CHECK_EQ(f.ring.getInFlight(), 3);
+}
+
+/// Resizing drops the frames in flight unmapped and reallocates every slot
+static void testResizeDropsInFlight() {
+    Fixture f;
+    f.ring.resize(width, height);
+    f.draw(1);
+    f.draw(2);
+    f.backend.calls.clear();
+    f.ring.resize(width / 2, height);
+    CHECK_EQ(f.ring.getInFlight(), 0);
+    CHECK(f.finished.empty());
+    CHECK(f.backend.calls == std::vector<std::string>({ "allocate 0", "allocate 1" }));
+    CHECK_EQ(f.backend.sizes[1], (size_t) width / 2 * height * 4);
+
+    // The next frames start over from the first slot
+    f.backend.calls.clear();
+    f.draw(3, { 0, 0, 1, 1 });
+    f.draw(4, { 0, 0, 1, 1 });
+    CHECK(f.ring.complete());
+    CHECK_EQ(f.finished.size(), 1);
+    CHECK_EQ(f.finished[0].frame, 3);
+    CHECK(f.backend.calls[0] == "read 0");
+}
+
+/// Flushing finishes every frame in flight in order
+static void testFlush() {
+    Fixture f(3);
+    f.ring.resize(width, height);
+    f.draw(1);
+    f.draw(2);
+    f.ring.flush();
+    CHECK_EQ(f.ring.getInFlight(), 0);
+    CHECK_EQ(f.finished.size(), 2);
+    CHECK_EQ(f.finished[0].frame, 1);
+    CHECK_EQ(f.finished[1].frame, 2);
+    f.ring.flush();
+    CHECK_EQ(f.finished.size(), 2);
+}
+
+/// Empty rects keep their place in line without a read, failed maps reach the sink as nullptr
+static void testEmptyAndFailed() {
+    Fixture f;
+    f.ring.resize(width, height);
+    f.backend.calls.clear();
+    f.draw(1, { 0, 0, 0, 0 });
+    f.draw(2);
+    CHECK(f.ring.complete());
+    CHECK_EQ(f.finished[0].frame, 0);
+    CHECK(f.backend.calls == std::vector<std::string>({ "read 1" }));
+
+    f.backend.failMap = true;
+    f.backend.calls.clear();
+    f.ring.flush();
+    CHECK_EQ(f.finished.size(), 2);
+    CHECK_EQ(f.finished[1].frame, 0);
+    CHECK(f.backend.calls == std::vector<std::string>({ "map 1" }));
+}
+
+/// Nothing is read before the first resize, and the slots are released with the ring
+static void testUnallocatedAndRelease() {
+    FakeReadbackBackend backend;
+    int finished = 0;
+    {
+        WmaskEXReadbackRing ring(backend, [&](const unsigned char*, const PixelRect&) { finished++; });
+        ring.submit({ 0, 0, 1, 1 });
+        CHECK_EQ(ring.getInFlight(), 0);
+        CHECK(backend.calls.empty());
+        ring.resize(width, height);
+    }
+    CHECK_EQ(finished, 0);
+    CHECK(backend.sizes.empty());
+    CHECK(backend.calls.back() == "release 1");
+}
+
+int main() {
+    testOneFrameLatency();
+    testSubmitWhenFull();
+    testResizeDropsInFlight();
+    testFlush();
+    testEmptyAndFailed();
+    testUnallocatedAndRelease();
+    return check_exit_code();
+}
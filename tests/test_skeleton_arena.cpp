@@ -0,0 +1,115 @@
+#include <cstring>
+#include <filesystem>
+#include "check.h"
+#include "spine-bounds.h"
+#include "spine-file.h"
+
+namespace fs = std::filesystem;
+using namespace spine;
+
+/// Counts what Skeleton.cpp allocates and frees, and fails its next calloc when armed, which is the
+/// arena of the next skeleton created
+class ArenaTestExtension : public Utf8SpineExtension {
+public:
+    bool failNextArena = false;
+    int skeletonAllocations = 0;
+    int skeletonFrees = 0;
+
+protected:
+    virtual void *_calloc(size_t size, const char *file, int line) override {
+        if (fromSkeleton(file)) {
+            if (failNextArena) {
+                failNextArena = false;
+                return nullptr;
+            }
+            skeletonAllocations++;
+        }
+        return Utf8SpineExtension::_calloc(size, file, line);
+    }
+
+    virtual void _free(void *mem, const char *file, int line) override {
+        if (mem && fromSkeleton(file)) skeletonFrees++;
+        Utf8SpineExtension::_free(mem, file, line);
+    }
+
+private:
+    static bool fromSkeleton(const char *file) {
+        return std::strstr(file, "Skeleton.cpp") && !std::strstr(file, "SkeletonData");
+    }
+};
+
+static ArenaTestExtension extension;
+
+/// Poses bone b of bounds.json away from the setup pose
+static void pose(Skeleton& skeleton) {
+    Bone* bone = skeleton.findBone("b");
+    bone->setX(30);
+    bone->setRotation(45);
+    bone->setScaleY(2);
+    skeleton.updateWorldTransform(Physics_Update);
+}
+
+static bool sameWorldTransforms(Skeleton& expected, Skeleton& actual) {
+    for (size_t i = 0; i < expected.getBones().size(); i++) {
+        Bone* e = expected.getBones()[i];
+        Bone* a = actual.getBones()[i];
+        if (e->getA() != a->getA() || e->getB() != a->getB() || e->getC() != a->getC() || e->getD() != a->getD()
+            || e->getWorldX() != a->getWorldX() || e->getWorldY() != a->getWorldY()) return false;
+    }
+    return true;
+}
+
+/// Without its arena a skeleton allocates every object on its own, poses the same and frees them all
+static void testWithoutArena(SkeletonData* data) {
+    for (bool boneTransformBlock : { false, true }) {
+        Skeleton expected(data, boneTransformBlock);
+        pose(expected);
+
+        extension.skeletonAllocations = 0;
+        extension.skeletonFrees = 0;
+        extension.failNextArena = true;
+        {
+            Skeleton skeleton(data, boneTransformBlock);
+            CHECK(!extension.failNextArena);
+            // Two bones, their world transforms and a slot, the transforms in one block when asked for
+            CHECK_EQ(extension.skeletonAllocations, boneTransformBlock ? 4 : 5);
+            CHECK_EQ(skeleton.getBoneTransforms() != nullptr, boneTransformBlock);
+            pose(skeleton);
+            CHECK(sameWorldTransforms(expected, skeleton));
+        }
+        CHECK_EQ(extension.skeletonFrees, extension.skeletonAllocations);
+    }
+}
+
+/// With its arena a skeleton allocates once whether or not the world transforms are in one block
+static void testArena(SkeletonData* data) {
+    for (bool boneTransformBlock : { false, true }) {
+        extension.skeletonAllocations = 0;
+        extension.skeletonFrees = 0;
+        {
+            Skeleton skeleton(data, boneTransformBlock);
+            CHECK_EQ(extension.skeletonAllocations, 1);
+            if (boneTransformBlock) {
+                float* transforms = skeleton.getBoneTransforms();
+                pose(skeleton);
+                CHECK_EQ(transforms[VertexSkinning::TransformStride + 4], skeleton.findBone("b")->getWorldX());
+            }
+        }
+        CHECK_EQ(extension.skeletonFrees, 1);
+    }
+}
+
+int main(int argc, char** argv) {
+    SpineExtension::setInstance(&extension);
+    fs::path data = argc > 1 ? argv[1] : "tests/data";
+    Atlas* unpaged = nullptr;
+    SkeletonData* skeletonData = skeleton_data_load_unpaged((data / "bounds.atlas").string().c_str(),
+        (data / "bounds.json").string().c_str(), &unpaged);
+    CHECK(skeletonData != nullptr);
+    if (skeletonData) {
+        testArena(skeletonData);
+        testWithoutArena(skeletonData);
+        skeleton_data_dispose_unpaged(skeletonData, unpaged);
+    }
+    return check_exit_code();
+}
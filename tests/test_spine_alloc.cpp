@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "spine-alloc.h"
+
+using namespace spine;
+
+static void fill(void* mem, size_t size, uint8_t seed) {
+    uint8_t* bytes = (uint8_t*) mem;
+    for (size_t i = 0; i < size; i++) bytes[i] = (uint8_t) (seed + i * 7);
+}
+
+static bool filled(const void* mem, size_t size, uint8_t seed) {
+    const uint8_t* bytes = (const uint8_t*) mem;
+    for (size_t i = 0; i < size; i++)
+        if (bytes[i] != (uint8_t) (seed + i * 7)) return false;
+    return true;
+}
+
+static const AllocationSite* findSite(const std::vector<AllocationSite>& sites, const char* file, int line) {
+    for (const AllocationSite& site : sites)
+        if (site.file == file && site.line == line) return &site;
+    return nullptr;
+}
+
+/// Size classes fit the size, grow with it, waste at most a fifth above 64 bytes and stop at 4 KiB
+static void testBlockSizes() {
+    bool fits = true, grows = true, wastesLittle = true, aligned = true, heapAbove = true;
+    size_t previous = 0;
+    for (size_t size = 0; size <= 8192; size++) {
+        size_t block = spine_pool_block_size(size);
+        fits &= block >= size;
+        grows &= block >= previous;
+        if (size > 64 && size <= 4096) wastesLittle &= (block - size) * 5 <= block;
+        if (size <= 4096) aligned &= block % 16 == 0;
+        else heapAbove &= block == size;
+        previous = block;
+    }
+    CHECK(fits);
+    CHECK(grows);
+    CHECK(wastesLittle);
+    CHECK(aligned);
+    CHECK(heapAbove);
+    CHECK_EQ(spine_pool_block_size(0), 16);
+    CHECK_EQ(spine_pool_block_size(4096), 4096);
+}
+
+/// A block stays in place while reallocated within its class and moves to the next one past it
+static void testReallocWithinClass() {
+    bool inPlace = true, moved = true, kept = true, aligned = true;
+    size_t low = 0;
+    while (low <= 4096) {
+        size_t high = spine_pool_block_size(low);
+        char* block = SpineExtension::alloc<char>(high, __FILE__, __LINE__);
+        aligned &= ((uintptr_t) block & 15) == 0;
+        fill(block, high, (uint8_t) high);
+        char* shrunk = SpineExtension::realloc(block, low, __FILE__, __LINE__);
+        inPlace &= shrunk == block;
+        char* grown = SpineExtension::realloc(shrunk, high + 1, __FILE__, __LINE__);
+        moved &= grown != block;
+        kept &= filled(grown, low, (uint8_t) high);
+        SpineExtension::free(grown, __FILE__, __LINE__);
+        low = high + 1;
+    }
+    CHECK(inPlace);
+    CHECK(moved);
+    CHECK(kept);
+    CHECK(aligned);
+}
+
+/// Contents survive reallocations between classes and the C heap in both directions
+static void testReallocAcrossClasses() {
+    const size_t sizes[] = { 10, 100, 1000, 4096, 5000, 100000, 3000, 20, 70000, 4097, 16, 0, 64 };
+    size_t size = 1;
+    char* block = SpineExtension::alloc<char>(size, __FILE__, __LINE__);
+    fill(block, size, 1);
+    for (size_t next : sizes) {
+        block = SpineExtension::realloc(block, next, __FILE__, __LINE__);
+        CHECK(block != nullptr);
+        CHECK(filled(block, std::min(size, next), 1));
+        fill(block, next, 1);
+        size = next;
+    }
+    SpineExtension::free(block, __FILE__, __LINE__);
+}
+
+/// Blocks freed by another thread are handed out again once that thread exits
+static void testCrossThreadFrees() {
+    const size_t count = 2000, size = 64;
+    std::vector<char*> blocks(count);
+    for (size_t i = 0; i < count; i++) {
+        blocks[i] = SpineExtension::alloc<char>(size, __FILE__, __LINE__);
+        fill(blocks[i], size, (uint8_t) i);
+    }
+    bool intact = true;
+    std::thread([&] {
+        for (size_t i = 0; i < count; i++) {
+            intact &= filled(blocks[i], size, (uint8_t) i);
+            SpineExtension::free(blocks[i], __FILE__, __LINE__);
+        }
+    }).join();
+    CHECK(intact);
+
+    std::set<char*> freed(blocks.begin(), blocks.end());
+    size_t reused = 0;
+    for (size_t i = 0; i < count; i++) {
+        blocks[i] = SpineExtension::alloc<char>(size, __FILE__, __LINE__);
+        reused += freed.count(blocks[i]);
+    }
+    // All but what this thread still cached, at most a batch
+    CHECK(reused >= count - 64);
+    for (char* block : blocks) SpineExtension::free(block, __FILE__, __LINE__);
+}
+
+/// Threads allocating while freeing what the others allocated never get a block someone still uses
+static void testConcurrentThreads() {
+    const int threadCount = 4, rounds = 20, perRound = 500;
+    std::vector<std::vector<char*>> handed(threadCount);
+    std::vector<uint8_t> intact(threadCount, 1);
+    auto sizeOf = [](int thread, int i) { return (size_t) (1 + (thread * 131 + i * 37) % 6000); };
+    for (int round = 0; round < rounds; round++) {
+        std::vector<std::vector<char*>> allocated(threadCount);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; t++) {
+            threads.emplace_back([&, t] {
+                // Free what the previous thread allocated last round while allocating anew
+                int from = (t + threadCount - 1) % threadCount;
+                std::vector<char*>& theirs = handed[from];
+                for (int i = 0; i < perRound; i++) {
+                    size_t size = sizeOf(t, i);
+                    char* block = SpineExtension::alloc<char>(size, __FILE__, __LINE__);
+                    fill(block, size, (uint8_t) (t + i));
+                    allocated[t].push_back(block);
+                    if (i < (int) theirs.size()) {
+                        if (!filled(theirs[i], sizeOf(from, i), (uint8_t) (from + i))) intact[t] = 0;
+                        SpineExtension::free(theirs[i], __FILE__, __LINE__);
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+        handed = std::move(allocated);
+    }
+    for (int t = 0; t < threadCount; t++) {
+        CHECK(intact[t]);
+        for (int i = 0; i < (int) handed[t].size(); i++) {
+            CHECK(filled(handed[t][i], sizeOf(t, i), (uint8_t) (t + i)));
+            SpineExtension::free(handed[t][i], __FILE__, __LINE__);
+        }
+    }
+}
+
+/// Sites are counted per file name and line, merging different paths to the same file
+static void testSites() {
+    // Two paths of the same file, as __FILE__ may differ between translation units
+    static const char fileA[] = "a/alloc_site.cpp";
+    static const char fileB[] = "b\\alloc_site.cpp";
+    spine_allocation_sites_reset();
+    char* first = SpineExtension::alloc<char>(100, fileA, 7);
+    char* second = SpineExtension::calloc<char>(50, fileB, 7);
+    second = SpineExtension::realloc(second, 300, fileA, 9);
+
+    std::vector<AllocationSite> sites = spine_allocation_sites(1000);
+    const AllocationSite* allocated = findSite(sites, "alloc_site.cpp", 7);
+    const AllocationSite* reallocated = findSite(sites, "alloc_site.cpp", 9);
+    CHECK(allocated && reallocated);
+    if (allocated && reallocated) {
+        CHECK_EQ(allocated->allocations, 2);
+        CHECK_EQ(allocated->reallocations, 0);
+        CHECK_EQ(allocated->bytes, 150);
+        // The reallocated block now belongs to the reallocating site
+        CHECK_EQ(allocated->liveBytes, 100);
+        CHECK_EQ(reallocated->allocations, 0);
+        CHECK_EQ(reallocated->reallocations, 1);
+        CHECK_EQ(reallocated->liveBytes, 300);
+    }
+    CHECK_EQ(spine_allocation_sites(1).size(), 1);
+
+    SpineExtension::free(second, fileA, 11);
+    spine_allocation_sites_reset();
+    CHECK(!findSite(spine_allocation_sites(1000), "alloc_site.cpp", 7));
+    // Resetting keeps the live bytes of blocks allocated before
+    char* third = SpineExtension::alloc<char>(10, fileA, 7);
+    sites = spine_allocation_sites(1000);
+    allocated = findSite(sites, "alloc_site.cpp", 7);
+    reallocated = findSite(sites, "alloc_site.cpp", 9);
+    CHECK(allocated && !reallocated);
+    if (allocated) {
+        CHECK_EQ(allocated->allocations, 1);
+        CHECK_EQ(allocated->frees, 0);
+        CHECK_EQ(allocated->liveBytes, 110);
+    }
+
+    SpineExtension::free(first, fileA, 12);
+    SpineExtension::free(third, fileA, 13);
+    sites = spine_allocation_sites(1000);
+    allocated = findSite(sites, "alloc_site.cpp", 7);
+    CHECK(allocated);
+    if (allocated) {
+        CHECK_EQ(allocated->frees, 2);
+        CHECK_EQ(allocated->liveBytes, 0);
+    }
+}
+
+int main() {
+    SpineExtension::setInstance(new PooledSpineExtension(true));
+    testBlockSizes();
+    testReallocWithinClass();
+    testReallocAcrossClasses();
+    testCrossThreadFrees();
+    testConcurrentThreads();
+    testSites();
+    return check_exit_code();
+}
@@ -0,0 +1,346 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "spine-software.h"
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+using namespace spine;
+
+/// Largest difference of a channel to the expected image, for rounding of single precision
+static const int tolerance = 2;
+
+/// A render command of the scene together with the storage it points to
+struct TestCommand {
+    BlendMode blendMode;
+    std::vector<float> positions;
+    std::vector<float> uvs;
+    std::vector<uint32_t> colors;
+    std::vector<uint32_t> darkColors;
+    std::vector<uint16_t> indices;
+};
+
+static const std::vector<float> quadUvs = { 0, 1, 1, 1, 1, 0, 0, 0 };
+
+/// The scene of data/make_software_golden.py, which computed data/software_golden.png from it
+static const std::vector<TestCommand> scene = {
+    { BlendMode_Normal, { 3, 3, 29, 3, 29, 21, 3, 21 }, quadUvs, std::vector<uint32_t>(4, 0xFFFFFFFF),
+        std::vector<uint32_t>(4, 0), { 0, 1, 2, 2, 3, 0 } },
+    { BlendMode_Additive, { 5.3f, 2.7f, 26.6f, 12.1f, 9.2f, 22.4f }, { 0.1f, 0.1f, 0.9f, 0.2f, 0.4f, 0.8f },
+        { 0x80FF0000, 0xC000FF00, 0xFF0000FF }, std::vector<uint32_t>(3, 0), { 0, 1, 2 } },
+    { BlendMode_Multiply, { 12.25f, 6.5f, 20.5f, 6.5f, 20.5f, 14.75f, 12.25f, 14.75f }, quadUvs,
+        std::vector<uint32_t>(4, 0xFFFF8040), std::vector<uint32_t>(4, 0xFF203040), { 0, 1, 2, 2, 3, 0 } },
+    { BlendMode_Screen, { 1.6f, 20.1f, 14.2f, 23.3f, 22.9f, 15.4f }, { 0, 0, 1, 0, 0.5f, 1 },
+        std::vector<uint32_t>(3, 0xB0FFFFFF), std::vector<uint32_t>(3, 0), { 0, 2, 1 } },
+};
+
+/// Links render commands for the scene, with a command without texture in between that the
+/// renderer must skip
+static std::vector<RenderCommand> makeCommands(std::vector<TestCommand>& commands, image_t* texture) {
+    std::vector<RenderCommand> result(commands.size() + 1);
+    for (size_t i = 0; i < commands.size(); i++) {
+        TestCommand& command = commands[i];
+        RenderCommand& render = result[i < 2 ? i : i + 1];
+        render.positions = command.positions.data();
+        render.uvs = command.uvs.data();
+        render.colors = command.colors.data();
+        render.darkColors = command.darkColors.data();
+        render.numVertices = (int) command.colors.size();
+        render.indices = command.indices.data();
+        render.numIndices = (int) command.indices.size();
+        render.blendMode = command.blendMode;
+        render.texture = texture;
+    }
+    // A copy of the first quad, drawn over everything if the renderer did not skip it
+    result[2] = result[0];
+    result[2].texture = nullptr;
+    for (size_t i = 0; i + 1 < result.size(); i++) result[i].next = &result[i + 1];
+    result.back().next = nullptr;
+    return result;
+}
+
+/// Compares the pixels with the expected image, swapping red and blue if bgra is set
+static void checkImage(const uint8_t* pixels, const image_t* expected, bool bgra) {
+    static const int rgba_order[4] = { 0, 1, 2, 3 };
+    static const int bgra_order[4] = { 2, 1, 0, 3 };
+    const int* order = bgra ? bgra_order : rgba_order;
+    int mismatches = 0;
+    for (int i = 0; i < expected->width * expected->height; i++) {
+        for (int c = 0; c < 4; c++) {
+            int actual = pixels[i * 4 + order[c]];
+            int wanted = expected->pixels[i * 4 + c];
+            if (std::abs(actual - wanted) <= tolerance) continue;
+            if (mismatches++ < 8)
+                std::printf("pixel %d, %d channel %d: %d, expected %d\n", i % expected->width, i / expected->width, c, actual, wanted);
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+static void testGoldenImage(const std::string& data) {
+    image_t* texture = image_load((data + "/software_texture.png").c_str());
+    image_t* golden = image_load((data + "/software_golden.png").c_str());
+    CHECK(texture && golden);
+    if (!texture || !golden) return;
+    std::vector<TestCommand> commands = scene;
+    std::vector<RenderCommand> render = makeCommands(commands, texture);
+
+    software_renderer_t* renderer = software_renderer_create();
+    software_renderer_set_viewport_size(renderer, golden->width, golden->height, 1.0f);
+    software_renderer_draw_commands(renderer, render.data(), false);
+    checkImage(renderer->pixels, golden, false);
+
+    // The drawn rectangle holds every pixel that is not transparent
+    const pixel_rect_t& drawn = renderer->drawn;
+    bool outside = false;
+    for (int y = 0; y < golden->height; y++)
+        for (int x = 0; x < golden->width; x++) {
+            bool inside = x >= drawn.x && x < drawn.x + drawn.width && y >= drawn.y && y < drawn.y + drawn.height;
+            if (!inside && renderer->pixels[(y * golden->width + x) * 4 + 3]) outside = true;
+        }
+    CHECK(!outside);
+    CHECK(!aabb_is_empty(&renderer->bounds));
+
+    // Clearing only touches the drawn rectangle and leaves the whole target transparent
+    software_renderer_clear(renderer);
+    bool cleared = true;
+    for (int i = 0; i < golden->width * golden->height * 4; i++) cleared = cleared && !renderer->pixels[i];
+    CHECK(cleared);
+    CHECK(pixel_rect_is_empty(&renderer->drawn));
+    CHECK(aabb_is_empty(&renderer->bounds));
+
+    // The same image in the byte order of a DIB section
+    std::vector<uint8_t> target((size_t) golden->width * golden->height * 4, 0);
+    software_renderer_set_target(renderer, target.data(), true);
+    software_renderer_draw_commands(renderer, render.data(), false);
+    checkImage(target.data(), golden, true);
+    software_renderer_set_target(renderer, nullptr, false);
+
+    software_renderer_dispose(renderer);
+    image_dispose(texture);
+    image_dispose(golden);
+}
+
+static void testMissingImage(const std::string& data) {
+    CHECK(image_load((data + "/missing.png").c_str()) == nullptr);
+}
+
+static bool sameImage(const image_t* a, const image_t* b) {
+    return a && b && a->width == b->width && a->height == b->height
+        && !memcmp(a->pixels, b->pixels, (size_t) a->width * a->height * 4);
+}
+
+/// Batches decode like image_load, and the pool stops and restarts as the last batch goes and the
+/// next one comes
+static void testImageBatch(const std::string& data) {
+    std::string texturePath = data + "/software_texture.png";
+    std::string goldenPath = data + "/software_golden.png";
+    image_t* texture = image_load(texturePath.c_str());
+    image_t* golden = image_load(goldenPath.c_str());
+
+    for (int threads : { 1, 3, 0 }) {
+        image_batch_threads(threads);
+        image_batch_t* first = image_batch_create();
+        image_batch_t* second = image_batch_create();
+        CHECK_EQ(image_batch_add(first, texturePath.c_str()), 0);
+        CHECK_EQ(image_batch_add(first, (data + "/missing.png").c_str()), 1);
+        CHECK_EQ(image_batch_add(first, goldenPath.c_str()), 2);
+        CHECK_EQ(image_batch_add(second, goldenPath.c_str()), 0);
+        image_batch_wait(first);
+
+        image_t* image = image_batch_take(first, 2);
+        CHECK(sameImage(image, golden));
+        image_dispose(image);
+        CHECK(image_batch_take(first, 2) == nullptr);
+        CHECK(image_batch_take(first, 1) == nullptr);
+        CHECK(image_batch_take(first, 3) == nullptr);
+        image = image_batch_take(first, 0);
+        CHECK(sameImage(image, texture));
+        image_dispose(image);
+        image_batch_dispose(first);
+
+        // Never taken, the batch frees it
+        image_batch_dispose(second);
+    }
+    image_batch_threads(0);
+
+    image_dispose(texture);
+    image_dispose(golden);
+}
+
+/// Texture of TestTextureLoader, the size of its page and the order it was created in
+struct TestTexture {
+    int width;
+    int height;
+    int order;
+};
+
+/// A DeferredTextureLoader recording the textures it creates and disposes
+class TestTextureLoader : public DeferredTextureLoader {
+public:
+    std::vector<TestTexture> created;
+    int disposed = 0;
+
+protected:
+    void* createTexture(const image_t* image) override {
+        created.push_back({ image->width, image->height, (int) created.size() });
+        return new TestTexture(created.back());
+    }
+
+    void disposeTexture(void* texture) override {
+        delete (TestTexture*) texture;
+        disposed++;
+    }
+};
+
+/// An atlas with a 16x16 region on each of the given pages
+static void writeAtlas(const fs::path& path, const std::vector<std::string>& pages) {
+    std::ofstream file(path, std::ios::binary);
+    for (size_t i = 0; i < pages.size(); i++) {
+        file << pages[i] << "\nsize: 32,32\nfilter: Linear,Linear\nregion" << i << "\nbounds: 0,0,16,16\n\n";
+    }
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/// The texture of the page and whether every region of the page points at it
+static TestTexture* pageTexture(Atlas& atlas, int page) {
+    AtlasPage* atlasPage = atlas.getPages()[page];
+    auto* texture = (TestTexture*) atlasPage->texture;
+    Vector<AtlasRegion*>& regions = atlas.getRegions();
+    for (size_t i = 0; i < regions.size(); i++)
+        if (regions[i]->page == atlasPage) CHECK(regions[i]->rendererObject == texture);
+    return texture;
+}
+
+/// Nothing is created before upload(), which then creates every page in page order
+static void testDeferredWaitThenUpload(const std::string& data, const fs::path& root) {
+    fs::copy_file(data + "/software_texture.png", root / "texture.png");
+    fs::copy_file(data + "/software_golden.png", root / "golden.png");
+    writeAtlas(root / "wait.atlas", { "golden.png", "texture.png", "missing.png" });
+
+    TestTextureLoader loader;
+    {
+        Atlas atlas((root / "wait.atlas").string().c_str(), &loader);
+        CHECK_EQ(atlas.getPages().size(), 3);
+        loader.wait();
+        CHECK(loader.created.empty());
+        CHECK(pageTexture(atlas, 0) == nullptr);
+
+        loader.upload(atlas);
+        CHECK_EQ(loader.created.size(), 2);
+        TestTexture* golden = pageTexture(atlas, 0);
+        TestTexture* texture = pageTexture(atlas, 1);
+        CHECK(golden && golden->width == 32 && golden->height == 24 && golden->order == 0);
+        CHECK(texture && texture->width == 4 && texture->height == 4 && texture->order == 1);
+        CHECK(pageTexture(atlas, 2) == nullptr);
+
+        // Every page was taken, a second upload creates nothing
+        loader.upload(atlas);
+        CHECK_EQ(loader.created.size(), 2);
+    }
+    CHECK_EQ(loader.disposed, 2);
+}
+
+/// An atlas disposed before upload() unloads pages without textures, and the loader frees the
+/// decoded images
+static void testDeferredUnloadBeforeUpload(const fs::path& root) {
+    writeAtlas(root / "unload.atlas", { "golden.png", "texture.png" });
+    TestTextureLoader loader;
+    {
+        Atlas atlas((root / "unload.atlas").string().c_str(), &loader);
+        CHECK_EQ(atlas.getPages().size(), 2);
+    }
+    CHECK(loader.created.empty());
+    CHECK_EQ(loader.disposed, 0);
+}
+
+#if !defined(_WIN32)
+/// Writes the content into a named pipe once a decoding thread opens it. Gives up after 10 s, the
+/// test cannot end while decoding threads wait for pipes.
+static void writeFifo(const fs::path& path, const std::string& content) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    int fd;
+    while ((fd = open(path.c_str(), O_WRONLY | O_NONBLOCK)) < 0) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::printf("%s: no decoding thread opened it\n", path.c_str());
+            std::exit(1);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    for (size_t written = 0; written < content.size();) {
+        ssize_t count = write(fd, content.data() + written, content.size() - written);
+        if (count <= 0) break;
+        written += (size_t) count;
+    }
+    close(fd);
+}
+
+/// Pages read from named pipes whose data arrives last page first still get their own textures,
+/// created in page order
+static void testDeferredOutOfOrderDecodes(const std::string& data, const fs::path& root) {
+    std::string golden = readFile(data + "/software_golden.png");
+    std::string texture = readFile(data + "/software_texture.png");
+    for (const char* name : { "page0.png", "page1.png", "page3.png" })
+        CHECK(mkfifo((root / name).c_str(), 0600) == 0);
+    writeAtlas(root / "fifo.atlas", { "page0.png", "page1.png", "missing.png", "page3.png" });
+
+    // One thread per page, so each can wait on its pipe
+    image_batch_threads(4);
+    {
+        TestTextureLoader loader;
+        Atlas atlas((root / "fifo.atlas").string().c_str(), &loader);
+        writeFifo(root / "page3.png", texture);
+        writeFifo(root / "page1.png", texture);
+        writeFifo(root / "page0.png", golden);
+        loader.upload(atlas);
+
+        CHECK_EQ(loader.created.size(), 3);
+        TestTexture* page0 = pageTexture(atlas, 0);
+        TestTexture* page1 = pageTexture(atlas, 1);
+        TestTexture* page3 = pageTexture(atlas, 3);
+        CHECK(page0 && page0->width == 32 && page0->order == 0);
+        CHECK(page1 && page1->width == 4 && page1->order == 1);
+        CHECK(pageTexture(atlas, 2) == nullptr);
+        CHECK(page3 && page3->width == 4 && page3->order == 2);
+    }
+    image_batch_threads(0);
+}
+#endif
+
+static void testDeferredTextureLoader(const std::string& data) {
+    fs::path root = fs::temp_directory_path() / ("wmaskex_test_deferred_" + std::to_string(std::random_device()()));
+    fs::remove_all(root);
+    fs::create_directories(root);
+    testDeferredWaitThenUpload(data, root);
+    testDeferredUnloadBeforeUpload(root);
+#if !defined(_WIN32)
+    testDeferredOutOfOrderDecodes(data, root);
+#endif
+    fs::remove_all(root);
+}
+
+int main(int argc, char** argv) {
+    std::string data = argc > 1 ? argv[1] : "tests/data";
+    testGoldenImage(data);
+    testMissingImage(data);
+    testImageBatch(data);
+    testDeferredTextureLoader(data);
+    return check_exit_code();
+}
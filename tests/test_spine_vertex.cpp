@@ -0,0 +1,339 @@
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "check.h"
+#include "spine-vertex.h"
+
+using namespace spine;
+
+static const vertex_pack_isa_t packIsas[] = { VERTEX_PACK_SCALAR, VERTEX_PACK_SSE2, VERTEX_PACK_AVX2, VERTEX_PACK_NEON };
+static const char* const packIsaNames[] = { "scalar", "SSE2", "AVX2", "NEON" };
+
+static void testVertexPackSwizzle() {
+    float positions[] = { 1.0f, 2.0f };
+    float uvs[] = { 0.25f, 0.75f };
+    uint32_t colors[] = { 0x11223344 };
+    uint32_t darkColors[] = { 0xAABBCCDD };
+    uint16_t indices[] = { 0 };
+    RenderCommand command = { positions, uvs, colors, darkColors, 1, indices, 1, BlendMode_Normal, nullptr, nullptr };
+    vertex_t vertex;
+    vertex_pack_scalar(&vertex, &command);
+    CHECK_EQ(vertex.x, 1.0f);
+    CHECK_EQ(vertex.y, 2.0f);
+    CHECK_EQ(vertex.u, 0.25f);
+    CHECK_EQ(vertex.v, 0.75f);
+    // ARGB to the RGBA bytes of the vertex attributes
+    const uint8_t* color = (const uint8_t*) &vertex.color;
+    CHECK(color[0] == 0x22 && color[1] == 0x33 && color[2] == 0x44 && color[3] == 0x11);
+    const uint8_t* darkColor = (const uint8_t*) &vertex.darkColor;
+    CHECK(darkColor[0] == 0xBB && darkColor[1] == 0xCC && darkColor[2] == 0xDD && darkColor[3] == 0xAA);
+}
+
+/// Every kernel the CPU supports writes the same bytes as the scalar loop, for every remainder
+/// of the 4 and 8 vertex groups and with inputs and output off the vector alignment
+static void testVertexPackKernels() {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> value(-1000.0f, 1000.0f);
+    const int maxVertices = 37;
+    const int misalignments = 4;
+    std::vector<float> positions(maxVertices * 2 + misalignments), uvs(maxVertices * 2 + misalignments);
+    std::vector<uint32_t> colors(maxVertices + misalignments), darkColors(maxVertices + misalignments);
+    for (float& position : positions) position = value(random);
+    for (float& uv : uvs) uv = value(random);
+    for (uint32_t& color : colors) color = random();
+    for (uint32_t& color : darkColors) color = random();
+    // One vertex more than packed, to catch writes past the end
+    std::vector<vertex_t> expected(maxVertices + 2), actual(maxVertices + 2);
+
+    int kernels = 0;
+    for (int k = 0; k < 4; k++) {
+        if (!vertex_pack_isa_supported(packIsas[k])) continue;
+        kernels++;
+        for (int numVertices = 0; numVertices <= maxVertices; numVertices++) {
+            for (int offset = 0; offset < misalignments; offset++) {
+                RenderCommand command = { positions.data() + offset, uvs.data() + offset + 1, colors.data() + offset,
+                    darkColors.data() + (offset + 2) % misalignments, numVertices, nullptr, 0, BlendMode_Normal, nullptr, nullptr };
+                std::memset(expected.data(), 0xCD, expected.size() * sizeof(vertex_t));
+                std::memset(actual.data(), 0xCD, actual.size() * sizeof(vertex_t));
+                // Output starting at vertex 1 is 8 but not 16 or 32-byte aligned
+                vertex_pack_scalar(expected.data() + offset % 2, &command);
+                vertex_pack_with(packIsas[k], actual.data() + offset % 2, &command);
+                if (std::memcmp(expected.data(), actual.data(), expected.size() * sizeof(vertex_t))) {
+                    std::printf("%s differs from scalar with %d vertices at offset %d\n", packIsaNames[k], numVertices, offset);
+                    CHECK(false);
+                }
+            }
+        }
+    }
+    CHECK(vertex_pack_isa_supported(vertex_pack_isa()));
+    CHECK(kernels >= 1);
+    std::printf("vertex_pack: compared %d kernels, dispatching to %s\n", kernels, packIsaNames[vertex_pack_isa()]);
+}
+
+static void testStreamRing() {
+    stream_ring_t ring = { 0, 0 };
+    bool orphan;
+    // The first reservation allocates, growing from 1024 in powers of two
+    CHECK_EQ(stream_ring_reserve(&ring, 1500, &orphan), 0);
+    CHECK(orphan);
+    CHECK_EQ(ring.capacity, 2048);
+    // Appended while there is room
+    CHECK_EQ(stream_ring_reserve(&ring, 500, &orphan), 1500);
+    CHECK(!orphan);
+    // A frame ending exactly at the capacity still fits
+    CHECK_EQ(stream_ring_reserve(&ring, 48, &orphan), 2000);
+    CHECK(!orphan);
+    CHECK_EQ(ring.offset, 2048);
+    // Even a single element more restarts at 0 with new storage
+    CHECK_EQ(stream_ring_reserve(&ring, 1, &orphan), 0);
+    CHECK(orphan);
+    CHECK_EQ(ring.capacity, 2048);
+    // A frame that would cross the end starts over instead of being split
+    CHECK_EQ(stream_ring_reserve(&ring, 1999, &orphan), 1);
+    CHECK(!orphan);
+    CHECK_EQ(stream_ring_reserve(&ring, 100, &orphan), 0);
+    CHECK(orphan);
+    // A frame bigger than the buffer grows it
+    CHECK_EQ(stream_ring_reserve(&ring, 5000, &orphan), 0);
+    CHECK(orphan);
+    CHECK_EQ(ring.capacity, 8192);
+    CHECK_EQ(ring.offset, 5000);
+}
+
+/// A render command together with the storage it points to
+struct TestCommand {
+    std::vector<float> positions;
+    std::vector<float> uvs;
+    std::vector<uint32_t> colors;
+    std::vector<uint32_t> darkColors;
+    std::vector<uint16_t> indices;
+};
+
+/// Random commands of up to maxVertices vertices each, some without indices
+static std::vector<TestCommand> makeCommands(std::mt19937& random, int count, int maxVertices) {
+    std::uniform_real_distribution<float> value(-100.0f, 100.0f);
+    std::vector<TestCommand> commands(count);
+    for (TestCommand& command : commands) {
+        int numVertices = 1 + (int) (random() % maxVertices);
+        int numIndices = random() % 5 == 0 ? 0 : 3 * (1 + (int) (random() % 20));
+        for (int i = 0; i < numVertices * 2; i++) command.positions.push_back(value(random));
+        for (int i = 0; i < numVertices * 2; i++) command.uvs.push_back(value(random));
+        for (int i = 0; i < numVertices; i++) command.colors.push_back(random());
+        for (int i = 0; i < numVertices; i++) command.darkColors.push_back(random());
+        for (int i = 0; i < numIndices; i++) command.indices.push_back((uint16_t) (random() % numVertices));
+    }
+    return commands;
+}
+
+/// Commands with indices holding exactly numVertices vertices together
+static std::vector<TestCommand> makeFillingCommands(std::mt19937& random, int numVertices) {
+    std::vector<TestCommand> commands;
+    while (numVertices > 0) {
+        commands.push_back(makeCommands(random, 1, 1)[0]);
+        TestCommand& command = commands.back();
+        int count = std::min(numVertices, 40);
+        command.positions.resize(count * 2, 1.0f);
+        command.uvs.resize(count * 2, 0.5f);
+        command.colors.resize(count, 0xFFFFFFFF);
+        command.darkColors.resize(count, 0);
+        command.indices = { 0, (uint16_t) (count - 1), (uint16_t) (count / 2) };
+        numVertices -= count;
+    }
+    return commands;
+}
+
+static std::vector<RenderCommand> linkCommands(std::vector<TestCommand>& commands) {
+    std::vector<RenderCommand> render(commands.size());
+    for (size_t i = 0; i < commands.size(); i++) {
+        TestCommand& command = commands[i];
+        render[i] = { command.positions.data(), command.uvs.data(), command.colors.data(), command.darkColors.data(),
+            (int) command.colors.size(), command.indices.data(), (int) command.indices.size(), (BlendMode) (i % 4),
+            (void*) (uintptr_t) (i + 1), i + 1 < commands.size() ? &render[i + 1] : nullptr };
+    }
+    return render;
+}
+
+/// Streams frames of different sizes through rings the way mesh_update does, into buffers
+/// standing in for the GPU's, and resolves every index of every draw the way
+/// glDrawElementsBaseVertex does. Each must reach the vertex of its own command.
+static void testFrameStreaming() {
+    std::mt19937 random(7);
+    stream_ring_t vertexRing = { 0, 0 }, indexRing = { 0, 0 };
+    std::vector<vertex_t> vertexBuffer;
+    std::vector<uint16_t> indexBuffer;
+    frame_t frame;
+    frame_init(&frame);
+    int wraps = 0, exactFits = 0;
+    for (int f = 0; f < 60; f++) {
+        // 20 commands exceed the 16 draws frame_plan starts with
+        std::vector<TestCommand> commands = f == 30 ? makeFillingCommands(random, vertexRing.capacity - vertexRing.offset)
+            : makeCommands(random, 1 + (int) (random() % 20), f % 10 == 9 ? 200 : 40);
+        std::vector<RenderCommand> render = linkCommands(commands);
+        frame_plan(&frame, render.data());
+
+        aabb_t bounds;
+        aabb_reset(&bounds);
+        int expectedDraws = 0, expectedVertices = 0, expectedIndices = 0;
+        for (RenderCommand& command : render) {
+            if (!command.numIndices) continue;
+            const frame_draw_t& draw = frame.draws[expectedDraws++];
+            CHECK_EQ(draw.base_vertex, expectedVertices);
+            CHECK_EQ(draw.first_index, expectedIndices);
+            CHECK_EQ(draw.num_indices, command.numIndices);
+            CHECK(draw.blend_mode == command.blendMode && draw.texture == command.texture);
+            aabb_add_positions(&bounds, command.positions, command.numVertices);
+            expectedVertices += command.numVertices;
+            expectedIndices += command.numIndices;
+        }
+        CHECK_EQ(frame.num_draws, expectedDraws);
+        CHECK_EQ(frame.num_vertices, expectedVertices);
+        CHECK_EQ(frame.num_indices, expectedIndices);
+        CHECK(std::memcmp(&frame.bounds, &bounds, sizeof(aabb_t)) == 0);
+
+        // Orphaned storage holds garbage, a frame may only rely on what it wrote itself
+        bool vertexOrphan, indexOrphan;
+        int vertexEnd = vertexRing.offset;
+        int baseVertex = stream_ring_reserve(&vertexRing, frame.num_vertices, &vertexOrphan);
+        int firstIndex = stream_ring_reserve(&indexRing, frame.num_indices, &indexOrphan);
+        if (vertexOrphan) {
+            vertexBuffer.assign(vertexRing.capacity, vertex_t { NAN, NAN, 0, NAN, NAN, 0 });
+            if (vertexEnd) wraps++;
+        }
+        if (indexOrphan) indexBuffer.assign(indexRing.capacity, 0xFFFF);
+        if (!vertexOrphan && vertexRing.offset == vertexRing.capacity) exactFits++;
+        frame_pack(&frame, render.data(), vertexBuffer.data() + baseVertex, indexBuffer.data() + firstIndex);
+
+        bool resolved = true;
+        for (int d = 0, c = 0; d < frame.num_draws; d++, c++) {
+            while (!render[c].numIndices) c++;
+            const frame_draw_t& draw = frame.draws[d];
+            for (int i = 0; i < draw.num_indices; i++) {
+                int index = indexBuffer[firstIndex + draw.first_index + i];
+                vertex_t expected;
+                RenderCommand single = render[c];
+                single.positions += index * 2;
+                single.uvs += index * 2;
+                single.colors += index;
+                single.darkColors += index;
+                single.numVertices = 1;
+                vertex_pack_scalar(&expected, &single);
+                const vertex_t& actual = vertexBuffer[baseVertex + draw.base_vertex + index];
+                resolved = resolved && std::memcmp(&expected, &actual, sizeof(vertex_t)) == 0;
+            }
+        }
+        CHECK(resolved);
+    }
+    frame_dispose(&frame);
+    CHECK(frame.draws == nullptr && frame.num_draws == 0);
+    // The sequence is fixed, make sure it still covers both edge cases
+    CHECK(wraps > 0);
+    CHECK(exactFits > 0);
+}
+
+static bool sameRect(const pixel_rect_t& rect, int x, int y, int width, int height) {
+    return rect.x == x && rect.y == y && rect.width == width && rect.height == height;
+}
+
+static aabb_t makeBox(float minX, float minY, float maxX, float maxY) {
+    return { minX, minY, maxX, maxY };
+}
+
+static void testAabb() {
+    aabb_t box;
+    aabb_reset(&box);
+    CHECK(aabb_is_empty(&box));
+    aabb_add_positions(&box, nullptr, 0);
+    CHECK(aabb_is_empty(&box));
+
+    const float point[] = { 3, -2 };
+    aabb_add_positions(&box, point, 1);
+    CHECK(!aabb_is_empty(&box));
+    CHECK(box.min_x == 3 && box.max_x == 3 && box.min_y == -2 && box.max_y == -2);
+
+    const float positions[] = { -1, 5, 4, 0, 2, -7 };
+    aabb_add_positions(&box, positions, 3);
+    CHECK(box.min_x == -1 && box.max_x == 4 && box.min_y == -7 && box.max_y == 5);
+
+    aabb_t flat = makeBox(0, 1, 10, 0);
+    CHECK(aabb_is_empty(&flat));
+}
+
+static void testPixelRectUnion() {
+    pixel_rect_t empty = { 5, 5, 0, 3 };
+    pixel_rect_t negative = { 1, 1, 4, -2 };
+    pixel_rect_t a = { 10, 20, 5, 5 };
+    pixel_rect_t b = { 12, 2, 30, 4 };
+    CHECK(pixel_rect_is_empty(&empty));
+    CHECK(pixel_rect_is_empty(&negative));
+    CHECK(!pixel_rect_is_empty(&a));
+
+    // Empty rectangles add nothing, not even their position
+    CHECK(sameRect(pixel_rect_union(&empty, &negative), 0, 0, 0, 0));
+    CHECK(sameRect(pixel_rect_union(&empty, &a), 10, 20, 5, 5));
+    CHECK(sameRect(pixel_rect_union(&a, &negative), 10, 20, 5, 5));
+    CHECK(sameRect(pixel_rect_union(&a, &b), 10, 2, 32, 23));
+    CHECK(sameRect(pixel_rect_union(&b, &a), 10, 2, 32, 23));
+    CHECK(sameRect(pixel_rect_union(&a, &a), 10, 20, 5, 5));
+}
+
+static void testDirtyTracker() {
+    dirty_tracker_t tracker;
+    dirty_tracker_reset(&tracker, 100, 80, 2.0f);
+
+    // Rows count from the bottom of the viewport, as skeleton y does
+    aabb_t first = makeBox(10, 5, 20, 15);
+    CHECK(sameRect(dirty_tracker_update(&tracker, &first), 20, 50, 20, 20));
+    CHECK_EQ(tracker.motion, 20.0f);
+
+    // A moved frame also clears the pixels of the previous one
+    aabb_t moved = makeBox(12, 5, 22, 15);
+    CHECK(sameRect(dirty_tracker_update(&tracker, &moved), 20, 50, 24, 20));
+    CHECK_EQ(tracker.motion, 4.0f);
+    CHECK(sameRect(dirty_tracker_update(&tracker, &moved), 24, 50, 20, 20));
+    CHECK_EQ(tracker.motion, 0.0f);
+
+    // An empty frame clears the previous one, the next empty frame changes nothing
+    aabb_t empty;
+    aabb_reset(&empty);
+    CHECK(sameRect(dirty_tracker_update(&tracker, &empty), 24, 50, 20, 20));
+    CHECK_EQ(tracker.motion, 20.0f);
+    pixel_rect_t none = dirty_tracker_update(&tracker, &empty);
+    CHECK(pixel_rect_is_empty(&none));
+    CHECK_EQ(tracker.motion, 0.0f);
+
+    // Rounded outwards to whole pixels
+    aabb_t fractional = makeBox(0.25f, 0.25f, 1.25f, 1.25f);
+    dirty_tracker_reset(&tracker, 100, 80, 8.0f);
+    CHECK(sameRect(dirty_tracker_update(&tracker, &fractional), 2, 70, 8, 8));
+
+    // Clamped to the viewport, and nothing for boxes outside of it
+    aabb_t covering = makeBox(-10, -10, 100, 100);
+    dirty_tracker_reset(&tracker, 100, 80, 1.0f);
+    CHECK(sameRect(dirty_tracker_update(&tracker, &covering), 0, 0, 100, 80));
+    aabb_t outside = makeBox(200, 20, 300, 30);
+    CHECK(sameRect(dirty_tracker_update(&tracker, &outside), 0, 0, 100, 80));
+    none = dirty_tracker_update(&tracker, &outside);
+    CHECK(pixel_rect_is_empty(&none));
+    aabb_t below = makeBox(10, -50, 20, -10);
+    none = dirty_tracker_update(&tracker, &below);
+    CHECK(pixel_rect_is_empty(&none));
+
+    // A reset forgets the previous frame
+    dirty_tracker_update(&tracker, &covering);
+    dirty_tracker_reset(&tracker, 50, 50, 1.0f);
+    none = dirty_tracker_update(&tracker, &empty);
+    CHECK(pixel_rect_is_empty(&none));
+    CHECK_EQ(tracker.motion, 0.0f);
+}
+
+int main() {
+    testVertexPackSwizzle();
+    testVertexPackKernels();
+    testStreamRing();
+    testFrameStreaming();
+    testAabb();
+    testPixelRectUnion();
+    testDirtyTracker();
+    return check_exit_code();
+}
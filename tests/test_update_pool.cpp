@@ -0,0 +1,131 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "WmaskEXUpdatePool.h"
+
+using namespace std::chrono_literals;
+
+/// Spins until flag is set or a second passed, returns whether it was set
+static bool waitFor(const std::atomic<bool>& flag) {
+    auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (!flag && std::chrono::steady_clock::now() < deadline) std::this_thread::sleep_for(1ms);
+    return flag;
+}
+
+/// Jobs of one strand run one at a time in submission order, whichever worker takes them
+static void testStrandOrder() {
+    WmaskEXUpdatePool pool(4);
+    const int count = 2000;
+    std::vector<int> ran;
+    std::mutex ranMutex;
+    std::atomic<int> running = 0;
+    std::atomic<bool> overlapped = false;
+    WmaskEXUpdatePool::Ticket last;
+    for (int i = 0; i < count; i++) {
+        last = pool.submit(L"asset", [&, i] {
+            if (running++ > 0) overlapped = true;
+            {
+                std::lock_guard<std::mutex> lock(ranMutex);
+                ran.push_back(i);
+            }
+            running--;
+        });
+    }
+    pool.wait(last);
+    CHECK(!overlapped);
+    CHECK_EQ(ran.size(), count);
+    bool ordered = true;
+    for (int i = 0; i < (int) ran.size(); i++) ordered &= ran[i] == i;
+    CHECK(ordered);
+}
+
+/// Jobs of different strands run at the same time
+static void testStrandsInParallel() {
+    WmaskEXUpdatePool pool(2);
+    std::atomic<bool> firstStarted = false, secondStarted = false;
+    std::atomic<bool> firstSawSecond = false, secondSawFirst = false;
+    WmaskEXUpdatePool::Ticket first = pool.submit(L"a", [&] {
+        firstStarted = true;
+        firstSawSecond = waitFor(secondStarted);
+    });
+    WmaskEXUpdatePool::Ticket second = pool.submit(L"b", [&] {
+        secondStarted = true;
+        secondSawFirst = waitFor(firstStarted);
+    });
+    pool.wait(first);
+    pool.wait(second);
+    CHECK(firstSawSecond);
+    CHECK(secondSawFirst);
+}
+
+/// Waiting for a job no worker started runs it on the waiting thread, unless its strand is busy
+static void testWaitRunsInline() {
+    WmaskEXUpdatePool pool(1);
+    std::atomic<bool> blocking = false, release = false, blockerDone = false;
+    WmaskEXUpdatePool::Ticket blocker = pool.submit(L"busy", [&] {
+        blocking = true;
+        waitFor(release);
+        blockerDone = true;
+    });
+    CHECK(waitFor(blocking));
+
+    // The only worker is blocked, the job of a free strand runs here
+    std::thread::id ranOn;
+    pool.wait(pool.submit(L"free", [&] { ranOn = std::this_thread::get_id(); }));
+    CHECK(ranOn == std::this_thread::get_id());
+    ranOn = {};
+    pool.wait(pool.submit(L"", [&] { ranOn = std::this_thread::get_id(); }));
+    CHECK(ranOn == std::this_thread::get_id());
+
+    // A job behind the busy strand waits for it and then runs on the worker
+    std::atomic<bool> ranAfterBlocker = false;
+    WmaskEXUpdatePool::Ticket behind = pool.submit(L"busy", [&] {
+        ranAfterBlocker = blockerDone.load();
+        ranOn = std::this_thread::get_id();
+    });
+    std::thread releaser([&] {
+        std::this_thread::sleep_for(20ms);
+        release = true;
+    });
+    pool.wait(behind);
+    releaser.join();
+    CHECK(ranAfterBlocker);
+    CHECK(ranOn != std::this_thread::get_id());
+    pool.wait(blocker);
+
+    // Jobs queued earlier on the strand run first, so a later one is not taken out of order
+    std::atomic<bool> blockingAgain = false;
+    release = false;
+    std::vector<int> ran;
+    pool.submit(L"busy", [&] {
+        blockingAgain = true;
+        waitFor(release);
+    });
+    CHECK(waitFor(blockingAgain));
+    pool.submit(L"ordered", [&] { ran.push_back(1); });
+    WmaskEXUpdatePool::Ticket second = pool.submit(L"ordered", [&] { ran.push_back(2); });
+    release = true;
+    pool.wait(second);
+    CHECK(ran == std::vector<int>({ 1, 2 }));
+}
+
+/// Jobs still queued run before the pool is destroyed
+static void testDestructorRunsQueued() {
+    std::atomic<int> ran = 0;
+    {
+        WmaskEXUpdatePool pool(1);
+        for (int i = 0; i < 100; i++) pool.submit(i % 2 ? L"a" : L"", [&] { ran++; });
+    }
+    CHECK_EQ(ran.load(), 100);
+}
+
+int main() {
+    testStrandOrder();
+    testStrandsInParallel();
+    testWaitRunsInline();
+    testDestructorRunsQueued();
+    return check_exit_code();
+}
@@ -0,0 +1,112 @@
+#include <cstring>
+#include <filesystem>
+#include <vector>
+#include "check.h"
+#include "spine-bounds.h"
+
+namespace fs = std::filesystem;
+using namespace spine;
+
+/// The kernels this CPU runs besides the scalar loop, the same ones spine_bench --skinning compares
+static std::vector<SkinningKernel> getSupportedKernels() {
+    SkinningKernel best = VertexSkinning::getKernel();
+    std::vector<SkinningKernel> kernels;
+    if (best == SkinningKernel_AVX2) kernels.push_back(SkinningKernel_SSE2);
+    if (best != SkinningKernel_None) kernels.push_back(best);
+    return kernels;
+}
+
+/// Poses the bones of skinning.json and applies its deform, a negative time keeps the setup pose
+/// where the slot has no deform
+static void pose(Skeleton& skeleton, SkeletonData* data, float time) {
+    skeleton.setToSetupPose();
+    if (time >= 0) data->findAnimation("bend")->apply(skeleton, 0, time, false, nullptr, 1, MixBlend_Setup, MixDirection_In);
+    skeleton.updateWorldTransform(Physics_Update);
+}
+
+/// World vertices of the slot's mesh with the scalar loop of VertexAttachment::computeWorldVertices
+static std::vector<float> computeScalar(Slot& slot, VertexAttachment* mesh) {
+    std::vector<float> worldVertices(mesh->getWorldVerticesLength());
+    VertexSkinning::setKernel(SkinningKernel_None);
+    mesh->computeWorldVertices(slot, 0, mesh->getWorldVerticesLength(), worldVertices.data(), 0, 2);
+    return worldVertices;
+}
+
+/// The transforms VertexSkinning::compute takes for the bones of skinning
+static std::vector<float> getTransforms(Skeleton& skeleton, VertexSkinning& skinning) {
+    std::vector<float> transforms;
+    Vector<int>& bones = skinning.getBones();
+    for (size_t i = 0; i < bones.size(); i++) {
+        Bone* bone = skeleton.getBones()[bones[i]];
+        float fields[VertexSkinning::TransformStride] = { bone->getA(), bone->getB(), bone->getC(), bone->getD(),
+            bone->getWorldX(), bone->getWorldY(), 0, 0 };
+        transforms.insert(transforms.end(), fields, fields + VertexSkinning::TransformStride);
+    }
+    return transforms;
+}
+
+static bool identical(const std::vector<float>& expected, const std::vector<float>& actual) {
+    return expected.size() == actual.size() && !std::memcmp(expected.data(), actual.data(), expected.size() * sizeof(float));
+}
+
+/// Every kernel computes the same bits as the scalar loop, from copied transforms and from the
+/// skeleton's transform block, with and without deform, at an offset and stride of a vertex buffer
+static void testKernelsMatchScalar(SkeletonData* data) {
+    std::vector<SkinningKernel> kernels = getSupportedKernels();
+    SkinningKernel best = VertexSkinning::getKernel();
+    for (bool boneTransformBlock : { false, true }) {
+        Skeleton skeleton(data, boneTransformBlock);
+        Slot* slot = skeleton.findSlot("s");
+        VertexAttachment* mesh = (VertexAttachment*) slot->getAttachment();
+        CHECK(mesh && mesh->getBones().size() > 0);
+        if (!mesh) continue;
+        size_t length = mesh->getWorldVerticesLength();
+        // The same layout VertexAttachment builds for itself
+        VertexSkinning skinning(mesh->getBones(), mesh->getVertices());
+        for (float time : { -1.0f, 0.0f, 0.4f, 1.0f }) {
+            pose(skeleton, data, time);
+            CHECK_EQ(slot->getDeform().size() > 0, time >= 0);
+            const float* deform = slot->getDeform().size() > 0 ? slot->getDeform().buffer() : nullptr;
+            std::vector<float> expected = computeScalar(*slot, mesh);
+            for (SkinningKernel kernel : kernels) {
+                VertexSkinning::setKernel(kernel);
+
+                // Through VertexAttachment, which picks computeFromSkeleton when there is a block
+                std::vector<float> actual(length);
+                mesh->computeWorldVertices(*slot, 0, length, actual.data(), 0, 2);
+                CHECK(identical(expected, actual));
+
+                // Interleaved with two more floats per vertex, after 3 vertices of another attachment
+                const size_t offset = 6, stride = 4;
+                std::vector<float> buffer(offset + length / 2 * stride, -1.0f);
+                if (boneTransformBlock) {
+                    skinning.computeFromSkeleton(skeleton.getBoneTransforms(), deform, buffer.data(), offset, stride);
+                } else {
+                    std::vector<float> transforms = getTransforms(skeleton, skinning);
+                    skinning.compute(transforms.data(), deform, buffer.data(), offset, stride);
+                }
+                std::vector<float> strided;
+                for (size_t i = offset; i < buffer.size(); i += stride) strided.insert(strided.end(), { buffer[i], buffer[i + 1] });
+                CHECK(identical(expected, strided));
+                bool untouched = true;
+                for (size_t i = 0; i < offset; i++) untouched &= buffer[i] == -1.0f;
+                for (size_t i = offset + 2; i < buffer.size(); i += stride) untouched &= buffer[i] == -1.0f && buffer[i + 1] == -1.0f;
+                CHECK(untouched);
+            }
+        }
+    }
+    VertexSkinning::setKernel(best);
+}
+
+int main(int argc, char** argv) {
+    fs::path data = argc > 1 ? argv[1] : "tests/data";
+    Atlas* unpaged = nullptr;
+    SkeletonData* skeletonData = skeleton_data_load_unpaged((data / "skinning.atlas").string().c_str(),
+        (data / "skinning.json").string().c_str(), &unpaged);
+    CHECK(skeletonData != nullptr);
+    if (skeletonData) {
+        testKernelsMatchScalar(skeletonData);
+        skeleton_data_dispose_unpaged(skeletonData, unpaged);
+    }
+    return check_exit_code();
+}